@@ -0,0 +1,256 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __BENCH_AFFINITY_HPP__
+#define __BENCH_AFFINITY_HPP__
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//
+// Placement of the benchmark threads on the CPUs the process may run on,
+// after the topology that Linux exposes in sysfs:
+//
+//  - none: the threads are not pinned
+//  - compact: thread i runs on the i-th CPU, filling up the SMT siblings of
+//    a core, then the cores of a NUMA node, then the next node
+//  - scatter: consecutive threads run on different NUMA nodes, then on
+//    different cores, and only then on the SMT siblings
+//  - numa: the threads fill up the nodes as for compact, but each thread may
+//    run on any CPU of its node
+//
+// On other systems, no CPU is known, so the threads are never pinned.
+//
+namespace affinity {
+
+    struct cpu_info {
+        int cpu;
+        int node;
+        int package;
+        int core;
+        int smt;        // index among the SMT siblings of the core
+    };
+
+
+    inline int read_int(const std::string& path, int fallback) {
+        std::ifstream in(path);
+        int value;
+        return (in >> value) ? value : fallback;
+    }
+
+
+    // parse a CPU list, e.g., "0-3,8,10-11"
+    inline std::vector<int> parse_cpulist(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            int first, last;
+            char dash;
+            std::stringstream is(item);
+            if (!(is >> first)) {
+                continue;
+            }
+            last = (is >> dash >> last) ? last : first;
+            for (int c = first; c <= last; ++c) {
+                cpus.push_back(c);
+            }
+        }
+        return cpus;
+    }
+
+
+    // NUMA node of each CPU; CPUs of unknown nodes are on node 0
+    inline std::map<int, int> cpu_nodes() {
+        std::map<int, int> nodes;
+        DIR* dir = opendir("/sys/devices/system/node");
+        if (!dir) {
+            return nodes;
+        }
+        while (struct dirent* e = readdir(dir)) {
+            int node;
+            if (std::sscanf(e->d_name, "node%d", &node) != 1) {
+                continue;
+            }
+            std::ifstream in(std::string("/sys/devices/system/node/")
+                             + e->d_name + "/cpulist");
+            std::string list;
+            std::getline(in, list);
+            for (int c: parse_cpulist(list)) {
+                nodes[c] = node;
+            }
+        }
+        closedir(dir);
+        return nodes;
+    }
+
+
+    // the CPUs of the process affinity mask, in compact order
+    inline std::vector<cpu_info> online_cpus() {
+        std::vector<cpu_info> cpus;
+#ifdef __linux__
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask)) {
+            return cpus;
+        }
+        std::map<int, int> nodes = cpu_nodes();
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (!CPU_ISSET(c, &mask)) {
+                continue;
+            }
+            std::string topo = "/sys/devices/system/cpu/cpu"
+                + std::to_string(c) + "/topology/";
+            cpu_info info;
+            info.cpu = c;
+            info.node = nodes.count(c) ? nodes[c] : 0;
+            info.package = read_int(topo + "physical_package_id", 0);
+            info.core = read_int(topo + "core_id", c);
+            info.smt = 0;
+            cpus.push_back(info);
+        }
+        std::sort(cpus.begin(), cpus.end(),
+                  [](const cpu_info& a, const cpu_info& b) {
+            if (a.node != b.node) return a.node < b.node;
+            if (a.package != b.package) return a.package < b.package;
+            if (a.core != b.core) return a.core < b.core;
+            return a.cpu < b.cpu;
+        });
+        for (size_t i = 1; i < cpus.size(); ++i) {
+            const cpu_info& p = cpus[i - 1];
+            if (p.node == cpus[i].node && p.package == cpus[i].package &&
+                p.core == cpus[i].core) {
+                cpus[i].smt = p.smt + 1;
+            }
+        }
+#endif
+        return cpus;
+    }
+
+
+    //
+    // CPU sets of the threads for a policy; thread i gets set i modulo the
+    // number of sets, or an empty set if it is not pinned.
+    //
+    class placement {
+    public:
+        static bool valid(const std::string& policy) {
+            return policy == "none" || policy == "compact" ||
+                policy == "scatter" || policy == "numa";
+        }
+
+        explicit placement(const std::string& policy)
+        : _M_sets()
+        {
+            std::vector<cpu_info> cpus = online_cpus();
+            if (policy == "none" || cpus.empty()) {
+                return;
+            }
+            if (policy == "scatter") {
+                // rank of each core within its node
+                std::map<int, int> next_rank;
+                std::map<std::pair<int, int>, int> core_rank;
+                std::vector<int> rank(cpus.size());
+                for (size_t i = 0; i < cpus.size(); ++i) {
+                    auto key = std::make_pair(cpus[i].node,
+                        cpus[i].package * 65536 + cpus[i].core);
+                    if (!core_rank.count(key)) {
+                        core_rank[key] = next_rank[cpus[i].node]++;
+                    }
+                    rank[i] = core_rank[key];
+                }
+                std::vector<size_t> order(cpus.size());
+                for (size_t i = 0; i < order.size(); ++i) {
+                    order[i] = i;
+                }
+                std::stable_sort(order.begin(), order.end(),
+                                 [&](size_t a, size_t b) {
+                    if (cpus[a].smt != cpus[b].smt) return cpus[a].smt < cpus[b].smt;
+                    if (rank[a] != rank[b]) return rank[a] < rank[b];
+                    return cpus[a].node < cpus[b].node;
+                });
+                for (size_t i: order) {
+                    _M_sets.push_back(std::vector<int>(1, cpus[i].cpu));
+                }
+            } else if (policy == "numa") {
+                std::map<int, std::vector<int>> node_cpus;
+                for (const cpu_info& c: cpus) {
+                    node_cpus[c.node].push_back(c.cpu);
+                }
+                for (const cpu_info& c: cpus) {
+                    _M_sets.push_back(node_cpus[c.node]);
+                }
+            } else {
+                for (const cpu_info& c: cpus) {
+                    _M_sets.push_back(std::vector<int>(1, c.cpu));
+                }
+            }
+        }
+
+        // pin the calling thread as the id-th thread; false on failure
+        bool pin(size_t id) const {
+            if (_M_sets.empty()) {
+                return true;
+            }
+#ifdef __linux__
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            for (int c: _M_sets[id % _M_sets.size()]) {
+                CPU_SET(c, &mask);
+            }
+            return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+            return false;
+#endif
+        }
+
+        // number of distinct sets (0 when the threads are not pinned)
+        size_t size() const {
+            return _M_sets.size();
+        }
+
+    private:
+        std::vector<std::vector<int>> _M_sets;
+    };
+
+
+    //
+    // Restores the affinity mask of the calling thread on destruction
+    //
+    class saved_mask {
+#ifdef __linux__
+    public:
+        saved_mask() : _M_valid(false) {
+            CPU_ZERO(&_M_mask);
+            _M_valid = pthread_getaffinity_np(pthread_self(), sizeof(_M_mask),
+                                              &_M_mask) == 0;
+        }
+
+        ~saved_mask() {
+            if (_M_valid) {
+                (void) pthread_setaffinity_np(pthread_self(), sizeof(_M_mask),
+                                              &_M_mask);
+            }
+        }
+
+    private:
+        cpu_set_t   _M_mask;
+        bool        _M_valid;
+#endif
+    };
+
+} // namespace affinity
+
+#endif // __BENCH_AFFINITY_HPP__
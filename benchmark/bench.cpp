@@ -3,8 +3,10 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
@@ -15,34 +17,108 @@
 #include <set>
 #include <vector>
 #include <tle/mutex.hpp>
-#include <tle/real_clock.hpp>
+#include <tle/cycle_clock.hpp>
+
+#include "affinity.hpp"
+#include "workload.hpp"
 
 using jiffies = std::chrono::duration<double, std::ratio<1, 1000000>>;
 
 //
 // command line parameters
 //
-size_t num_threads = 4;
-std::string mutex_type("");
+std::vector<size_t> thread_counts = { 4 };
+std::vector<std::string> mutex_list;
 jiffies lock_interval(10);
 jiffies lock_duration(5);
+jiffies shared_lock_duration(-1);   // same as lock_duration by default
+double read_ratio = 0.0;
+std::string workload_type("busy");
+uint64_t key_space = 1024;
+double array_size = 1.0;            // in MB
+size_t keys_per_lock = 1;
+std::chrono::duration<double> time_limit(2.0);
+std::chrono::duration<double> warm_up(0.0);
+size_t repeats = 1;
+std::string pinning("none");
+std::string output_format("text");
+uint32_t latency_interval = 1;      // record the wait time of 1 in N locks
 
 std::set<std::string> mutex_types = {
     "null_mutex",
     "spin_mutex",
     "htm_spin_mutex",
+    "htm_adaptive_spin_mutex",
+    "mcs_mutex",
+    "htm_mcs_mutex",
+    "htm_cohort_mutex",
+#ifdef __linux__
+    "htm_futex_mutex",
+#endif
+    "null_shared_mutex",
+    "spin_shared_mutex",
+    "htm_spin_shared_mutex",
+    "rp_spin_shared_mutex",
+    "htm_rp_spin_shared_mutex",
+    "pf_spin_shared_mutex",
+    "htm_pf_spin_shared_mutex",
+    "htm_adaptive_spin_shared_mutex",
+    "dist_shared_mutex",
+    "htm_dist_shared_mutex",
+    "htm_cohort_shared_mutex",
+#ifdef __linux__
+    "htm_futex_shared_mutex"
+#endif
+};
+
+std::set<std::string> workload_types = {
+    "busy",
+    "hashmap",
+    "skiplist",
+    "queue",
+    "array"
+};
+
+std::set<std::string> shared_mutex_types = {
     "null_shared_mutex",
     "spin_shared_mutex",
-    "htm_spin_shared_mutex"
+    "htm_spin_shared_mutex",
+    "rp_spin_shared_mutex",
+    "htm_rp_spin_shared_mutex",
+    "pf_spin_shared_mutex",
+    "htm_pf_spin_shared_mutex",
+    "htm_adaptive_spin_shared_mutex",
+    "dist_shared_mutex",
+    "htm_dist_shared_mutex",
+    "htm_cohort_shared_mutex",
+#ifdef __linux__
+    "htm_futex_shared_mutex"
+#endif
+};
+
+std::set<std::string> pinning_types = {
+    "none",
+    "compact",
+    "scatter",
+    "numa"
+};
+
+std::set<std::string> output_formats = {
+    "text",
+    "csv",
+    "json"
 };
 
 
 //
 // global state
 //
-auto time_limit = std::chrono::seconds(2);
+size_t num_threads;
 uint64_t average_unlocked_work;
 uint64_t average_locked_work;
+uint64_t average_shared_locked_work;
+std::unique_ptr<workload::base> shared_data;     // nullptr for busy work
+std::unique_ptr<affinity::placement> placement;
 
 //
 // thread synchronization
@@ -52,11 +128,8 @@ std::atomic_int start_work;
 //
 // statistics
 //
-struct thread_stats {
-    uint64_t work_done;
+struct lock_stats {
     uint64_t iterations;
-    uint64_t result;
-    jiffies  overshoot;
 
     uint64_t locks_acquired;
     uint64_t locks_elided;
@@ -66,12 +139,41 @@ struct thread_stats {
     uint64_t nested_aborts;
     uint64_t other_aborts;
 
-    thread_stats(): work_done(0), iterations(0), result(0), overshoot(0),
+    lock_stats(): iterations(0),
         locks_acquired(0), locks_elided(0), explicit_aborts(0),
         conflict_aborts(0), capacity_aborts(0), nested_aborts(0),
         other_aborts(0)
     { }
 
+    lock_stats& operator+=(const lock_stats& other) {
+        iterations += other.iterations;
+        locks_acquired += other.locks_acquired;
+        locks_elided += other.locks_elided;
+        explicit_aborts += other.explicit_aborts;
+        conflict_aborts += other.conflict_aborts;
+        capacity_aborts += other.capacity_aborts;
+        nested_aborts += other.nested_aborts;
+        other_aborts += other.other_aborts;
+        return *this;
+    }
+
+    lock_stats& operator-=(const lock_stats& other) {
+        iterations -= other.iterations;
+        locks_acquired -= other.locks_acquired;
+        locks_elided -= other.locks_elided;
+        explicit_aborts -= other.explicit_aborts;
+        conflict_aborts -= other.conflict_aborts;
+        capacity_aborts -= other.capacity_aborts;
+        nested_aborts -= other.nested_aborts;
+        other_aborts -= other.other_aborts;
+        return *this;
+    }
+
+    uint64_t aborts() const {
+        return explicit_aborts + conflict_aborts + capacity_aborts +
+            nested_aborts + other_aborts;
+    }
+
     void assign_from(tle::null_mutex_profile& stats) {
     }
 
@@ -90,6 +192,24 @@ struct thread_stats {
     }
 };
 
+struct thread_stats {
+    uint64_t work_done;
+    uint64_t ops_done;      // workload operations
+    uint64_t result;
+    jiffies  overshoot;
+
+    lock_stats writes;      // lock()/unlock()
+    lock_stats reads;       // lock_shared()/unlock_shared()
+
+    // wait times (in cycles) of the elided and of the fallback acquisitions
+    tle::latency_histogram wait_elided;
+    tle::latency_histogram wait_locked;
+
+    thread_stats(): work_done(0), ops_done(0), result(0), overshoot(0),
+        wait_elided(), wait_locked()
+    { }
+};
+
 std::vector<thread_stats> stats;
 
 
@@ -113,73 +233,158 @@ dummy_work(uint64_t amount, std::mt19937_64& busy)
 // Thread execution
 //
 
-template<typename Mutex>
+// shared acquisitions, or exclusive ones for the exclusive mutex types
+template<bool Shared> struct reader {
+    template<typename Handle> static void lock(Handle& h) { h.lock_shared(); }
+    template<typename Handle> static void unlock(Handle& h) { h.unlock_shared(); }
+};
+
+template<> struct reader<false> {
+    template<typename Handle> static void lock(Handle& h) { h.lock(); }
+    template<typename Handle> static void unlock(Handle& h) { h.unlock(); }
+};
+
+template<typename Mutex, bool Shared>
 void thread_actions(size_t id, Mutex* mtx)
 {
     typedef typename Mutex::profile_type profile_type;
-    typedef typename Mutex::handle_type  handle_type;
+    typedef tle::latency_handle<typename Mutex::handle_type> handle_type;
 
-    profile_type mtx_stats;
-    handle_type work_locker(*mtx, &mtx_stats);
+    // one handle per kind of acquisition, to profile them separately; both
+    // record their wait times in the same histograms
+    profile_type write_stats;
+    profile_type read_stats;
+    tle::latency_profile latency(latency_interval);
+    handle_type work_locker(*mtx, &latency, &write_stats);
+    handle_type read_locker(*mtx, &latency, &read_stats);
 
     unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
     std::mt19937_64 busy(seed);
     std::mt19937_64 generator(seed);
     std::poisson_distribution<uint64_t> unlocked_distribution(average_unlocked_work);
     std::poisson_distribution<uint64_t> locked_distribution(average_locked_work);
+    std::poisson_distribution<uint64_t> shared_locked_distribution(average_shared_locked_work);
+    std::bernoulli_distribution read_distribution(read_ratio);
+    std::uniform_int_distribution<uint64_t> key_distribution(
+        0, shared_data ? shared_data->key_space() - 1 : 0);
+    std::vector<uint64_t> keys(keys_per_lock);
+
+    // the main thread checked that pinning works
+    (void) placement->pin(id);
 
     start_work.fetch_sub(1);
     while (start_work.load(std::memory_order_acquire) > 0)
         /*wait*/;
 
+    // run for the warm-up time first, if any, then for the time limit
+    bool warming_up = warm_up.count() > 0;
+    jiffies limit = warming_up ? jiffies(warm_up) : jiffies(time_limit);
     jiffies elapsed_time;
-    auto start_tick = tle::real_clock::now();
+    lock_stats write_baseline;
+    lock_stats read_baseline;
+    auto start_tick = tle::cycle_clock::now();
+
+    // true when the time limit is over; at the end of the warm-up, drop the
+    // statistics so far and restart the clock instead
+    auto expired = [&](decltype(start_tick) stop_tick) {
+        elapsed_time = std::chrono::duration_cast<jiffies>(stop_tick - start_tick);
+        if (elapsed_time < limit) {
+            return false;
+        }
+        if (!warming_up) {
+            return true;
+        }
+        warming_up = false;
+        limit = jiffies(time_limit);
+        write_baseline.assign_from(write_stats);
+        read_baseline.assign_from(read_stats);
+        latency = tle::latency_profile(latency_interval);
+        stats[id] = thread_stats();
+        start_tick = stop_tick;
+        return false;
+    };
+
     while (true) {
 
         // do some work without holding the lock
         uint64_t work_items = unlocked_distribution(generator);
         uint64_t dummy = dummy_work(work_items, busy);
-        auto stop_tick = tle::real_clock::now();
+        auto stop_tick = tle::cycle_clock::now();
         stats[id].result += dummy;
         stats[id].work_done += work_items;
-        elapsed_time = std::chrono::duration_cast<jiffies>(stop_tick - start_tick);
-        if (elapsed_time >= time_limit)
+        if (expired(stop_tick))
             break;
 
-        // do some work holding the lock
-        work_items = locked_distribution(generator);
-        work_locker.lock();
-        dummy = dummy_work(work_items, busy);
-        work_locker.unlock();
-        stop_tick = tle::real_clock::now();
+        // do some work holding the lock, for reading or for writing
+        if (shared_data) {
+            work_items = 0;
+            for (auto& k: keys) {
+                k = key_distribution(generator);
+            }
+            if (read_distribution(generator)) {
+                reader<Shared>::lock(read_locker);
+                dummy = shared_data->read(keys.data(), keys.size());
+                reader<Shared>::unlock(read_locker);
+                ++stats[id].reads.iterations;
+            } else {
+                work_locker.lock();
+                dummy = shared_data->write(keys.data(), keys.size());
+                work_locker.unlock();
+                ++stats[id].writes.iterations;
+            }
+            stats[id].ops_done += keys.size();
+        } else if (read_distribution(generator)) {
+            work_items = shared_locked_distribution(generator);
+            reader<Shared>::lock(read_locker);
+            dummy = dummy_work(work_items, busy);
+            reader<Shared>::unlock(read_locker);
+            ++stats[id].reads.iterations;
+        } else {
+            work_items = locked_distribution(generator);
+            work_locker.lock();
+            dummy = dummy_work(work_items, busy);
+            work_locker.unlock();
+            ++stats[id].writes.iterations;
+        }
+        stop_tick = tle::cycle_clock::now();
         stats[id].result += dummy;
         stats[id].work_done += work_items;
 
-        ++stats[id].iterations;
-
-        elapsed_time = std::chrono::duration_cast<jiffies>(stop_tick - start_tick);
-        if (elapsed_time >= time_limit)
+        if (expired(stop_tick))
             break;
     }
 
-    stats[id].overshoot = elapsed_time - time_limit;
-    stats[id].assign_from(mtx_stats);
+    stats[id].overshoot = elapsed_time - limit;
+    stats[id].writes.assign_from(write_stats);
+    stats[id].writes -= write_baseline;
+    stats[id].reads.assign_from(read_stats);
+    stats[id].reads -= read_baseline;
+    stats[id].wait_elided = latency.wait_elided;
+    stats[id].wait_locked = latency.wait_locked;
 }
 
 
-template<typename Mutex>
+template<typename Mutex, bool Shared = false>
 void run_threads()
 {
+    // allocate the workload where thread 0 runs, so that it is on its NUMA
+    // node (first touch); restore the affinity afterwards. The mutex is on
+    // the stack of this thread, so it stays wherever the stack already is.
+    affinity::saved_mask mask;
+    (void) placement->pin(0);
     Mutex mtx;
+    if (workload_type != "busy") {
+        shared_data = workload::make(workload_type, key_space, array_size);
+    }
 
     // create N-1 threads
     std::vector<std::thread> threads;
-    for (size_t id = 0; id < num_threads-1; ++id) {
-        threads.push_back(std::thread(thread_actions<Mutex>, id, &mtx));
+    for (size_t id = 1; id < num_threads; ++id) {
+        threads.push_back(std::thread(thread_actions<Mutex,Shared>, id, &mtx));
     }
 
     // run N threads
-    thread_actions(num_threads-1, &mtx);
+    thread_actions<Mutex,Shared>(0, &mtx);
 
     // wait for the threads to finish
     for (auto& thr: threads) {
@@ -197,9 +402,11 @@ jiffies jiffies_per_work_item()
     unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
     std::mt19937_64 busy(seed);
     uint64_t amount = 100000000;
-    auto start_tick = tle::real_clock::now();
-    std::ignore = dummy_work(amount, busy);
-    auto stop_tick = tle::real_clock::now();
+    auto start_tick = tle::serializing_cycle_clock::now();
+    // keep the result, or the whole call may be optimized away
+    volatile uint64_t dummy = dummy_work(amount, busy);
+    auto stop_tick = tle::serializing_cycle_clock::now();
+    (void) dummy;
     double elapsed_time = std::chrono::duration_cast<jiffies>(stop_tick - start_tick).count();
     return jiffies(elapsed_time / static_cast<double>(amount));
 }
@@ -231,6 +438,432 @@ std::string to_time_string(jiffies ticks)
 }
 
 
+// -----------------------------------------------------------------------------
+// Report the statistics of one kind of acquisition
+//
+
+void report(const char* name, const lock_stats& st)
+{
+    uint64_t locks = st.locks_acquired + st.locks_elided;
+    uint64_t aborts = st.explicit_aborts + st.conflict_aborts +
+        st.capacity_aborts + st.nested_aborts + st.other_aborts;
+    std::cout
+        << name << ":" << std::endl
+        << "  iterations:      " << st.iterations << std::endl
+        << "  throughput (Mops/sec): "
+        << 1e-6 * (st.iterations / static_cast<double>(time_limit.count()))
+        << std::endl
+        << "  locks_acquired:  " << st.locks_acquired << std::endl
+        << "  locks_elided:    " << st.locks_elided;
+    if (locks) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2)
+            << (100.0 * st.locks_elided / locks);
+        std::cout << " (" << ss.str() << "%)";
+    }
+    std::cout << std::endl;
+    if (aborts) {
+        std::cout
+            << "  conflict_aborts: " << st.conflict_aborts << std::endl
+            << "  capacity_aborts: " << st.capacity_aborts << std::endl
+            << "  explicit_aborts: " << st.explicit_aborts << std::endl
+            << "  nested_aborts:   " << st.nested_aborts << std::endl
+            << "  other_aborts:    " << st.other_aborts << std::endl;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Run the threads once, and collect the statistics
+//
+
+//
+// Spread of the per-thread throughputs (in Mops/sec); the Jain fairness
+// index is 1 when all the threads do the same number of critical sections,
+// and 1/N when a single thread does all of them.
+//
+struct fairness {
+    double min;
+    double max;
+    double stddev;
+    double jain;
+};
+
+struct run_result {
+    thread_stats all;
+    lock_stats   total;     // writes and reads
+    fairness     threads;
+};
+
+fairness thread_fairness(const std::vector<thread_stats>& per_thread)
+{
+    fairness f = { 0.0, 0.0, 0.0, 1.0 };
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    size_t n = per_thread.size();
+    for (size_t i = 0; i < n; ++i) {
+        const thread_stats& st = per_thread[i];
+        double x = 1e-6 * ((st.writes.iterations + st.reads.iterations)
+                           / time_limit.count());
+        f.min = (i == 0 || x < f.min) ? x : f.min;
+        f.max = (i == 0 || x > f.max) ? x : f.max;
+        sum += x;
+        sum_squares += x * x;
+    }
+    if (n > 0 && sum_squares > 0.0) {
+        double mean = sum / n;
+        f.stddev = std::sqrt(std::max(sum_squares / n - mean * mean, 0.0));
+        f.jain = (sum * sum) / (n * sum_squares);
+    }
+    return f;
+}
+
+run_result run(const std::string& type)
+{
+    stats.assign(num_threads, thread_stats());
+    start_work.store(num_threads, std::memory_order_release);
+
+    if (type == "null_mutex") {
+        run_threads<tle::null_mutex>();
+    }
+    else if (type == "spin_mutex") {
+        run_threads<tle::spin_mutex>();
+    }
+    else if (type == "htm_spin_mutex") {
+        run_threads<tle::htm_spin_mutex>();
+    }
+    else if (type == "htm_adaptive_spin_mutex") {
+        run_threads<tle::htm_adaptive_spin_mutex>();
+    }
+    else if (type == "mcs_mutex") {
+        run_threads<tle::mcs_mutex>();
+    }
+    else if (type == "htm_mcs_mutex") {
+        run_threads<tle::htm_mcs_mutex>();
+    }
+    else if (type == "htm_cohort_mutex") {
+        run_threads<tle::htm_cohort_mutex>();
+    }
+#ifdef __linux__
+    else if (type == "htm_futex_mutex") {
+        run_threads<tle::htm_futex_mutex>();
+    }
+#endif
+    else if (type == "null_shared_mutex") {
+        run_threads<tle::null_shared_mutex, true>();
+    }
+    else if (type == "spin_shared_mutex") {
+        run_threads<tle::spin_shared_mutex, true>();
+    }
+    else if (type == "htm_spin_shared_mutex") {
+        run_threads<tle::htm_spin_shared_mutex, true>();
+    }
+    else if (type == "rp_spin_shared_mutex") {
+        run_threads<tle::rp_spin_shared_mutex, true>();
+    }
+    else if (type == "htm_rp_spin_shared_mutex") {
+        run_threads<tle::htm_rp_spin_shared_mutex, true>();
+    }
+    else if (type == "pf_spin_shared_mutex") {
+        run_threads<tle::pf_spin_shared_mutex, true>();
+    }
+    else if (type == "htm_pf_spin_shared_mutex") {
+        run_threads<tle::htm_pf_spin_shared_mutex, true>();
+    }
+    else if (type == "htm_adaptive_spin_shared_mutex") {
+        run_threads<tle::htm_adaptive_spin_shared_mutex, true>();
+    }
+    else if (type == "dist_shared_mutex") {
+        run_threads<tle::dist_shared_mutex, true>();
+    }
+    else if (type == "htm_dist_shared_mutex") {
+        run_threads<tle::htm_dist_shared_mutex, true>();
+    }
+    else if (type == "htm_cohort_shared_mutex") {
+        run_threads<tle::htm_cohort_shared_mutex, true>();
+    }
+#ifdef __linux__
+    else if (type == "htm_futex_shared_mutex") {
+        run_threads<tle::htm_futex_shared_mutex, true>();
+    }
+#endif
+    else {
+        exit(EXIT_FAILURE);
+    }
+
+    run_result r;
+    for (auto& st: stats) {
+        r.all.work_done += st.work_done;
+        r.all.ops_done += st.ops_done;
+        r.all.overshoot += st.overshoot;
+        r.all.writes += st.writes;
+        r.all.reads += st.reads;
+        tle::detail::libtle_latency_histogram_accumulate(&r.all.wait_elided,
+                                                         &st.wait_elided);
+        tle::detail::libtle_latency_histogram_accumulate(&r.all.wait_locked,
+                                                         &st.wait_locked);
+    }
+    r.total = r.all.writes;
+    r.total += r.all.reads;
+    r.threads = thread_fairness(stats);
+    return r;
+}
+
+
+// -----------------------------------------------------------------------------
+// Report the wait time quantiles of the acquisitions
+//
+
+uint64_t quantile(const tle::latency_histogram& h, double q)
+{
+    return tle::detail::libtle_latency_histogram_quantile(&h, q);
+}
+
+void report_latency(const char* name, const tle::latency_histogram& h)
+{
+    std::cout << name << h.count;
+    if (h.count) {
+        std::cout
+            << ", p50 " << quantile(h, 0.5)
+            << ", p99 " << quantile(h, 0.99)
+            << ", p99.9 " << quantile(h, 0.999)
+            << ", max " << h.max;
+    }
+    std::cout << std::endl;
+}
+
+
+void report_run(const run_result& r)
+{
+    const thread_stats& all = r.all;
+    const lock_stats& total = r.total;
+    std::cout
+        << "throughput (Mwork/sec):  " << 1e-6 * (all.work_done / time_limit.count()) << std::endl
+        << "overshoot:  " << to_time_string(all.overshoot) << std::endl
+        << "work items: " << all.work_done << std::endl;
+    if (shared_data) {
+        std::cout
+            << "workload ops (Mops/sec): "
+            << 1e-6 * (all.ops_done / time_limit.count())
+            << std::endl;
+    }
+    std::cout
+        << "iterations: " << total.iterations << std::endl;
+    std::cout
+        << "locks_acquired:  " << total.locks_acquired << std::endl
+        << "locks_elided:    " << total.locks_elided << std::endl;
+    if (total.locks_elided) {
+        std::cout
+            << "conflict_aborts: " << total.conflict_aborts << std::endl
+            << "capacity_aborts: " << total.capacity_aborts << std::endl
+            << "explicit_aborts: " << total.explicit_aborts << std::endl
+            << "nested_aborts:   " << total.nested_aborts << std::endl
+            << "other_aborts:    " << total.other_aborts << std::endl;
+    }
+    if (read_ratio > 0.0) {
+        report("writes", all.writes);
+        report("reads", all.reads);
+    }
+    std::cout
+        << "per-thread throughput (Mops/sec): min " << r.threads.min
+        << ", max " << r.threads.max << ", stddev " << r.threads.stddev
+        << std::endl
+        << "fairness (Jain index):  " << r.threads.jain << std::endl;
+    report_latency("wait (cycles), elided:   ", all.wait_elided);
+    report_latency("wait (cycles), fallback: ", all.wait_locked);
+}
+
+
+// -----------------------------------------------------------------------------
+// Summarize the repeated runs of a mutex type and thread count
+//
+
+struct sample {
+    double mean;
+    double ci95;    // half width of the 95% confidence interval
+};
+
+sample summarize(const std::vector<double>& xs)
+{
+    // two-sided 95% quantiles of Student's t distribution, for 1 to 30
+    // degrees of freedom; the normal quantile beyond
+    static const double t95[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    sample s = { 0.0, 0.0 };
+    size_t n = xs.size();
+    for (double x: xs) {
+        s.mean += x;
+    }
+    s.mean /= n;
+    if (n > 1) {
+        double var = 0.0;
+        for (double x: xs) {
+            var += (x - s.mean) * (x - s.mean);
+        }
+        var /= (n - 1);
+        double t = (n - 1 <= 30) ? t95[n - 2] : 1.960;
+        s.ci95 = t * std::sqrt(var / n);
+    }
+    return s;
+}
+
+
+void print_header()
+{
+    if (output_format == "csv") {
+        std::cout
+            << "mutex,threads,pinning,workload,read_ratio,duration,repeats,"
+            << "throughput,throughput_ci95,workload_ops,workload_ops_ci95,"
+            << "work,locks_acquired,locks_elided,elided_pct,"
+            << "conflict_aborts,capacity_aborts,explicit_aborts,"
+            << "nested_aborts,other_aborts,"
+            << "thread_min,thread_max,thread_stddev,jain_index,"
+            << "wait_elided,wait_elided_p50,wait_elided_p99,wait_elided_p999,"
+            << "wait_elided_max,wait_locked,wait_locked_p50,wait_locked_p99,"
+            << "wait_locked_p999,wait_locked_max" << std::endl;
+    }
+    else if (output_format == "json") {
+        std::cout << "[" << std::endl;
+    }
+}
+
+
+void print_footer()
+{
+    if (output_format == "json") {
+        std::cout << std::endl << "]" << std::endl;
+    }
+}
+
+
+//
+// Print the means over the runs, and the confidence intervals of the
+// throughputs; the throughputs are in Mops/sec (critical sections, and
+// workload operations), work in Mwork/sec and the counters per run. The
+// wait time quantiles (in cycles) are over the acquisitions of all the runs.
+//
+void print_summary(const std::string& type, const std::vector<run_result>& results,
+                   bool first)
+{
+    std::vector<double> throughputs;
+    std::vector<double> workload_ops;
+    double work = 0.0;
+    double counts[7] = { 0.0 };
+    fairness threads = { 0.0, 0.0, 0.0, 0.0 };
+    tle::latency_histogram wait_elided = tle::latency_histogram();
+    tle::latency_histogram wait_locked = tle::latency_histogram();
+    for (auto& r: results) {
+        threads.min += r.threads.min;
+        threads.max += r.threads.max;
+        threads.stddev += r.threads.stddev;
+        threads.jain += r.threads.jain;
+        tle::detail::libtle_latency_histogram_accumulate(&wait_elided,
+                                                         &r.all.wait_elided);
+        tle::detail::libtle_latency_histogram_accumulate(&wait_locked,
+                                                         &r.all.wait_locked);
+        throughputs.push_back(1e-6 * (r.total.iterations / time_limit.count()));
+        workload_ops.push_back(1e-6 * (r.all.ops_done / time_limit.count()));
+        work += 1e-6 * (r.all.work_done / time_limit.count());
+        counts[0] += r.total.locks_acquired;
+        counts[1] += r.total.locks_elided;
+        counts[2] += r.total.conflict_aborts;
+        counts[3] += r.total.capacity_aborts;
+        counts[4] += r.total.explicit_aborts;
+        counts[5] += r.total.nested_aborts;
+        counts[6] += r.total.other_aborts;
+    }
+    work /= results.size();
+    for (double& c: counts) {
+        c /= results.size();
+    }
+    threads.min /= results.size();
+    threads.max /= results.size();
+    threads.stddev /= results.size();
+    threads.jain /= results.size();
+    sample tput = summarize(throughputs);
+    sample ops = summarize(workload_ops);
+    double locks = counts[0] + counts[1];
+    double elided_pct = locks ? 100.0 * counts[1] / locks : 0.0;
+
+    if (output_format == "text") {
+        if (results.size() > 1) {
+            std::cout
+                << "throughput (Mops/sec):  " << tput.mean
+                << " +/- " << tput.ci95 << " (95% CI, "
+                << results.size() << " runs)" << std::endl;
+        }
+        return;
+    }
+
+    static const char* keys[] = {
+        "mutex", "threads", "pinning", "workload", "read_ratio", "duration",
+        "repeats", "throughput", "throughput_ci95", "workload_ops",
+        "workload_ops_ci95", "work", "locks_acquired", "locks_elided",
+        "elided_pct", "conflict_aborts", "capacity_aborts", "explicit_aborts",
+        "nested_aborts", "other_aborts", "thread_min", "thread_max",
+        "thread_stddev", "jain_index", "wait_elided", "wait_elided_p50",
+        "wait_elided_p99", "wait_elided_p999", "wait_elided_max",
+        "wait_locked", "wait_locked_p50", "wait_locked_p99",
+        "wait_locked_p999", "wait_locked_max"
+    };
+    std::vector<std::string> values;
+    auto quoted = [](const std::string& s) {
+        return output_format == "json" ? "\"" + s + "\"" : s;
+    };
+    auto number = [](double x) {
+        std::stringstream ss;
+        ss << x;
+        return ss.str();
+    };
+    values.push_back(quoted(type));
+    values.push_back(number(num_threads));
+    values.push_back(quoted(pinning));
+    values.push_back(quoted(workload_type));
+    values.push_back(number(read_ratio));
+    values.push_back(number(time_limit.count()));
+    values.push_back(number(results.size()));
+    values.push_back(number(tput.mean));
+    values.push_back(number(tput.ci95));
+    values.push_back(number(ops.mean));
+    values.push_back(number(ops.ci95));
+    values.push_back(number(work));
+    for (size_t i = 0; i < 2; ++i) {
+        values.push_back(number(counts[i]));
+    }
+    values.push_back(number(elided_pct));
+    for (size_t i = 2; i < 7; ++i) {
+        values.push_back(number(counts[i]));
+    }
+    values.push_back(number(threads.min));
+    values.push_back(number(threads.max));
+    values.push_back(number(threads.stddev));
+    values.push_back(number(threads.jain));
+    for (const tle::latency_histogram* h: { &wait_elided, &wait_locked }) {
+        values.push_back(std::to_string(h->count));
+        values.push_back(std::to_string(quantile(*h, 0.5)));
+        values.push_back(std::to_string(quantile(*h, 0.99)));
+        values.push_back(std::to_string(quantile(*h, 0.999)));
+        values.push_back(std::to_string(h->max));
+    }
+
+    if (output_format == "csv") {
+        for (size_t i = 0; i < values.size(); ++i) {
+            std::cout << (i ? "," : "") << values[i];
+        }
+        std::cout << std::endl;
+    }
+    else {
+        std::cout << (first ? "" : ",\n") << "  {";
+        for (size_t i = 0; i < values.size(); ++i) {
+            std::cout << (i ? ", " : "") << "\"" << keys[i] << "\": " << values[i];
+        }
+        std::cout << "}" << std::flush;
+    }
+}
+
+
 // -----------------------------------------------------------------------------
 // Command line argument parsing functions
 //
@@ -238,15 +871,46 @@ std::string to_time_string(jiffies ticks)
 void help()
 {
     std::cout
-        << "usage: bench [-h] [-n N] [-i R] [-d R] -t NAME" << std::endl
+        << "usage: bench [-h] [-n LIST] [-i F] [-l F] [-r F] [-s F]" << std::endl
+        << "             [-w NAME] [-k N] [-m F] [-c N] [-T F] [-W F] [-R N]" << std::endl
+        << "             [-p NAME] [-o NAME] [-L N] -t NAMES" << std::endl
         << "where:" << std::endl
         << "  -h      shows this help message" << std::endl
-        << "  -n N    number of threads" << std::endl
+        << "  -n LIST numbers of threads, e.g., 4, 1,2,4,8, 1-8 or 2-16/2" << std::endl
+        << "          (from 2 to 16 by 2)" << std::endl
         << "  -i F    average interval (in usec) between lock acquisitions" << std::endl
-        << "  -d F    average duration (in usec) of each lock acquisition" << std::endl
-        << "  -t NAME type of mutex. One of: null_mutex, spin_mutex, " << std::endl
-        << "          htm_spin_mutex, null_shared_mutex, " << std::endl
-        << "          spin_shared_mutex, htm_spin_shared_mutex" << std::endl;
+        << "  -l F    average duration (in usec) of each lock acquisition" << std::endl
+        << "  -r F    ratio (0 to 1) of shared acquisitions; needs a shared" << std::endl
+        << "          mutex type" << std::endl
+        << "  -s F    average duration (in usec) of each shared acquisition;" << std::endl
+        << "          same as -l by default" << std::endl
+        << "  -w NAME workload of the critical sections. One of: busy" << std::endl
+        << "          (default; busy work, see -l and -s), hashmap, skiplist," << std::endl
+        << "          queue, array" << std::endl
+        << "  -k N    number of keys of the hashmap and skiplist workloads," << std::endl
+        << "          number of slots of the queue workload (default 1024)" << std::endl
+        << "  -m F    size (in MB) of the array workload (default 1)" << std::endl
+        << "  -c N    number of keys (or cache lines) per critical section" << std::endl
+        << "          (default 1)" << std::endl
+        << "  -T F    duration (in sec) of each run (default 2)" << std::endl
+        << "  -W F    warm-up time (in sec) before each run, not measured" << std::endl
+        << "          (default 0)" << std::endl
+        << "  -R N    number of runs of each mutex type and number of threads" << std::endl
+        << "          (default 1)" << std::endl
+        << "  -p NAME thread pinning. One of: none (default), compact, scatter," << std::endl
+        << "          numa (each thread on any CPU of its NUMA node)" << std::endl
+        << "  -o NAME output format. One of: text (default), csv, json" << std::endl
+        << "  -L N    record the wait time of one in N acquisitions (default 1)" << std::endl
+        << "  -t NAMES comma-separated types of mutex, or all. Types:" << std::endl
+        << "          null_mutex, spin_mutex, htm_spin_mutex," << std::endl
+        << "          htm_adaptive_spin_mutex, mcs_mutex, htm_mcs_mutex," << std::endl
+        << "          htm_cohort_mutex, htm_futex_mutex, null_shared_mutex," << std::endl
+        << "          spin_shared_mutex, htm_spin_shared_mutex," << std::endl
+        << "          rp_spin_shared_mutex, htm_rp_spin_shared_mutex," << std::endl
+        << "          pf_spin_shared_mutex, htm_pf_spin_shared_mutex," << std::endl
+        << "          htm_adaptive_spin_shared_mutex, dist_shared_mutex," << std::endl
+        << "          htm_dist_shared_mutex, htm_cohort_shared_mutex," << std::endl
+        << "          htm_futex_shared_mutex" << std::endl;
 }
 
 
@@ -288,6 +952,68 @@ double safe_strtod(const char* arg, const char* msg = NULL)
 }
 
 
+std::vector<std::string> split(const std::string& arg)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+
+// comma-separated list of numbers (N), ranges (N-M) and strided ranges (N-M/S)
+std::vector<size_t> safe_strtoul_list(const char* arg, const char* msg = NULL)
+{
+    std::vector<size_t> numbers;
+    for (std::string item: split(arg)) {
+        size_t stride = 1;
+        std::string::size_type pos = item.find('/');
+        if (pos != std::string::npos) {
+            stride = safe_strtoul(item.substr(pos + 1).c_str(), msg);
+            item.erase(pos);
+        }
+        size_t first, last;
+        pos = item.find('-');
+        if (pos != std::string::npos) {
+            first = safe_strtoul(item.substr(0, pos).c_str(), msg);
+            last = safe_strtoul(item.substr(pos + 1).c_str(), msg);
+        } else {
+            first = last = safe_strtoul(item.c_str(), msg);
+        }
+        if (stride == 0 || first > last) {
+            std::cout << "error: illegal range for option " << msg << std::endl;
+            help();
+            exit(EXIT_FAILURE);
+        }
+        for (size_t n = first; n <= last; n += stride) {
+            numbers.push_back(n);
+        }
+    }
+    if (numbers.empty()) {
+        std::cout << "error: illegal value for option " << msg << std::endl;
+        help();
+        exit(EXIT_FAILURE);
+    }
+    return numbers;
+}
+
+
+template<typename List>
+std::string join(const List& items)
+{
+    std::stringstream ss;
+    for (auto it = items.cbegin(); it != items.cend(); ++it) {
+        if (it != items.cbegin())
+            ss << ", ";
+        ss << *it;
+    }
+    return ss.str();
+}
+
+
 // -----------------------------------------------------------------------------
 // Program entry point
 //
@@ -299,10 +1025,17 @@ int main(int argc, char** argv)
     // Parse command line arguments
     int ch = '\0';
     opterr = 0;
-    while ((ch = getopt(argc, argv, "n:i:l:t:h")) != -1) {
+    while ((ch = getopt(argc, argv, "n:i:l:r:s:w:k:m:c:T:W:R:p:o:L:t:h")) != -1) {
         switch (ch) {
         case 'n':
-            num_threads = safe_strtoul(optarg, "-n");
+            thread_counts = safe_strtoul_list(optarg, "-n");
+            for (size_t n: thread_counts) {
+                if (n == 0) {
+                    std::cerr << "error: number of threads must be positive"
+                        << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+            }
             break;
         case 'i':
             lock_interval = jiffies(safe_strtod(optarg, "-i"));
@@ -324,18 +1057,110 @@ int main(int argc, char** argv)
                 exit(EXIT_FAILURE);
             }
             break;
+        case 'r':
+            read_ratio = safe_strtod(optarg, "-r");
+            if (read_ratio < 0.0 || read_ratio > 1.0) {
+                std::cerr << "error: read ratio (" << read_ratio
+                    << ") must be between 0 and 1" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 's':
+            shared_lock_duration = jiffies(safe_strtod(optarg, "-s"));
+            if (shared_lock_duration < jpw && shared_lock_duration.count() != 0) {
+                std::cerr
+                    << "error: shared lock duration ("
+                    << to_time_string(shared_lock_duration)
+                    << ") must be bigger than " << to_time_string(jpw)
+                    << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'w':
+            workload_type = std::string(optarg);
+            if (workload_types.find(workload_type) == workload_types.end()) {
+                std::cerr << "error: unknown workload (" << workload_type
+                    << ")" << std::endl;
+                help();
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'k':
+            key_space = safe_strtoul(optarg, "-k");
+            if (key_space == 0) {
+                std::cerr << "error: key space must not be empty" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'm':
+            array_size = safe_strtod(optarg, "-m");
+            if (array_size <= 0.0) {
+                std::cerr << "error: array size must be positive" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'c':
+            keys_per_lock = safe_strtoul(optarg, "-c");
+            if (keys_per_lock == 0) {
+                std::cerr << "error: keys per lock must be positive" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'T':
+            time_limit = std::chrono::duration<double>(safe_strtod(optarg, "-T"));
+            if (time_limit.count() <= 0.0) {
+                std::cerr << "error: duration must be positive" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'W':
+            warm_up = std::chrono::duration<double>(safe_strtod(optarg, "-W"));
+            if (warm_up.count() < 0.0) {
+                std::cerr << "error: warm-up time must not be negative" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'R':
+            repeats = safe_strtoul(optarg, "-R");
+            if (repeats == 0) {
+                std::cerr << "error: number of runs must be positive" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'p':
+            pinning = std::string(optarg);
+            if (pinning_types.find(pinning) == pinning_types.end()) {
+                std::cerr << "error: pinning (" << pinning
+                    << ") must be one of: " << join(pinning_types) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'o':
+            output_format = std::string(optarg);
+            if (output_formats.find(output_format) == output_formats.end()) {
+                std::cerr << "error: output format (" << output_format
+                    << ") must be one of: " << join(output_formats) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'L':
+            latency_interval = safe_strtoul(optarg, "-L");
+            if (latency_interval == 0) {
+                std::cerr << "error: latency sample interval must be positive"
+                    << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
         case 't':
-            mutex_type = std::string(optarg);
-            if (mutex_types.find(mutex_type) == mutex_types.end()) {
-                std::cerr << "error: mutex type (" << mutex_type
-                    << ") must be on of: ";
-                for (auto it = mutex_types.cbegin(); it != mutex_types.cend(); ++it) {
-                    if (it != mutex_types.cbegin())
-                        std::cerr << ", ";
-                    std::cerr << *it;
+            mutex_list.clear();
+            for (auto& type: split(optarg)) {
+                if (type != "all" && mutex_types.find(type) == mutex_types.end()) {
+                    std::cerr << "error: mutex type (" << type
+                        << ") must be on of: all, " << join(mutex_types)
+                        << std::endl;
+                    exit(EXIT_FAILURE);
                 }
-                std::cerr << std::endl;
-                exit(EXIT_FAILURE);
+                mutex_list.push_back(type);
             }
             break;
         default:
@@ -348,85 +1173,109 @@ int main(int argc, char** argv)
             exit((ch == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
         }
     }
-    if (mutex_type == "") {
+    if (mutex_list.empty()) {
         std::cerr << "error: missing mutex type parameter" << std::endl;
         exit(EXIT_FAILURE);
     }
+    auto all = std::find(mutex_list.begin(), mutex_list.end(), "all");
+    if (all != mutex_list.end()) {
+        // the exclusive types cannot run a read/write mix
+        auto& types = (read_ratio > 0.0) ? shared_mutex_types : mutex_types;
+        mutex_list.assign(types.begin(), types.end());
+    }
+    for (auto& type: mutex_list) {
+        if (read_ratio > 0.0 &&
+            shared_mutex_types.find(type) == shared_mutex_types.end()) {
+            std::cerr << "error: read ratio needs a shared mutex type ("
+                << type << ")" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (shared_lock_duration.count() < 0) {
+        shared_lock_duration = lock_duration;
+    }
+    placement.reset(new affinity::placement(pinning));
+    {
+        affinity::saved_mask mask;
+        if (!placement->pin(0)) {
+            std::cerr << "error: cannot pin threads (" << pinning << ")"
+                << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
 
     // update global state
-    start_work.store(num_threads, std::memory_order_release);
-    stats.resize(num_threads);
     uint64_t average_lock_interval = 0.5f + lock_interval.count() / jpw.count();
     average_locked_work = 0.5f + lock_duration.count() / jpw.count();
+    average_shared_locked_work = 0.5f + shared_lock_duration.count() / jpw.count();
     average_unlocked_work = average_lock_interval -  average_locked_work;
 
     // report options
-    std::cout
-        << "number of threads:      " << num_threads << std::endl
-        << "avg. lock interval:     " << to_time_string(lock_interval) << std::endl
-        << "avg. lock duration:     " << to_time_string(lock_duration)
-        << " (" << (100.0 * lock_duration.count() / lock_interval.count()) << "%)"
-        << std::endl
-        << "avg. work per interval: " << average_unlocked_work
-        << " (" << to_time_string(jiffies(average_unlocked_work * jpw.count())) << ")"
-        << std::endl
-        << "avg. work per lock:     " << average_locked_work
-        << " (" << to_time_string(jiffies(average_locked_work * jpw.count())) << ")"
-        << std::endl;
-
-    // run the test
-    if (mutex_type == "null_mutex") {
-        run_threads<tle::null_mutex>();
-    }
-    else if (mutex_type == "spin_mutex") {
-        run_threads<tle::spin_mutex>();
-    }
-    else if (mutex_type == "htm_spin_mutex") {
-        run_threads<tle::htm_spin_mutex>();
-    }
-    else if (mutex_type == "null_shared_mutex") {
-        run_threads<tle::null_shared_mutex>();
-    }
-    else if (mutex_type == "spin_shared_mutex") {
-        run_threads<tle::spin_shared_mutex>();
-    }
-    else if (mutex_type == "htm_spin_shared_mutex") {
-        run_threads<tle::htm_spin_shared_mutex>();
-    }
-    else {
-        exit(EXIT_FAILURE);
+    if (output_format == "text") {
+        std::cout
+            << "number of threads:      " << join(thread_counts) << std::endl
+            << "avg. lock interval:     " << to_time_string(lock_interval) << std::endl
+            << "avg. lock duration:     " << to_time_string(lock_duration)
+            << " (" << (100.0 * lock_duration.count() / lock_interval.count()) << "%)"
+            << std::endl
+            << "avg. work per interval: " << average_unlocked_work
+            << " (" << to_time_string(jiffies(average_unlocked_work * jpw.count())) << ")"
+            << std::endl
+            << "avg. work per lock:     " << average_locked_work
+            << " (" << to_time_string(jiffies(average_locked_work * jpw.count())) << ")"
+            << std::endl;
+        if (workload_type != "busy") {
+            std::cout
+                << "workload:               " << workload_type
+                << " (" << workload::key_space_of(workload_type, key_space, array_size)
+                << " keys, " << keys_per_lock << " per lock)" << std::endl;
+        }
+        if (read_ratio > 0.0) {
+            std::cout
+                << "read ratio:             " << read_ratio << std::endl
+                << "avg. shared lock duration: " << to_time_string(shared_lock_duration)
+                << std::endl
+                << "avg. work per shared lock: " << average_shared_locked_work
+                << " (" << to_time_string(jiffies(average_shared_locked_work * jpw.count())) << ")"
+                << std::endl;
+        }
+        if (time_limit != std::chrono::duration<double>(2.0) || warm_up.count() > 0) {
+            std::cout
+                << "duration:               " << time_limit.count() << "s"
+                << " (warm-up " << warm_up.count() << "s)" << std::endl;
+        }
+        if (pinning != "none") {
+            std::cout
+                << "pinning:                " << pinning
+                << " (" << placement->size() << " cpus)" << std::endl;
+        }
     }
 
-    // report results
-    thread_stats total;
-    for (auto& st: stats) {
-        total.work_done += st.work_done;
-        total.iterations += st.iterations;
-        total.overshoot += st.overshoot;
-        total.locks_acquired += st.locks_acquired;
-        total.locks_elided += st.locks_elided;
-        total.explicit_aborts += st.explicit_aborts;
-        total.conflict_aborts += st.conflict_aborts;
-        total.capacity_aborts += st.capacity_aborts;
-        total.nested_aborts += st.nested_aborts;
-        total.other_aborts += st.other_aborts;
-    }
-    std::cout
-        << "throughput (Mwork/sec):  " << 1e-6 * (total.work_done / time_limit.count()) << std::endl
-        << "overshoot:  " << to_time_string(total.overshoot) << std::endl
-        << "work items: " << total.work_done << std::endl
-        << "iterations: " << total.iterations << std::endl;
-    std::cout
-        << "locks_acquired:  " << total.locks_acquired << std::endl
-        << "locks_elided:    " << total.locks_elided << std::endl;
-    if (total.locks_elided) {
-        std::cout
-            << "conflict_aborts: " << total.conflict_aborts << std::endl
-            << "capacity_aborts: " << total.capacity_aborts << std::endl
-            << "explicit_aborts: " << total.explicit_aborts << std::endl
-            << "nested_aborts:   " << total.nested_aborts << std::endl
-            << "other_aborts:    " << total.other_aborts << std::endl;
+    // run the tests: each mutex type with each number of threads, as many
+    // times as requested
+    bool sweep = mutex_list.size() * thread_counts.size() * repeats > 1;
+    bool first = true;
+    print_header();
+    for (auto& type: mutex_list) {
+        for (size_t n: thread_counts) {
+            num_threads = n;
+            std::vector<run_result> results;
+            for (size_t i = 0; i < repeats; ++i) {
+                if (sweep && output_format == "text") {
+                    std::cout
+                        << "--- " << type << ", " << n << " threads, run "
+                        << (i + 1) << "/" << repeats << std::endl;
+                }
+                results.push_back(run(type));
+                if (output_format == "text") {
+                    report_run(results.back());
+                }
+            }
+            print_summary(type, results, first);
+            first = false;
+        }
     }
+    print_footer();
 
     return 0;
 }
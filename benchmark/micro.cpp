@@ -0,0 +1,404 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+//
+// Fixed cost of the uncontended lock()/unlock() paths of each mutex type, in
+// counter ticks (see libtle_cycles()) and in nanoseconds per operation. A
+// single thread runs tight loops of acquisitions and releases, over each way
+// of acquiring a mutex; the reported cost is the minimum over the rounds.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <tle/mutex.hpp>
+#include <tle/cycle_clock.hpp>
+
+//
+// command line parameters
+//
+size_t iterations = 1000000;
+size_t rounds = 10;
+std::set<std::string> selected;     // empty for all the mutex types
+std::string output_format("text");
+
+std::set<std::string> mutex_types = {
+    "null_mutex",
+    "spin_mutex",
+    "htm_spin_mutex",
+    "htm_adaptive_spin_mutex",
+    "mcs_mutex",
+    "htm_mcs_mutex",
+    "htm_cohort_mutex",
+#ifdef __linux__
+    "htm_futex_mutex",
+#endif
+    "null_shared_mutex",
+    "spin_shared_mutex",
+    "htm_spin_shared_mutex",
+    "rp_spin_shared_mutex",
+    "htm_rp_spin_shared_mutex",
+    "pf_spin_shared_mutex",
+    "htm_pf_spin_shared_mutex",
+    "htm_adaptive_spin_shared_mutex",
+    "dist_shared_mutex",
+    "htm_dist_shared_mutex",
+    "htm_cohort_shared_mutex",
+#ifdef __linux__
+    "htm_futex_shared_mutex"
+#endif
+};
+
+std::set<std::string> output_formats = {
+    "text",
+    "csv"
+};
+
+
+// -----------------------------------------------------------------------------
+// Measurement
+//
+
+inline void compiler_barrier()
+{
+    __asm__ volatile("" ::: "memory");
+}
+
+
+//
+// Minimum cost per call of body(), in counter ticks
+//
+template<typename Body>
+double ticks_per_op(Body body)
+{
+    double best = std::numeric_limits<double>::max();
+    for (size_t r = 0; r < rounds; ++r) {
+        uint64_t start = tle::detail::libtle_cycles_serialized();
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+            compiler_barrier();
+        }
+        uint64_t stop = tle::detail::libtle_cycles_serialized();
+        best = std::min(best, static_cast<double>(stop - start) / iterations);
+    }
+    return best;
+}
+
+
+void print_header()
+{
+    if (output_format == "csv") {
+        std::cout << "mutex,case,ticks_per_op,ns_per_op" << std::endl;
+    } else {
+        std::cout
+            << std::left << std::setw(32) << "mutex"
+            << std::setw(28) << "case"
+            << std::right << std::setw(12) << "ticks/op"
+            << std::setw(12) << "ns/op" << std::endl;
+    }
+}
+
+
+void print_result(const std::string& mutex, const std::string& name,
+                  double ticks)
+{
+    const auto& clock = tle::detail::cycle_clock_calibration::get();
+    double ns = ticks * 1e9 / clock.frequency;
+    if (output_format == "csv") {
+        std::cout << mutex << "," << name << "," << ticks << "," << ns << std::endl;
+    } else {
+        std::stringstream ts, ns_s;
+        ts << std::fixed << std::setprecision(2) << ticks;
+        ns_s << std::fixed << std::setprecision(2) << ns;
+        std::cout
+            << std::left << std::setw(32) << mutex
+            << std::setw(28) << name
+            << std::right << std::setw(12) << ts.str()
+            << std::setw(12) << ns_s.str() << std::endl;
+    }
+}
+
+
+template<typename Body>
+void measure(const std::string& mutex, const std::string& name, Body body)
+{
+    print_result(mutex, name, ticks_per_op(body));
+}
+
+
+// -----------------------------------------------------------------------------
+// Cases
+//
+
+//
+// Mutexes without handle state expose lock()/unlock() themselves (see the
+// void handle specializations of mutex_wrapper)
+//
+template<typename Mutex>
+auto handleless(const std::string& name, Mutex& mtx, int)
+    -> decltype(mtx.lock(), void())
+{
+    typename Mutex::profile_type profile;
+    measure(name, "no handle", [&] { mtx.lock(); mtx.unlock(); });
+    measure(name, "no handle+profile", [&] {
+        mtx.lock(&profile);
+        mtx.unlock(&profile);
+    });
+}
+
+template<typename Mutex>
+void handleless(const std::string&, Mutex&, long)
+{ }
+
+
+template<typename Mutex>
+auto handleless_shared(const std::string& name, Mutex& mtx, int)
+    -> decltype(mtx.lock_shared(), void())
+{
+    typename Mutex::profile_type profile;
+    measure(name, "shared no handle", [&] {
+        mtx.lock_shared();
+        mtx.unlock_shared();
+    });
+    measure(name, "shared no handle+profile", [&] {
+        mtx.lock_shared(&profile);
+        mtx.unlock_shared(&profile);
+    });
+}
+
+template<typename Mutex>
+void handleless_shared(const std::string&, Mutex&, long)
+{ }
+
+
+template<typename Mutex>
+void exclusive_cases(const std::string& name, Mutex& mtx)
+{
+    typedef typename Mutex::handle_type handle_type;
+    typename Mutex::profile_type profile;
+    handle_type plain(mtx);
+    handle_type profiled(mtx, &profile);
+
+    measure(name, "handle", [&] { plain.lock(); plain.unlock(); });
+    measure(name, "handle+profile", [&] { profiled.lock(); profiled.unlock(); });
+    handleless(name, mtx, 0);
+    measure(name, "tle::unique_lock", [&] {
+        tle::unique_lock<handle_type> guard(plain);
+    });
+    measure(name, "std::unique_lock", [&] {
+        std::unique_lock<handle_type> guard(plain);
+    });
+}
+
+
+template<typename Mutex>
+void shared_cases(const std::string& name, Mutex& mtx)
+{
+    typedef typename Mutex::handle_type handle_type;
+    typename Mutex::profile_type profile;
+    handle_type plain(mtx);
+    handle_type profiled(mtx, &profile);
+
+    measure(name, "shared handle", [&] {
+        plain.lock_shared();
+        plain.unlock_shared();
+    });
+    measure(name, "shared handle+profile", [&] {
+        profiled.lock_shared();
+        profiled.unlock_shared();
+    });
+    handleless_shared(name, mtx, 0);
+    measure(name, "tle::shared_lock", [&] {
+        tle::shared_lock<handle_type> guard(plain);
+    });
+}
+
+
+template<typename Mutex>
+void run_mutex(const std::string& name)
+{
+    if (!selected.empty() && selected.find(name) == selected.end()) {
+        return;
+    }
+    Mutex mtx;
+    exclusive_cases(name, mtx);
+}
+
+
+template<typename Mutex>
+void run_shared_mutex(const std::string& name)
+{
+    if (!selected.empty() && selected.find(name) == selected.end()) {
+        return;
+    }
+    Mutex mtx;
+    exclusive_cases(name, mtx);
+    shared_cases(name, mtx);
+}
+
+
+// the loop and the counter reads alone, to subtract from the other results
+void run_baseline()
+{
+    measure("-", "empty loop", [] { });
+}
+
+
+// a transaction with an empty body, when the CPU has HTM
+void run_htm()
+{
+    if (!tle::detail::libtle_htm_supported()) {
+        if (output_format == "text") {
+            std::cout << "(no HTM on this CPU: skipping _xbegin/_xend)" << std::endl;
+        }
+        return;
+    }
+    uint64_t aborts = 0;
+    measure("-", "_xbegin/_xend", [&] {
+        if (_xbegin() == _XBEGIN_STARTED) {
+            _xend();
+        } else {
+            ++aborts;
+        }
+    });
+    if (aborts && output_format == "text") {
+        std::cout << "(" << aborts << " aborted transactions)" << std::endl;
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// Command line argument parsing functions
+//
+
+void help()
+{
+    std::cout
+        << "usage: micro [-h] [-n N] [-r N] [-o NAME] [-t NAMES]" << std::endl
+        << "where:" << std::endl
+        << "  -h      shows this help message" << std::endl
+        << "  -n N    number of operations per round (default 1000000)" << std::endl
+        << "  -r N    number of rounds; the minimum is reported (default 10)" << std::endl
+        << "  -o NAME output format. One of: text (default), csv" << std::endl
+        << "  -t NAMES comma-separated types of mutex (default all); see bench" << std::endl;
+}
+
+
+size_t safe_strtoul(const char* arg, const char* msg = NULL)
+{
+    errno = 0; // some glibc versions require this when linked statically
+
+    char* end;
+    size_t number = std::strtoul(arg, &end, 0);
+    if (end == arg || end == NULL || *end != '\0' || number == 0) {
+        std::cout << "error: illegal value for option " << msg << std::endl;
+        help();
+        exit(EXIT_FAILURE);
+    }
+    if (errno) {
+        std::perror(msg);
+        exit(EXIT_FAILURE);
+    }
+    return number;
+}
+
+
+// -----------------------------------------------------------------------------
+// Program entry point
+//
+
+int main(int argc, char** argv)
+{
+    int ch = '\0';
+    opterr = 0;
+    while ((ch = getopt(argc, argv, "n:r:o:t:h")) != -1) {
+        switch (ch) {
+        case 'n':
+            iterations = safe_strtoul(optarg, "-n");
+            break;
+        case 'r':
+            rounds = safe_strtoul(optarg, "-r");
+            break;
+        case 'o':
+            output_format = std::string(optarg);
+            if (output_formats.find(output_format) == output_formats.end()) {
+                std::cerr << "error: unknown output format (" << output_format
+                    << ")" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 't': {
+            std::stringstream ss(optarg);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (mutex_types.find(item) == mutex_types.end()) {
+                    std::cerr << "error: unknown mutex type (" << item
+                        << ")" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                selected.insert(item);
+            }
+            break;
+        }
+        default:
+            if (ch != 'h') {
+                std::cout << "error: illegal option -"
+                    << static_cast<char>(optopt)
+                    << std::endl;
+            }
+            help();
+            exit((ch == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    if (output_format == "text") {
+#ifdef NDEBUG
+        std::cout << "build:   release (NDEBUG)" << std::endl;
+#else
+        std::cout << "build:   debug" << std::endl;
+#endif
+        std::cout
+            << "counter: " << tle::detail::cycle_clock_calibration::get().frequency
+            << " ticks/sec" << std::endl;
+    }
+    print_header();
+    run_baseline();
+    run_htm();
+    run_mutex<tle::null_mutex>("null_mutex");
+    run_mutex<tle::spin_mutex>("spin_mutex");
+    run_mutex<tle::htm_spin_mutex>("htm_spin_mutex");
+    run_mutex<tle::htm_adaptive_spin_mutex>("htm_adaptive_spin_mutex");
+    run_mutex<tle::mcs_mutex>("mcs_mutex");
+    run_mutex<tle::htm_mcs_mutex>("htm_mcs_mutex");
+    run_mutex<tle::htm_cohort_mutex>("htm_cohort_mutex");
+#ifdef __linux__
+    run_mutex<tle::htm_futex_mutex>("htm_futex_mutex");
+#endif
+    run_shared_mutex<tle::null_shared_mutex>("null_shared_mutex");
+    run_shared_mutex<tle::spin_shared_mutex>("spin_shared_mutex");
+    run_shared_mutex<tle::htm_spin_shared_mutex>("htm_spin_shared_mutex");
+    run_shared_mutex<tle::rp_spin_shared_mutex>("rp_spin_shared_mutex");
+    run_shared_mutex<tle::htm_rp_spin_shared_mutex>("htm_rp_spin_shared_mutex");
+    run_shared_mutex<tle::pf_spin_shared_mutex>("pf_spin_shared_mutex");
+    run_shared_mutex<tle::htm_pf_spin_shared_mutex>("htm_pf_spin_shared_mutex");
+    run_shared_mutex<tle::htm_adaptive_spin_shared_mutex>("htm_adaptive_spin_shared_mutex");
+    run_shared_mutex<tle::dist_shared_mutex>("dist_shared_mutex");
+    run_shared_mutex<tle::htm_dist_shared_mutex>("htm_dist_shared_mutex");
+    run_shared_mutex<tle::htm_cohort_shared_mutex>("htm_cohort_shared_mutex");
+#ifdef __linux__
+    run_shared_mutex<tle::htm_futex_shared_mutex>("htm_futex_shared_mutex");
+#endif
+
+    return 0;
+}
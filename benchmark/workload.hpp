@@ -0,0 +1,353 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __BENCH_WORKLOAD_HPP__
+#define __BENCH_WORKLOAD_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+//
+// Shared data structures that the critical sections of the benchmark work
+// on, so that the elided critical sections have real read and write sets.
+// Everything is allocated up front: the critical sections neither allocate
+// nor free memory, which would abort most transactions.
+//
+// Each operation works on a key in [0, key_space()); the keys are drawn
+// before taking the lock, so the random number generator state does not add
+// to the footprint of the critical section. The conflict probability grows
+// with the number of keys per critical section over the key space.
+//
+namespace workload {
+
+    class base {
+    public:
+        virtual ~base() { }
+
+        // number of distinct keys
+        virtual uint64_t key_space() const = 0;
+
+        // run the operations for the n keys, and return a value that
+        // depends on what they read
+        virtual uint64_t read(const uint64_t* keys, size_t n) = 0;
+        virtual uint64_t write(const uint64_t* keys, size_t n) = 0;
+    };
+
+
+    inline uint64_t mix(uint64_t key) {
+        key *= 0x9e3779b97f4a7c15ull;
+        return key ^ (key >> 29);
+    }
+
+
+    //
+    // Open addressing hash map (linear probing) of n keys, at 50% load. Four
+    // entries share a cache line, so nearby slots conflict too, like in a
+    // real table. Reads look keys up, writes update their values.
+    //
+    class hash_map : public base {
+    public:
+        explicit hash_map(uint64_t n)
+        : _M_keys(n), _M_mask(0), _M_table()
+        {
+            uint64_t capacity = 2;
+            while (capacity < 2 * n) {
+                capacity *= 2;
+            }
+            _M_mask = capacity - 1;
+            _M_table.assign(capacity, entry{empty(), 0});
+
+            std::vector<uint64_t> order(n);
+            for (uint64_t k = 0; k < n; ++k) {
+                order[k] = k;
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937_64(n));
+            for (uint64_t k: order) {
+                _M_find(k)->key = k;
+            }
+        }
+
+        uint64_t key_space() const override { return _M_keys; }
+
+        uint64_t read(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += _M_find(keys[i])->value;
+            }
+            return sum;
+        }
+
+        uint64_t write(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += ++_M_find(keys[i])->value;
+            }
+            return sum;
+        }
+
+    private:
+        static uint64_t empty() { return ~uint64_t(0); }
+
+        struct entry {
+            uint64_t key;
+            uint64_t value;
+        };
+
+        // slot of the key, or the empty slot where it belongs
+        entry* _M_find(uint64_t key) {
+            uint64_t i = mix(key) & _M_mask;
+            while (_M_table[i].key != key && _M_table[i].key != empty()) {
+                i = (i + 1) & _M_mask;
+            }
+            return &_M_table[i];
+        }
+
+        uint64_t            _M_keys;
+        uint64_t            _M_mask;
+        std::vector<entry>  _M_table;
+    };
+
+
+    //
+    // Skiplist over n preallocated nodes, one per key, half of them linked
+    // initially. Reads search for keys; a write searches for a key and
+    // unlinks its node if it is in the list, or links it if it is not, so
+    // writes change the structure along the search path.
+    //
+    class skiplist : public base {
+    public:
+        static const int max_level = 16;
+
+        explicit skiplist(uint64_t n)
+        : _M_nodes(n), _M_head()
+        {
+            std::mt19937_64 rng(n);
+            for (uint64_t k = 0; k < n; ++k) {
+                _M_nodes[k].key = k;
+                _M_nodes[k].value = 0;
+                _M_nodes[k].level = 1;
+                while (_M_nodes[k].level < max_level && (rng() & 3) == 0) {
+                    ++_M_nodes[k].level;
+                }
+            }
+            _M_head.level = max_level;
+            // link every other key, in descending order, at the front
+            for (uint64_t k = n; k-- > 0; ) {
+                if (k % 2 == 0) {
+                    node* x = &_M_nodes[k];
+                    for (int l = 0; l < x->level; ++l) {
+                        x->next[l] = _M_head.next[l];
+                        _M_head.next[l] = x;
+                    }
+                }
+            }
+        }
+
+        uint64_t key_space() const override { return _M_nodes.size(); }
+
+        uint64_t read(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                node* x = &_M_head;
+                for (int l = max_level - 1; l >= 0; --l) {
+                    while (x->next[l] && x->next[l]->key < keys[i]) {
+                        x = x->next[l];
+                    }
+                }
+                x = x->next[0];
+                if (x && x->key == keys[i]) {
+                    sum += x->value;
+                }
+            }
+            return sum;
+        }
+
+        uint64_t write(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                node* update[max_level];
+                node* x = &_M_head;
+                for (int l = max_level - 1; l >= 0; --l) {
+                    while (x->next[l] && x->next[l]->key < keys[i]) {
+                        x = x->next[l];
+                    }
+                    update[l] = x;
+                }
+                node* y = &_M_nodes[keys[i]];
+                if (x->next[0] == y) {
+                    // unlink
+                    for (int l = 0; l < y->level; ++l) {
+                        update[l]->next[l] = y->next[l];
+                    }
+                } else {
+                    // link
+                    for (int l = 0; l < y->level; ++l) {
+                        y->next[l] = update[l]->next[l];
+                        update[l]->next[l] = y;
+                    }
+                }
+                sum += ++y->value;
+            }
+            return sum;
+        }
+
+    private:
+        struct node {
+            uint64_t    key;
+            uint64_t    value;
+            int         level;
+            node*       next[max_level];
+
+            node() : key(0), value(0), level(0), next() { }
+        };
+
+        std::vector<node>   _M_nodes;
+        node                _M_head;
+    };
+
+
+    //
+    // Bounded FIFO queue of n slots, half full initially. Reads peek at the
+    // head; a write pushes or pops (depending on the key), so all writers
+    // conflict on the head and the tail.
+    //
+    class queue : public base {
+    public:
+        explicit queue(uint64_t n)
+        : _M_slots(n), _M_head(0), _M_tail(n / 2)
+        {
+            for (uint64_t i = 0; i < n; ++i) {
+                _M_slots[i] = i;
+            }
+        }
+
+        uint64_t key_space() const override { return _M_slots.size(); }
+
+        uint64_t read(const uint64_t*, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (_M_head.value != _M_tail.value) {
+                    sum += _M_slots[_M_head.value % _M_slots.size()];
+                }
+            }
+            return sum;
+        }
+
+        uint64_t write(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            uint64_t capacity = _M_slots.size();
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t size = _M_tail.value - _M_head.value;
+                bool push = (keys[i] & 1) ? size < capacity : size == 0;
+                if (push) {
+                    _M_slots[_M_tail.value++ % capacity] = keys[i];
+                } else {
+                    sum += _M_slots[_M_head.value++ % capacity];
+                }
+            }
+            return sum;
+        }
+
+    private:
+        // padded, so that the head and the tail are in different lines
+        struct counter {
+            uint64_t value;
+            uint64_t padding[7];
+            explicit counter(uint64_t v) : value(v), padding() { }
+        };
+
+        std::vector<uint64_t>   _M_slots;
+        counter                 _M_head;
+        counter                 _M_tail;
+    };
+
+
+    //
+    // Shared array of cache lines; each key selects a line, which reads load
+    // and writes increment. The read or write set of a critical section is
+    // the number of keys, and the array size sets the conflict probability.
+    //
+    class array : public base {
+    public:
+        explicit array(uint64_t lines)
+        : _M_lines(new line[lines]()), _M_num_lines(lines)
+        { }
+
+        uint64_t key_space() const override { return _M_num_lines; }
+
+        uint64_t read(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += _M_lines[keys[i]].value;
+            }
+            return sum;
+        }
+
+        uint64_t write(const uint64_t* keys, size_t n) override {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += ++_M_lines[keys[i]].value;
+            }
+            return sum;
+        }
+
+    private:
+        struct line {
+            uint64_t value;
+            uint64_t padding[7];
+        };
+
+        std::unique_ptr<line[]> _M_lines;
+        uint64_t                _M_num_lines;
+    };
+
+
+    //
+    // Number of cache lines of an array of array_mb MB (at least one)
+    //
+    inline uint64_t array_lines(double array_mb) {
+        uint64_t lines = static_cast<uint64_t>(array_mb * (1 << 20) / 64);
+        return std::max<uint64_t>(lines, 1);
+    }
+
+
+    //
+    // Key space of the workload make() would build, without building it
+    //
+    inline uint64_t key_space_of(const std::string& name,
+                                 uint64_t key_space, double array_mb) {
+        return name == "array" ? array_lines(array_mb) : key_space;
+    }
+
+
+    //
+    // Workload by name, or nullptr for an unknown name; key_space is the
+    // number of keys (or of queue slots), array_mb the size of the array.
+    //
+    inline std::unique_ptr<base> make(const std::string& name,
+                                      uint64_t key_space, double array_mb) {
+        if (name == "hashmap") {
+            return std::unique_ptr<base>(new hash_map(key_space));
+        }
+        if (name == "skiplist") {
+            return std::unique_ptr<base>(new skiplist(key_space));
+        }
+        if (name == "queue") {
+            return std::unique_ptr<base>(new queue(key_space));
+        }
+        if (name == "array") {
+            return std::unique_ptr<base>(new array(array_lines(array_mb)));
+        }
+        return nullptr;
+    }
+
+} // namespace workload
+
+#endif // __BENCH_WORKLOAD_HPP__
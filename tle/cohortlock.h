@@ -0,0 +1,212 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_COHORTLOCK_H__
+#define __LIBTLE_COHORTLOCK_H__
+
+#include "spinlock.h"
+
+#ifdef __linux__
+#include <asm/unistd.h>
+#endif
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstddef>
+
+namespace tle{ namespace detail{
+
+using std::atomic_int;
+using std::memory_order_relaxed;
+
+#else
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdalign.h>
+#endif
+
+
+/*
+ * Local locks of a cohort lock. Node n uses the local lock n modulo this
+ * number, so on hosts with more nodes, some nodes share a local lock: the
+ * lock stays correct, but a batch may then hand the lock over between two
+ * nodes.
+ */
+#ifndef LIBTLE_COHORTLOCK_MAX_NODES
+#define LIBTLE_COHORTLOCK_MAX_NODES (8)
+#endif
+
+/* Consecutive hand-overs within a node before the global lock is released */
+#ifndef LIBTLE_COHORTLOCK_PASS_LIMIT
+#define LIBTLE_COHORTLOCK_PASS_LIMIT (64)
+#endif
+
+
+/**
+ * @brief  Local lock of a NUMA node in a cohort lock.
+ *
+ * %waiters counts the threads of the node that wait for %lock. %passed is
+ * set when the global lock was handed over with the local lock, and %batch
+ * counts the consecutive hand-overs; both are only accessed by the holder
+ * of %lock.
+ */
+typedef struct {
+    alignas(64) libtle_spinlock_t lock;
+    atomic_int waiters;
+    int passed;
+    unsigned batch;
+} libtle_cohortlock_node_t;
+
+
+/**
+ * @brief  Cohort lock
+ *
+ * A thread first takes the local lock of its NUMA node, then the global
+ * lock, unless the previous holder of the local lock passed the global lock
+ * over with it. A holder that sees waiters on its node releases only the
+ * local lock, up to LIBTLE_COHORTLOCK_PASS_LIMIT times in a row, so the lock
+ * and the data that it protects stay on one node while it is contended.
+ * The lock is busy whenever %global is, so this is the only word an elided
+ * critical section needs to subscribe to.
+ */
+typedef struct {
+    alignas(64) libtle_spinlock_t global;
+    libtle_cohortlock_node_t nodes[LIBTLE_COHORTLOCK_MAX_NODES];
+} libtle_cohortlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_COHORTLOCK_INIT \
+    { LIBTLE_SPINLOCK_INIT, \
+      { [0 ... LIBTLE_COHORTLOCK_MAX_NODES - 1] = { LIBTLE_SPINLOCK_INIT } } }
+#endif
+
+
+static inline void
+libtle_cohortlock_init(libtle_cohortlock_t *lck)
+{
+    unsigned i;
+    libtle_spinlock_init(&lck->global);
+    for (i = 0; i < LIBTLE_COHORTLOCK_MAX_NODES; ++i) {
+        libtle_spinlock_init(&lck->nodes[i].lock);
+        atomic_init(&lck->nodes[i].waiters, 0);
+        lck->nodes[i].passed = 0;
+        lck->nodes[i].batch = 0;
+    }
+}
+
+
+/*
+ * Index of the local lock of the calling thread: its NUMA node, through a raw
+ * getcpu system call on Linux, so the header does not depend on the feature
+ * test macros that declare getcpu(3), modulo LIBTLE_COHORTLOCK_MAX_NODES; 0
+ * when the node is not known, and on other systems. The result is meant to be
+ * cached, e.g., in a mutex handle: a thread that migrates to another node
+ * only loses the locality of the lock.
+ */
+static inline unsigned
+libtle_cohortlock_current_node(void)
+{
+    unsigned node = 0;
+#if defined(__linux__) && defined(__x86_64__)
+    long ret;
+    unsigned cpu;
+    __asm__ volatile("syscall"
+        : "=a" (ret)
+        : "0" ((long) __NR_getcpu), "D" (&cpu), "S" (&node), "d" (0L)
+        : "rcx", "r11", "memory");
+    if (ret < 0) {
+        node = 0;
+    }
+#elif defined(__linux__) && defined(__aarch64__)
+    unsigned cpu;
+    register long x8 __asm__("x8") = __NR_getcpu;
+    register long x0 __asm__("x0") = (long) &cpu;
+    register long x1 __asm__("x1") = (long) &node;
+    register long x2 __asm__("x2") = 0;
+    __asm__ volatile("svc #0"
+        : "+r" (x0)
+        : "r" (x8), "r" (x1), "r" (x2)
+        : "memory");
+    if (x0 < 0) {
+        node = 0;
+    }
+#endif
+    return node % LIBTLE_COHORTLOCK_MAX_NODES;
+}
+
+
+static inline void
+libtle_cohortlock_lock(libtle_cohortlock_t *lck, unsigned node)
+{
+    libtle_cohortlock_node_t *n = &lck->nodes[node];
+
+    atomic_fetch_add_explicit(&n->waiters, 1, memory_order_relaxed);
+    libtle_spinlock_lock(&n->lock);
+    atomic_fetch_sub_explicit(&n->waiters, 1, memory_order_relaxed);
+    if (!n->passed) {
+        libtle_spinlock_lock(&lck->global);
+    }
+}
+
+
+/*
+ * Single attempt to take the lock, without waiting; returns 1 on success
+ */
+static inline int
+libtle_cohortlock_try_lock(libtle_cohortlock_t *lck, unsigned node)
+{
+    libtle_cohortlock_node_t *n = &lck->nodes[node];
+
+    if (!libtle_spinlock_try_lock(&n->lock)) {
+        return 0;
+    }
+    if (!n->passed && !libtle_spinlock_try_lock(&lck->global)) {
+        libtle_spinlock_unlock(&n->lock);
+        return 0;
+    }
+    return 1;
+}
+
+
+static inline void
+libtle_cohortlock_unlock(libtle_cohortlock_t *lck, unsigned node)
+{
+    libtle_cohortlock_node_t *n = &lck->nodes[node];
+
+    if (atomic_load_explicit(&n->waiters, memory_order_relaxed) &&
+        n->batch < LIBTLE_COHORTLOCK_PASS_LIMIT) {
+        /* hand the global lock over to the next thread of the node */
+        n->passed = 1;
+        n->batch += 1;
+        libtle_spinlock_unlock(&n->lock);
+        return;
+    }
+    n->passed = 0;
+    n->batch = 0;
+    libtle_spinlock_unlock(&lck->global);
+    libtle_spinlock_unlock(&n->lock);
+}
+
+
+static inline int
+libtle_cohortlock_is_locked(libtle_cohortlock_t *lck)
+{
+    return libtle_spinlock_is_locked(&lck->global);
+}
+
+
+static inline void
+libtle_cohortlock_unlock_wait(libtle_cohortlock_t *lck)
+{
+    libtle_spinlock_unlock_wait(&lck->global);
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_COHORTLOCK_H__ */
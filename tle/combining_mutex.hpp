@@ -0,0 +1,249 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_COMBINING_MUTEX_HPP__
+#define __TLE_COMBINING_MUTEX_HPP__
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "mutex.h"
+#include "profile.hpp"
+
+
+/* Passes over the publication list of a combiner, per lock acquisition */
+#ifndef LIBTLE_HTM_COMBINING_MUTEX_PASSES
+#define LIBTLE_HTM_COMBINING_MUTEX_PASSES (4)
+#endif
+
+
+namespace tle{ namespace detail{
+
+    //
+    // Transactionally elided mutex whose fallback is flat combining: a
+    // critical section is a callable given to execute(). It is first run as
+    // a transaction that subscribes to the fallback spinlock. When elision
+    // fails, the callable is published in the record of the handle, and the
+    // thread that holds the fallback lock (the combiner) runs the published
+    // callables of all the handles in a batch, while their threads spin on
+    // their own records. The protected data then stays in the cache of the
+    // combiner while the mutex is contended.
+    //
+    // A published callable runs on the combiner thread, so it must not
+    // throw, and it must not depend on thread-local state; results are
+    // returned through its captures.
+    //
+    class htm_combining_mutex {
+        enum _State { _S_idle, _S_pending, _S_done };
+
+        struct _Record {
+            alignas(64) std::atomic<int>    state;
+            void                            (*invoke)(void*);
+            void*                           callable;
+            std::atomic<_Record*>           next;
+
+            _Record() noexcept
+            : state(_S_idle), invoke(nullptr), callable(nullptr), next(nullptr)
+            { }
+        };
+
+        typedef htm_mutex_profile_wrapper<libtle_htm_mutex_profile_t> _Profile;
+
+    public:
+        typedef _Profile profile_type;
+
+        //
+        // This is a local handle for a combining mutex object; it holds the
+        // publication record of its thread, which is registered with the
+        // mutex for the lifetime of the handle.
+        //
+        class handle_type {
+        public:
+            typedef htm_combining_mutex mutex_type;
+            typedef _Profile            profile_type;
+
+            handle_type(const handle_type&) = delete;
+            handle_type& operator=(const handle_type&) = delete;
+
+            handle_type(handle_type&&) = delete;
+            handle_type& operator=(handle_type&&) = delete;
+
+            handle_type(mutex_type& __m, profile_type* __s = nullptr) noexcept
+            : _M_mutex(std::addressof(__m)), _M_stats(__s), _M_record()
+            {
+                _M_mutex->_M_register(&_M_record);
+            }
+
+            ~handle_type() {
+                _M_mutex->_M_unregister(&_M_record);
+            }
+
+            //
+            // Run __f under the mutex (see htm_combining_mutex::execute())
+            //
+            template<typename Function>
+            void execute(Function&& __f) {
+                _M_mutex->execute(*this, std::forward<Function>(__f));
+            }
+
+        private:
+            mutex_type*     _M_mutex;
+            profile_type*   _M_stats;
+            _Record         _M_record;
+
+            friend mutex_type;
+        };
+
+        htm_combining_mutex(const htm_combining_mutex&) = delete;
+        htm_combining_mutex& operator=(const htm_combining_mutex&) = delete;
+
+        htm_combining_mutex(htm_combining_mutex&&) = delete;
+        htm_combining_mutex& operator=(htm_combining_mutex&&) = delete;
+
+        htm_combining_mutex() noexcept
+        : _M_lock(), _M_head(nullptr)
+        {
+            libtle_spinlock_init(&_M_lock);
+        }
+
+        //
+        // Run __f() as a critical section of the mutex, either elided, by
+        // this thread under the fallback lock, or by another thread that
+        // combines it with its own. Returns once __f() has run.
+        //
+        template<typename Function>
+        void execute(handle_type& __h, Function&& __f) {
+            assert(__h._M_mutex == this);
+            typedef typename std::remove_reference<Function>::type _Callable;
+
+            if (libtle_htm_supported()) {
+                int num_retries = 0;
+                unsigned xstatus;
+                do {
+                    libtle_spinlock_unlock_wait(&_M_lock);
+                    xstatus = _xbegin();
+                    if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                        // add the lock to our read-set
+                        if (libtle_spinlock_is_locked(&_M_lock)) {
+                            _xabort(LIBTLE_LOCK_IS_LOCKED);
+                            __builtin_unreachable();
+                        }
+                        __f();
+                        _xend();
+                        if (__h._M_stats && !_xtest()) {
+                            __h._M_stats->update_commit();
+                        }
+                        return;
+                    }
+                    ++num_retries;
+                    if (__h._M_stats) {
+                        __h._M_stats->update_abort(xstatus);
+                    }
+                }
+                while (_XBEGIN_RESTART(xstatus) &&
+                       num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+            }
+
+            // publish the request, then wait for a combiner to run it, or
+            // become the combiner
+            _Record* r = &__h._M_record;
+            r->invoke = &_S_invoke<_Callable>;
+            r->callable = const_cast<void*>(static_cast<const volatile void*>(
+                std::addressof(__f)));
+            r->state.store(_S_pending, std::memory_order_release);
+            for (;;) {
+                if (r->state.load(std::memory_order_acquire) == _S_done) {
+                    break;
+                }
+                if (!libtle_spinlock_is_locked(&_M_lock) &&
+                    libtle_spinlock_try_lock(&_M_lock)) {
+                    _M_combine();
+                    libtle_spinlock_unlock(&_M_lock);
+                    // the request was run, by this or by an earlier combiner
+                    break;
+                }
+                libtle_lock_pause();
+            }
+            r->state.store(_S_idle, std::memory_order_relaxed);
+            if (__h._M_stats) {
+                __h._M_stats->update_unlock();
+            }
+        }
+
+    private:
+        template<typename _Callable>
+        static void _S_invoke(void* __c) noexcept {
+            (*static_cast<_Callable*>(__c))();
+        }
+
+        // called with the fallback lock held
+        void _M_combine() noexcept {
+            for (int pass = 0; pass < LIBTLE_HTM_COMBINING_MUTEX_PASSES; ++pass) {
+                bool found = false;
+                for (_Record* r = _M_head.load(std::memory_order_acquire); r;
+                     r = r->next.load(std::memory_order_relaxed)) {
+                    if (r->state.load(std::memory_order_acquire) == _S_pending) {
+                        r->invoke(r->callable);
+                        r->state.store(_S_done, std::memory_order_release);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    break;
+                }
+            }
+        }
+
+        void _M_register(_Record* __r) noexcept {
+            _Record* head = _M_head.load(std::memory_order_relaxed);
+            do {
+                __r->next.store(head, std::memory_order_relaxed);
+            }
+            while (!_M_head.compare_exchange_weak(head, __r,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        }
+
+        // the records are only unlinked under the fallback lock, so that no
+        // combiner walks over them; new records are only pushed at the head
+        void _M_unregister(_Record* __r) noexcept {
+            libtle_spinlock_lock(&_M_lock);
+            _Record* head = __r;
+            if (!_M_head.compare_exchange_strong(head,
+                    __r->next.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed)) {
+                _Record* prev = head;
+                while (prev->next.load(std::memory_order_relaxed) != __r) {
+                    prev = prev->next.load(std::memory_order_relaxed);
+                }
+                prev->next.store(__r->next.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+            }
+            libtle_spinlock_unlock(&_M_lock);
+        }
+
+        alignas(64) libtle_spinlock_t       _M_lock;
+        alignas(64) std::atomic<_Record*>   _M_head;
+    };
+
+}} // namespace tle::detail
+
+
+namespace tle {
+
+    //
+    // Transactionally elided mutex, whose critical sections are callables
+    // that a single combiner runs in batches when elision fails
+    //
+    using htm_combining_mutex = detail::htm_combining_mutex;
+
+    typedef htm_combining_mutex::handle_type htm_combining_mutex_handle;
+
+} // namespace tle
+
+#endif // __TLE_COMBINING_MUTEX_HPP__
@@ -0,0 +1,161 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_CONDITION_VARIABLE_HPP__
+#define __TLE_CONDITION_VARIABLE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <ctime>
+#include <utility>
+
+#include "mutex.h"
+#include "futexlock.h"
+
+
+namespace tle {
+
+    //
+    // Condition variable for the TLE handles (and any other BasicLockable,
+    // e.g., tle::unique_lock or tle::shared_lock over a handle), waiting on
+    // a futex.
+    //
+    // Blocking cannot be elided: a wait (or a notification that has to wake
+    // up a waiter) inside a transaction aborts it with LIBTLE_LOCK_NO_RETRY,
+    // so the critical section runs again under the fallback lock, without
+    // the retries. The lock is then released through the handle, which knows
+    // how it was acquired, and reacquired with lock(), so a woken waiter
+    // attempts elision again. Notifications that find no waiter only read
+    // the condition variable, and so do not conflict with each other.
+    //
+    class condition_variable_any {
+    public:
+        condition_variable_any() noexcept
+        : _M_state() { }
+
+        condition_variable_any(const condition_variable_any&) = delete;
+        condition_variable_any& operator=(const condition_variable_any&) = delete;
+
+        //
+        // Wake up one waiter, if any
+        //
+        void notify_one() noexcept {
+            _M_notify(1);
+        }
+
+        //
+        // Wake up all the waiters
+        //
+        void notify_all() noexcept {
+            _M_notify(INT_MAX);
+        }
+
+        //
+        // Release the lock, wait for a notification (or a spurious wake-up),
+        // and reacquire the lock
+        //
+        template<typename _Lock>
+        void wait(_Lock& __lock) {
+            unsigned __seq = _M_prepare_wait();
+            __lock.unlock();
+            detail::libtle_futex_wait(&_M_state.seq, __seq);
+            _M_state.waiters.fetch_sub(1, std::memory_order_relaxed);
+            __lock.lock();
+        }
+
+        template<typename _Lock, typename _Predicate>
+        void wait(_Lock& __lock, _Predicate __p) {
+            while (!__p()) {
+                wait(__lock);
+            }
+        }
+
+        template<typename _Lock, typename _Rep, typename _Period>
+        std::cv_status wait_for(_Lock& __lock,
+                                const std::chrono::duration<_Rep,_Period>& __d) {
+            return wait_until(__lock, std::chrono::steady_clock::now() + __d);
+        }
+
+        template<typename _Lock, typename _Rep, typename _Period,
+                 typename _Predicate>
+        bool wait_for(_Lock& __lock,
+                      const std::chrono::duration<_Rep,_Period>& __d,
+                      _Predicate __p) {
+            return wait_until(__lock, std::chrono::steady_clock::now() + __d,
+                              std::move(__p));
+        }
+
+        template<typename _Lock, typename _Clock, typename _Duration>
+        std::cv_status wait_until(_Lock& __lock,
+                                  const std::chrono::time_point<_Clock,_Duration>& __t) {
+            unsigned __seq = _M_prepare_wait();
+            __lock.unlock();
+            // futex timeouts are relative (to CLOCK_MONOTONIC)
+            auto __rel = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                __t - _Clock::now());
+            bool __woken = false;
+            if (__rel.count() > 0) {
+                struct timespec __ts;
+                __ts.tv_sec = static_cast<time_t>(__rel.count() / 1000000000);
+                __ts.tv_nsec = static_cast<long>(__rel.count() % 1000000000);
+                __woken = detail::libtle_futex_wait_for(&_M_state.seq, __seq, &__ts);
+            }
+            _M_state.waiters.fetch_sub(1, std::memory_order_relaxed);
+            __lock.lock();
+            return (__woken || _Clock::now() < __t)
+                ? std::cv_status::no_timeout : std::cv_status::timeout;
+        }
+
+        template<typename _Lock, typename _Clock, typename _Duration,
+                 typename _Predicate>
+        bool wait_until(_Lock& __lock,
+                        const std::chrono::time_point<_Clock,_Duration>& __t,
+                        _Predicate __p) {
+            while (!__p()) {
+                if (wait_until(__lock, __t) == std::cv_status::timeout) {
+                    return __p();
+                }
+            }
+            return true;
+        }
+
+    private:
+        static void _S_no_elision() noexcept {
+            if (detail::libtle_htm_in_transaction()) {
+                _xabort(LIBTLE_LOCK_NO_RETRY);
+            }
+        }
+
+        // called with the lock held; the waiter counts from here on
+        unsigned _M_prepare_wait() noexcept {
+            _S_no_elision();
+            _M_state.waiters.fetch_add(1, std::memory_order_seq_cst);
+            return _M_state.seq.load(std::memory_order_seq_cst);
+        }
+
+        void _M_notify(int __n) noexcept {
+            if (!_M_state.waiters.load(std::memory_order_seq_cst)) {
+                return;
+            }
+            _S_no_elision();
+            _M_state.seq.fetch_add(1, std::memory_order_seq_cst);
+            detail::libtle_futex_wake(&_M_state.seq, __n);
+        }
+
+        struct _State {
+            alignas(64) std::atomic_uint seq;
+            std::atomic_uint waiters;
+
+            _State() noexcept : seq(0), waiters(0) { }
+        };
+
+        _State _M_state;
+    };
+
+} // namespace tle
+
+#endif // __TLE_CONDITION_VARIABLE_HPP__
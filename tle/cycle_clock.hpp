@@ -0,0 +1,125 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_CYCLE_CLOCK_HPP__
+#define __TLE_CYCLE_CLOCK_HPP__
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <time.h>
+
+#include "cycles.h"
+
+namespace tle{ namespace detail{
+
+    //
+    // Conversion of the CPU counter to nanoseconds, as a 32.32 fixed point
+    // multiplier.  The counter frequency comes from CNTFRQ_EL0 on AArch64,
+    // and is measured once against CLOCK_MONOTONIC on x86-64, which assumes
+    // an invariant TSC, synchronized across the CPUs.
+    //
+    struct cycle_clock_calibration {
+        uint64_t frequency;     // counter ticks per second
+        uint64_t mult;          // nanoseconds per tick << 32
+
+        static int64_t _M_monotonic_ns() noexcept {
+            struct timespec ts;
+            if (clock_gettime(CLOCK_MONOTONIC, &ts)) {
+                assert(0);
+            }
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000L + ts.tv_nsec;
+        }
+
+        cycle_clock_calibration() noexcept {
+#if defined(__aarch64__)
+            __asm__ volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+#else
+            // spin for ~10ms; long enough to hide the cost of clock_gettime
+            int64_t t0 = _M_monotonic_ns();
+            uint64_t c0 = libtle_cycles_serialized();
+            int64_t t1;
+            do {
+                t1 = _M_monotonic_ns();
+            } while (t1 - t0 < 10000000L);
+            uint64_t c1 = libtle_cycles_serialized();
+            frequency = static_cast<uint64_t>(
+                static_cast<double>(c1 - c0) * 1e9 / static_cast<double>(t1 - t0));
+#endif
+            mult = static_cast<uint64_t>((1000000000ull << 32) / frequency);
+        }
+
+        int64_t to_ns(uint64_t cycles) const noexcept {
+            return static_cast<int64_t>(
+                (static_cast<unsigned __int128>(cycles) * mult) >> 32);
+        }
+
+        static const cycle_clock_calibration& get() noexcept {
+            static const cycle_clock_calibration calibration;
+            return calibration;
+        }
+    };
+
+
+    //
+    // Steady clock over the CPU counter; the reads are serialized with
+    // respect to the surrounding instructions if Serialized is true.
+    //
+    template<bool Serialized>
+    struct basic_cycle_clock {
+        typedef std::chrono::nanoseconds        duration;
+        typedef duration::rep                   rep;
+        typedef duration::period                period;
+        typedef std::chrono::time_point<basic_cycle_clock> time_point;
+
+        static const bool is_steady = true;
+
+        static time_point now() noexcept {
+            return time_point(duration(
+                cycle_clock_calibration::get().to_ns(cycles())));
+        }
+
+        // raw counter value, and its conversion to a duration
+        static uint64_t cycles() noexcept {
+            return Serialized ? libtle_cycles_serialized() : libtle_cycles();
+        }
+
+        static duration to_duration(uint64_t cycles) noexcept {
+            return duration(cycle_clock_calibration::get().to_ns(cycles));
+        }
+
+        // counter ticks per second
+        static uint64_t frequency() noexcept {
+            return cycle_clock_calibration::get().frequency;
+        }
+
+        // calibrate now, instead of on the first call to now()
+        static void calibrate() noexcept {
+            (void) cycle_clock_calibration::get();
+        }
+    };
+
+}} // namespace tle::detail
+
+
+namespace tle {
+
+    //
+    // Steady clock over the CPU counter (the TSC on x86-64, CNTVCT_EL0 on
+    // AArch64).  It is much cheaper than real_clock, since now() does not
+    // enter the kernel or the vDSO, but the reads are not ordered with
+    // respect to the surrounding instructions.
+    //
+    using cycle_clock = detail::basic_cycle_clock<false>;
+
+    //
+    // Same as cycle_clock, but each read is serialized with respect to the
+    // surrounding instructions, to delimit precisely a measured region.
+    //
+    using serializing_cycle_clock = detail::basic_cycle_clock<true>;
+
+} // namespace tle
+
+#endif // __TLE_CYCLE_CLOCK_HPP__
@@ -0,0 +1,76 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_CYCLES_H__
+#define __LIBTLE_CYCLES_H__
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#elif !defined(__aarch64__)
+#error "Only x86-64 and Aarch64 cycle counters for now"
+#endif
+
+
+#ifdef __cplusplus
+namespace tle{ namespace detail{
+#endif
+
+
+/*
+ * Read the free running counter of the CPU: the TSC on x86-64, the virtual
+ * counter (CNTVCT_EL0) on AArch64. The read is not ordered with respect to
+ * the surrounding instructions, and it does not abort a transaction, so it
+ * is cheap enough to timestamp lock acquisitions. Note that the counter does
+ * not tick at the CPU frequency on AArch64.
+ */
+static inline uint64_t
+libtle_cycles(void)
+{
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    uint64_t ret;
+    __asm__ volatile ("mrs %0, cntvct_el0" : "=r" (ret));
+    return ret;
+#endif
+}
+
+
+/*
+ * Same as libtle_cycles(), but the read waits for all the preceding
+ * instructions to complete, and the following instructions wait for the
+ * read, so it can delimit a measured region. It is more expensive, and it
+ * should not be used within a transaction.
+ */
+static inline uint64_t
+libtle_cycles_serialized(void)
+{
+#if defined(__x86_64__)
+    uint64_t ret;
+    _mm_lfence();
+    ret = __rdtsc();
+    _mm_lfence();
+    return ret;
+#else
+    uint64_t ret;
+    __asm__ volatile ("isb\n"
+                      "mrs %0, cntvct_el0\n"
+                      "isb" : "=r" (ret) :: "memory");
+    return ret;
+#endif
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_CYCLES_H__ */
@@ -0,0 +1,105 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_DEFERRED_H__
+#define __LIBTLE_DEFERRED_H__
+
+#include "mutex.h"
+
+
+/* Actions that a deferred-action queue holds */
+#ifndef LIBTLE_DEFERRED_CAPACITY
+#define LIBTLE_DEFERRED_CAPACITY (8)
+#endif
+
+
+#ifdef __cplusplus
+namespace tle{ namespace detail{
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+/* Deferred actions                                                           */
+/* -------------------------------------------------------------------------- */
+
+
+typedef void (*libtle_deferred_fn_t)(void *);
+
+
+/**
+ * @brief  Actions deferred until a critical section is over.
+ *
+ * Work that aborts a transaction (system calls, I/O, freeing memory, etc.)
+ * is pushed to a queue from the critical section, and run by
+ * libtle_deferred_run() once the mutex is released. The queue is a fixed
+ * buffer, typically per thread next to the mutex handle, so pushing an
+ * action only writes to it: an elided critical section that aborts also
+ * discards the actions that it pushed, and they are pushed again when it
+ * runs under the lock.
+ */
+typedef struct {
+    unsigned count;
+    struct {
+        libtle_deferred_fn_t fn;
+        void *arg;
+    } actions[LIBTLE_DEFERRED_CAPACITY];
+} libtle_deferred_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_DEFERRED_INIT  { 0 }
+#endif
+
+
+static inline void
+libtle_deferred_init(libtle_deferred_t *q)
+{
+    q->count = 0;
+}
+
+
+/*
+ * Run fn(arg) after the critical section, at the next libtle_deferred_run().
+ * When the queue is full, an elided critical section is aborted, to run
+ * again under the fallback lock (see LIBTLE_LOCK_NO_RETRY), where the action
+ * is run right away.
+ */
+static inline void
+libtle_deferred_push(libtle_deferred_t *q, libtle_deferred_fn_t fn, void *arg)
+{
+    if (__builtin_expect(q->count == LIBTLE_DEFERRED_CAPACITY, 0)) {
+        if (libtle_htm_in_transaction()) {
+            _xabort(LIBTLE_LOCK_NO_RETRY);
+        }
+        fn(arg);
+        return;
+    }
+    q->actions[q->count].fn = fn;
+    q->actions[q->count].arg = arg;
+    q->count += 1;
+}
+
+
+/*
+ * Run the deferred actions, in the order they were pushed, and empty the
+ * queue; called after the mutex is released. The actions may push more
+ * actions, which run in the same call.
+ */
+static inline void
+libtle_deferred_run(libtle_deferred_t *q)
+{
+    unsigned i;
+    for (i = 0; i < q->count; ++i) {
+        q->actions[i].fn(q->actions[i].arg);
+    }
+    q->count = 0;
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_DEFERRED_H__ */
@@ -0,0 +1,106 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_DEFERRED_HPP__
+#define __TLE_DEFERRED_HPP__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "deferred.h"
+
+
+namespace tle {
+
+    //
+    // Adaptor of a mutex handle with a queue of actions that run after the
+    // critical section, once unlock() (or unlock_shared()) has committed the
+    // transaction or released the fallback lock: calls to defer(f) within
+    // the critical section run f() then, in order.
+    //
+    // Up to Capacity callables of at most Size bytes are stored in the
+    // handle itself, so deferring never allocates; the ones deferred by an
+    // elided critical section that aborts are discarded with it. When the
+    // queue is full, an elided critical section runs again under the lock,
+    // and a locked one runs the callable right away (see
+    // libtle_deferred_push()).
+    //
+    template<typename Handle,
+             std::size_t Capacity = LIBTLE_DEFERRED_CAPACITY,
+             std::size_t Size = 4 * sizeof(void*)>
+    class deferred_handle : public Handle {
+        static_assert(Capacity <= LIBTLE_DEFERRED_CAPACITY,
+                      "the queue holds at most LIBTLE_DEFERRED_CAPACITY actions");
+
+    public:
+        typedef typename Handle::mutex_type     mutex_type;
+        typedef typename Handle::profile_type   profile_type;
+
+        deferred_handle(mutex_type& __m, profile_type* __s = nullptr) noexcept
+        : Handle(__m, __s), _M_queue()
+        {
+            detail::libtle_deferred_init(&_M_queue);
+        }
+
+        // the actions deferred outside of a critical section run here
+        ~deferred_handle() {
+            detail::libtle_deferred_run(&_M_queue);
+        }
+
+        //
+        // Run __f() after the current critical section
+        //
+        template<typename Function>
+        void defer(Function&& __f) {
+            typedef typename std::decay<Function>::type _Callable;
+            static_assert(sizeof(_Callable) <= Size,
+                          "the deferred callable does not fit in the handle");
+            static_assert(alignof(_Callable) <= alignof(std::max_align_t),
+                          "the deferred callable is over-aligned");
+
+            unsigned i = _M_queue.count;
+            if (i == Capacity) {
+                // full: abort the transaction, or run it now under the lock
+                if (detail::libtle_htm_in_transaction()) {
+                    _xabort(LIBTLE_LOCK_NO_RETRY);
+                }
+                _Callable(std::forward<Function>(__f))();
+                return;
+            }
+            void* p = ::new (static_cast<void*>(&_M_storage[i]))
+                _Callable(std::forward<Function>(__f));
+            detail::libtle_deferred_push(&_M_queue, &_S_run<_Callable>, p);
+        }
+
+        void unlock() {
+            Handle::unlock();
+            detail::libtle_deferred_run(&_M_queue);
+        }
+
+        void unlock_shared() {
+            Handle::unlock_shared();
+            detail::libtle_deferred_run(&_M_queue);
+        }
+
+    private:
+        template<typename _Callable>
+        static void _S_run(void* __p) {
+            _Callable* f = static_cast<_Callable*>(__p);
+            (*f)();
+            f->~_Callable();
+        }
+
+        typedef typename std::aligned_storage<Size, alignof(std::max_align_t)>::type
+            _Storage;
+
+        detail::libtle_deferred_t   _M_queue;
+        _Storage                    _M_storage[Capacity];
+    };
+
+} // namespace tle
+
+#endif // __TLE_DEFERRED_HPP__
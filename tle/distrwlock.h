@@ -0,0 +1,271 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_DISTRWLOCK_H__
+#define __LIBTLE_DISTRWLOCK_H__
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstdint>
+
+namespace tle{ namespace detail{
+
+using std::atomic_uint;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+
+#else
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdalign.h>
+#endif
+
+
+/* Number of reader slots of a distributed reader-writer lock (power of 2) */
+#ifndef LIBTLE_DISTRWLOCK_NUM_SLOTS
+#define LIBTLE_DISTRWLOCK_NUM_SLOTS (32)
+#endif
+
+
+/**
+ * @brief  Reader slot of a distributed reader-writer lock.
+ *
+ * %readers holds the number of active readers that were hashed to this slot.
+ * Each slot lives in its own cache line, so readers that use different slots
+ * do not write to the same cache line.
+ */
+typedef struct {
+    alignas(64) atomic_uint readers;
+} libtle_distrwlock_slot_t;
+
+
+/**
+ * @brief  A reader-writer spinlock with distributed reader indicators.
+ *
+ * %wlock is 1 when a writer holds (or is waiting for) the lock, and 0
+ * otherwise. A reader increments its own slot, then backs off if it sees a
+ * writer; a writer sets %wlock, then waits until all the slots drain. So the
+ * readers of a read-mostly lock never write to a shared cache line, at the
+ * cost of a scan of all the slots by each writer. Writers have priority.
+ */
+typedef struct {
+    alignas(64) atomic_uint     wlock;
+    libtle_distrwlock_slot_t    slots[LIBTLE_DISTRWLOCK_NUM_SLOTS];
+} libtle_distrwlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_DISTRWLOCK_INIT    { ATOMIC_VAR_INIT(0u), { { ATOMIC_VAR_INIT(0u) } } }
+#endif
+
+
+static inline void
+libtle_distrwlock_init(libtle_distrwlock_t *lck)
+{
+    int i;
+    atomic_init(&lck->wlock, 0u);
+    for (i = 0; i < LIBTLE_DISTRWLOCK_NUM_SLOTS; ++i) {
+        atomic_init(&lck->slots[i].readers, 0u);
+    }
+}
+
+
+/*
+ * Map a per-thread object (e.g., a mutex handle) to a reader slot.
+ *
+ * The handles of different threads usually sit at the same offset of their
+ * stacks or TLS blocks, so the upper bits of the address are mixed in too.
+ */
+static inline unsigned
+libtle_distrwlock_slot_of(const void *ptr)
+{
+    uint64_t h = (uint64_t) (uintptr_t) ptr >> 6;
+    h *= 0x9e3779b97f4a7c15ull;
+    return (unsigned) (h >> 32) & (LIBTLE_DISTRWLOCK_NUM_SLOTS - 1);
+}
+
+
+static inline void
+libtle_distrwlock_cpu_relax(void)
+{
+#if defined(__x86_64__)
+    __asm__ volatile("pause" ::: "memory");
+#elif defined(__aarch64__)
+    __asm__ volatile("yield" ::: "memory");
+#else
+    __asm__ volatile("" ::: "memory");
+#endif
+}
+
+
+static inline int
+libtle_distrwlock_is_write_locked(libtle_distrwlock_t *lck)
+{
+    return atomic_load_explicit(&lck->wlock, memory_order_acquire) != 0;
+}
+
+
+static inline void
+libtle_distrwlock_write_unlock_wait(libtle_distrwlock_t *lck)
+{
+    /* wait until no writer holds the lock */
+    while (libtle_distrwlock_is_write_locked(lck)) {
+        libtle_distrwlock_cpu_relax();
+    }
+}
+
+
+static inline void
+libtle_distrwlock_write_lock(libtle_distrwlock_t *lck)
+{
+    int i;
+    unsigned expected;
+
+    /* block new readers and other writers */
+    do {
+        libtle_distrwlock_write_unlock_wait(lck);
+        expected = 0u;
+    } while (!atomic_compare_exchange_weak_explicit(&lck->wlock, &expected, 1u,
+                 memory_order_seq_cst, memory_order_relaxed));
+
+    /* wait for the active readers to drain */
+    for (i = 0; i < LIBTLE_DISTRWLOCK_NUM_SLOTS; ++i) {
+        while (atomic_load_explicit(&lck->slots[i].readers,
+                                    memory_order_acquire)) {
+            libtle_distrwlock_cpu_relax();
+        }
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+static inline void
+libtle_distrwlock_read_lock(libtle_distrwlock_t *lck, unsigned slot)
+{
+    atomic_uint *readers = &lck->slots[slot].readers;
+    while (1) {
+        libtle_distrwlock_write_unlock_wait(lck);
+        /* publish ourselves before we look for a writer again; both are
+           sequentially consistent, so a writer cannot miss us while we
+           miss it */
+        (void) atomic_fetch_add_explicit(readers, 1u, memory_order_seq_cst);
+        if (!atomic_load_explicit(&lck->wlock, memory_order_seq_cst)) {
+            /* really no writers, so we're OK */
+            break;
+        }
+        /* writer got there first, undo the increment */
+        (void) atomic_fetch_sub_explicit(readers, 1u, memory_order_release);
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+/*
+ * Single attempts to take the lock, without waiting; they return 1 on
+ * success. A writer that finds active readers clears %wlock again.
+ */
+static inline int
+libtle_distrwlock_try_write_lock(libtle_distrwlock_t *lck)
+{
+    int i;
+    unsigned expected = 0u;
+
+    if (libtle_distrwlock_is_write_locked(lck) ||
+        !atomic_compare_exchange_strong_explicit(&lck->wlock, &expected, 1u,
+            memory_order_seq_cst, memory_order_relaxed)) {
+        return 0;
+    }
+    for (i = 0; i < LIBTLE_DISTRWLOCK_NUM_SLOTS; ++i) {
+        if (atomic_load_explicit(&lck->slots[i].readers,
+                                 memory_order_acquire)) {
+            atomic_store_explicit(&lck->wlock, 0u, memory_order_release);
+            return 0;
+        }
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_distrwlock_try_read_lock(libtle_distrwlock_t *lck, unsigned slot)
+{
+    atomic_uint *readers = &lck->slots[slot].readers;
+    if (libtle_distrwlock_is_write_locked(lck)) {
+        return 0;
+    }
+    /* see libtle_distrwlock_read_lock() */
+    (void) atomic_fetch_add_explicit(readers, 1u, memory_order_seq_cst);
+    if (atomic_load_explicit(&lck->wlock, memory_order_seq_cst)) {
+        (void) atomic_fetch_sub_explicit(readers, 1u, memory_order_release);
+        return 0;
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+}
+
+
+static inline void
+libtle_distrwlock_write_unlock(libtle_distrwlock_t *lck)
+{
+    atomic_store_explicit(&lck->wlock, 0u, memory_order_release);
+}
+
+
+static inline void
+libtle_distrwlock_read_unlock(libtle_distrwlock_t *lck, unsigned slot)
+{
+    (void) atomic_fetch_sub_explicit(&lck->slots[slot].readers, 1u,
+                                     memory_order_release);
+}
+
+
+static inline int
+libtle_distrwlock_is_locked(libtle_distrwlock_t *lck)
+{
+    /* true if any readers or writers hold the lock; this reads every slot */
+    int i;
+    if (libtle_distrwlock_is_write_locked(lck)) {
+        return 1;
+    }
+    for (i = 0; i < LIBTLE_DISTRWLOCK_NUM_SLOTS; ++i) {
+        if (atomic_load_explicit(&lck->slots[i].readers,
+                                 memory_order_acquire)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static inline void
+libtle_distrwlock_unlock_wait(libtle_distrwlock_t *lck)
+{
+    /* wait until no readers or writers hold the lock */
+    while (libtle_distrwlock_is_locked(lck)) {
+        libtle_distrwlock_cpu_relax();
+    }
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_DISTRWLOCK_H__ */
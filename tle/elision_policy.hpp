@@ -0,0 +1,457 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_ELISION_POLICY_HPP__
+#define __TLE_ELISION_POLICY_HPP__
+
+#include "mutex.h"
+
+
+namespace tle{ namespace detail{
+
+    inline void cpu_relax() noexcept {
+#if defined(__x86_64__)
+        __asm__ volatile("pause" ::: "memory");
+#elif defined(__aarch64__)
+        __asm__ volatile("yield" ::: "memory");
+#else
+        __asm__ volatile("" ::: "memory");
+#endif
+    }
+
+}} // namespace tle::detail
+
+
+namespace tle {
+
+    //
+    // Backoff between the elision attempts; pause(n) is called after the
+    // n-th abort, before the next attempt.
+    //
+    namespace backoff {
+
+        // retry right away
+        struct none {
+            static void pause(int) noexcept
+            { }
+        };
+
+        // spin for Step * n iterations, up to Max
+        template<unsigned Step = 32, unsigned Max = 1024>
+        struct linear {
+            static void pause(int __n) noexcept {
+                unsigned spins = Step * static_cast<unsigned>(__n);
+                spins = spins < Max ? spins : Max;
+                for (unsigned i = 0; i < spins; ++i) {
+                    detail::cpu_relax();
+                }
+            }
+        };
+
+        // spin for Base * 2^(n-1) iterations, up to Max
+        template<unsigned Base = 16, unsigned Max = 1024>
+        struct exponential {
+            static void pause(int __n) noexcept {
+                // in 64 bits, so that Base << 31 does not wrap around
+                unsigned spins = Max;
+                if (__n < 32 &&
+                    (static_cast<unsigned long long>(Base) << (__n - 1)) < Max) {
+                    spins = Base << (__n - 1);
+                }
+                for (unsigned i = 0; i < spins; ++i) {
+                    detail::cpu_relax();
+                }
+            }
+        };
+
+    } // namespace backoff
+
+    //
+    // Abort statuses after which an elision attempt is retried
+    //
+    namespace retry_on {
+
+        // explicit, conflict and retry-hinted aborts (see _XBEGIN_RESTART)
+        struct transient {
+            static bool retryable(unsigned __x) noexcept {
+                return _XBEGIN_RESTART(__x);
+            }
+        };
+
+        // retry-hinted and conflict aborts only; an explicit abort (e.g.,
+        // a busy lock) goes straight to the fallback
+        struct conflict {
+            static bool retryable(unsigned __x) noexcept {
+#if defined(__x86_64__)
+                return __x & (_XABORT_RETRY | _XABORT_CONFLICT);
+#else
+                return __x & _XABORT_RETRY;
+#endif
+            }
+        };
+
+        // all aborts but the capacity and unspecified ones (see _XABORT_HARD),
+        // and the explicit LIBTLE_LOCK_NO_RETRY ones
+        struct soft {
+            static bool retryable(unsigned __x) noexcept {
+                return !_XABORT_HARD(__x) && !_XABORT_NO_RETRY(__x);
+            }
+        };
+
+    } // namespace retry_on
+
+    //
+    // Compile-time elision policy of the basic_htm_* mutexes:
+    //
+    //  - RetryLimit: number of elision attempts before taking the lock
+    //  - Backoff: pause between the attempts (see tle::backoff)
+    //  - Retryable: aborts that allow another attempt (see tle::retry_on)
+    //  - WaitForLock: whether to wait for the lock to be free before each
+    //    attempt, instead of aborting on a busy lock
+    //
+    // Any class with the same static members can be used as a policy.
+    //
+    template<int RetryLimit = LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT,
+             typename Backoff = backoff::none,
+             typename Retryable = retry_on::transient,
+             bool WaitForLock = true>
+    struct elision_policy {
+        static const int retry_limit = RetryLimit;
+        static const bool wait_for_lock = WaitForLock;
+
+        static bool retryable(unsigned __xstatus) noexcept {
+            return Retryable::retryable(__xstatus);
+        }
+
+        static void backoff(int __retries) noexcept {
+            Backoff::pause(__retries);
+        }
+    };
+
+    //
+    // Same behaviour as the plain HTM-based mutexes
+    //
+    typedef elision_policy<> default_elision_policy;
+
+} // namespace tle
+
+
+namespace tle{ namespace detail{
+
+    //
+    // The C mutex types, tagged with the policies of their lock paths. The
+    // unlock paths and the handles are the same as for the untagged types.
+    //
+    template<typename Policy>
+    struct htm_spin_mutex_policy_t : libtle_htm_spin_mutex_t
+    { };
+
+    template<typename WritePolicy, typename ReadPolicy>
+    struct htm_spin_shared_mutex_policy_t : libtle_htm_spin_shared_mutex_t
+    { };
+
+    inline bool htm_policy_is_locked(libtle_spinlock_t* __l) noexcept {
+        return libtle_spinlock_is_locked(__l);
+    }
+
+    inline bool htm_policy_is_locked(libtle_rwlock_t* __l) noexcept {
+        return libtle_rwlock_is_locked(__l);
+    }
+
+    inline void htm_policy_unlock_wait(libtle_spinlock_t* __l) noexcept {
+        libtle_spinlock_unlock_wait(__l);
+    }
+
+    inline void htm_policy_unlock_wait(libtle_rwlock_t* __l) noexcept {
+        libtle_rwlock_unlock_wait(__l);
+    }
+
+    //
+    // Try to start a transaction that subscribes to __l, as the policy says;
+    // returns true in the transaction, or false when the lock must be taken.
+    //
+    template<typename Policy, typename Lock>
+    inline bool htm_policy_elide(Lock* __l, libtle_htm_mutex_profile_t* __p,
+                                 libtle_htm_site_t* __site) {
+        int num_retries = 0;
+        unsigned xstatus;
+        if (Policy::retry_limit <= 0 || !libtle_htm_supported() ||
+            !libtle_htm_site_should_elide(__site)) {
+            return false;
+        }
+        while (1) {
+            if (Policy::wait_for_lock) {
+                htm_policy_unlock_wait(__l);
+            }
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                // add the lock to our read-set
+                if (htm_policy_is_locked(__l)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                return true;
+            }
+            ++num_retries;
+            if (__p) {
+                libtle_htm_mutex_profile_update_abort(__p, xstatus);
+            }
+            if (!Policy::retryable(xstatus) ||
+                num_retries >= Policy::retry_limit) {
+                break;
+            }
+            Policy::backoff(num_retries);
+        }
+        libtle_htm_site_update_fallback(__site);
+        return false;
+    }
+
+    //
+    // Same as htm_policy_elide(), but never waits for the lock: the attempts
+    // stop as soon as the lock is busy, whatever Policy::wait_for_lock says,
+    // and there is no backoff between them.
+    //
+    template<typename Policy, typename Lock>
+    inline bool htm_policy_try_elide(Lock* __l, libtle_htm_mutex_profile_t* __p,
+                                     libtle_htm_site_t* __site) {
+        int num_retries = 0;
+        unsigned xstatus;
+        if (Policy::retry_limit <= 0 || !libtle_htm_supported() ||
+            !libtle_htm_site_should_elide(__site)) {
+            return false;
+        }
+        while (!htm_policy_is_locked(__l)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                // add the lock to our read-set
+                if (htm_policy_is_locked(__l)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                return true;
+            }
+            ++num_retries;
+            if (__p) {
+                libtle_htm_mutex_profile_update_abort(__p, xstatus);
+            }
+            if (!Policy::retryable(xstatus) ||
+                num_retries >= Policy::retry_limit) {
+                libtle_htm_site_update_fallback(__site);
+                break;
+            }
+        }
+        return false;
+    }
+
+    // libtle_mutex_lock_site(), libtle_mutex_lock()
+
+    template<typename Policy>
+    inline void libtle_mutex_lock_site(htm_spin_mutex_policy_t<Policy>* __m,
+                                       libtle_htm_spin_mutex_handle_t* __h,
+                                       libtle_htm_mutex_profile_t* __p,
+                                       libtle_htm_site_t* __site) {
+#ifndef NDEBUG
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        if (htm_policy_elide<Policy>(&__m->state, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return;
+        }
+        libtle_spinlock_lock(&__m->state);
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#else
+        (void) __h;
+        if (!htm_policy_elide<Policy>(&__m->state, __p, __site)) {
+            libtle_spinlock_lock(&__m->state);
+        }
+#endif
+    }
+
+    template<typename Policy>
+    inline void libtle_mutex_lock(htm_spin_mutex_policy_t<Policy>* __m,
+                                  libtle_htm_spin_mutex_handle_t* __h,
+                                  libtle_htm_mutex_profile_t* __p = nullptr) {
+        libtle_mutex_lock_site(__m, __h, __p, nullptr);
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline void libtle_mutex_lock_site(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, libtle_htm_site_t* __site) {
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        if (htm_policy_elide<WritePolicy>(&__m->state, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return;
+        }
+        libtle_rwlock_write_lock(&__m->state);
+        libtle_spinlock_lock_uncontended(&__m->wflag);
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline void libtle_mutex_lock(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p = nullptr) {
+        libtle_mutex_lock_site(__m, __h, __p, nullptr);
+    }
+
+    // libtle_mutex_lock_shared_site(), libtle_mutex_lock_shared()
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline void libtle_mutex_lock_shared_site(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, libtle_htm_site_t* __site) {
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        // readers only subscribe to the writer flag
+        if (htm_policy_elide<ReadPolicy>(&__m->wflag, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return;
+        }
+        libtle_rwlock_read_lock(&__m->state);
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline void libtle_mutex_lock_shared(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p = nullptr) {
+        libtle_mutex_lock_shared_site(__m, __h, __p, nullptr);
+    }
+
+    // libtle_mutex_try_lock_site(), libtle_mutex_try_lock()
+
+    template<typename Policy>
+    inline int libtle_mutex_try_lock_site(htm_spin_mutex_policy_t<Policy>* __m,
+                                          libtle_htm_spin_mutex_handle_t* __h,
+                                          libtle_htm_mutex_profile_t* __p,
+                                          libtle_htm_site_t* __site) {
+#ifndef NDEBUG
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        if (htm_policy_try_elide<Policy>(&__m->state, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return 1;
+        }
+        if (!libtle_spinlock_try_lock(&__m->state)) {
+            return 0;
+        }
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+        return 1;
+#else
+        (void) __h;
+        return htm_policy_try_elide<Policy>(&__m->state, __p, __site) ||
+            libtle_spinlock_try_lock(&__m->state);
+#endif
+    }
+
+    template<typename Policy>
+    inline int libtle_mutex_try_lock(htm_spin_mutex_policy_t<Policy>* __m,
+                                     libtle_htm_spin_mutex_handle_t* __h,
+                                     libtle_htm_mutex_profile_t* __p = nullptr) {
+        return libtle_mutex_try_lock_site(__m, __h, __p, nullptr);
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock_site(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, libtle_htm_site_t* __site) {
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        if (htm_policy_try_elide<WritePolicy>(&__m->state, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return 1;
+        }
+        if (!libtle_rwlock_try_write_lock(&__m->state)) {
+            return 0;
+        }
+        libtle_spinlock_lock_uncontended(&__m->wflag);
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+        return 1;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p = nullptr) {
+        return libtle_mutex_try_lock_site(__m, __h, __p, nullptr);
+    }
+
+    // libtle_mutex_try_lock_shared_site(), libtle_mutex_try_lock_shared()
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock_shared_site(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, libtle_htm_site_t* __site) {
+        assert(__h->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+        if (htm_policy_try_elide<ReadPolicy>(&__m->wflag, __p, __site)) {
+            __h->status = LIBTLE_MUTEX_STATUS_ELIDED;
+            return 1;
+        }
+        if (!libtle_rwlock_try_read_lock(&__m->state)) {
+            return 0;
+        }
+        __h->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+        return 1;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock_shared(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p = nullptr) {
+        return libtle_mutex_try_lock_shared_site(__m, __h, __p, nullptr);
+    }
+
+    // libtle_mutex_try_lock_until(), libtle_mutex_try_lock_shared_until()
+
+    template<typename Policy>
+    inline int libtle_mutex_try_lock_until(htm_spin_mutex_policy_t<Policy>* __m,
+                                           libtle_htm_spin_mutex_handle_t* __h,
+                                           libtle_htm_mutex_profile_t* __p,
+                                           uint64_t __deadline) {
+        unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+        while (!libtle_mutex_try_lock(__m, __h, __p)) {
+            if (!libtle_mutex_wait_until(&delay, __deadline)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock_until(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, uint64_t __deadline) {
+        unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+        while (!libtle_mutex_try_lock(__m, __h, __p)) {
+            if (!libtle_mutex_wait_until(&delay, __deadline)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    template<typename WritePolicy, typename ReadPolicy>
+    inline int libtle_mutex_try_lock_shared_until(
+        htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>* __m,
+        libtle_htm_spin_shared_mutex_handle_t* __h,
+        libtle_htm_mutex_profile_t* __p, uint64_t __deadline) {
+        unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+        while (!libtle_mutex_try_lock_shared(__m, __h, __p)) {
+            if (!libtle_mutex_wait_until(&delay, __deadline)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+}} // namespace tle::detail
+
+#endif // __TLE_ELISION_POLICY_HPP__
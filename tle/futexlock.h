@@ -0,0 +1,470 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_FUTEXLOCK_H__
+#define __LIBTLE_FUTEXLOCK_H__
+
+#include "lock_backoff.h"
+
+#include <linux/futex.h>
+#include <asm/unistd.h>
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+namespace tle{ namespace detail{
+
+using std::atomic_uint;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+
+#else
+#include <stdatomic.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#endif
+
+
+/* Number of spin iterations before a waiter parks in the kernel */
+#ifndef LIBTLE_FUTEXLOCK_SPIN_LIMIT
+#define LIBTLE_FUTEXLOCK_SPIN_LIMIT (256)
+#endif
+
+
+/*
+ * Raw futex system call, so the header does not depend on the feature test
+ * macros that declare syscall(3). Returns the result of the system call, or
+ * a negated errno value.
+ */
+static inline long
+libtle_futex(atomic_uint *uaddr, int op, unsigned val,
+             const struct timespec *timeout)
+{
+#if defined(__x86_64__)
+    long ret;
+    register long r10 __asm__("r10") = (long) timeout;
+    __asm__ volatile("syscall"
+        : "=a" (ret)
+        : "0" ((long) __NR_futex), "D" (uaddr), "S" ((long) op),
+          "d" ((long) val), "r" (r10)
+        : "rcx", "r11", "memory");
+    return ret;
+#elif defined(__aarch64__)
+    register long x8 __asm__("x8") = __NR_futex;
+    register long x0 __asm__("x0") = (long) uaddr;
+    register long x1 __asm__("x1") = op;
+    register long x2 __asm__("x2") = val;
+    register long x3 __asm__("x3") = (long) timeout;
+    __asm__ volatile("svc #0"
+        : "+r" (x0)
+        : "r" (x8), "r" (x1), "r" (x2), "r" (x3)
+        : "memory");
+    return x0;
+#else
+#error "Only x86-64 and Aarch64 futexes for now"
+#endif
+}
+
+
+/* Sleep while *uaddr == val (or until a wake-up, or a signal) */
+static inline void
+libtle_futex_wait(atomic_uint *uaddr, unsigned val)
+{
+    (void) libtle_futex(uaddr, FUTEX_WAIT_PRIVATE, val, NULL);
+}
+
+
+/*
+ * Same as libtle_futex_wait(), for at most the relative timeout. Returns 0
+ * when the wait timed out, 1 otherwise.
+ */
+static inline int
+libtle_futex_wait_for(atomic_uint *uaddr, unsigned val,
+                      const struct timespec *timeout)
+{
+    return libtle_futex(uaddr, FUTEX_WAIT_PRIVATE, val, timeout) != -ETIMEDOUT;
+}
+
+
+/* Wake up to n threads that sleep on uaddr */
+static inline void
+libtle_futex_wake(atomic_uint *uaddr, int n)
+{
+    (void) libtle_futex(uaddr, FUTEX_WAKE_PRIVATE, (unsigned) n, NULL);
+}
+
+
+static inline void
+libtle_futexlock_acquire_barrier(void)
+{
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+/**
+ * @brief  Spin-then-park mutual exclusion lock
+ *
+ * Bit 0 of %lock is set while the lock is busy. Bit 1 is set when some
+ * threads may sleep on %lock to acquire it, and bit 2 when some threads may
+ * sleep on it to wait for the lock to be free, without acquiring it (i.e.,
+ * before an elision attempt). The sleepers only set them while the lock is
+ * busy, so %lock is 0 when the lock is free, and this is the only word an
+ * elided critical section needs to subscribe to.
+ *
+ * A release clears the whole word, and enters the kernel only if it cleared
+ * one of the sleeper bits. It then wakes up a single thread that sleeps to
+ * acquire the lock, which sets bit 1 again when it takes the lock, so its own
+ * release wakes up the next one; but it wakes up all the sleepers when bit 2
+ * was set, since those can go ahead together. The exchange that releases the
+ * lock is its last access to the lock, so a thread may destroy the lock as
+ * soon as it could acquire it, even while the previous owner is still in
+ * libtle_futexlock_unlock() (the wake-up only passes the address to the
+ * kernel).
+ */
+typedef struct {
+    atomic_uint lock;
+} libtle_futexlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_FUTEXLOCK_INIT { ATOMIC_VAR_INIT(0u) }
+#endif
+
+
+static inline void
+libtle_futexlock_init(libtle_futexlock_t *lck)
+{
+    atomic_init(&lck->lock, 0u);
+}
+
+
+static inline void
+libtle_futexlock_lock(libtle_futexlock_t *lck)
+{
+    unsigned c;
+    int i;
+
+    /* spin for a while... */
+    for (i = 0; i < LIBTLE_FUTEXLOCK_SPIN_LIMIT; ++i) {
+        c = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (c == 0u &&
+            atomic_compare_exchange_weak_explicit(&lck->lock, &c, 1u,
+                memory_order_acquire, memory_order_relaxed)) {
+            libtle_futexlock_acquire_barrier();
+            return;
+        }
+        libtle_lock_pause();
+    }
+
+    /* ...then mark the lock as contended, and sleep until it is free */
+    c = atomic_fetch_or_explicit(&lck->lock, 3u, memory_order_acquire);
+    while (c & 1u) {
+        libtle_futex_wait(&lck->lock, c | 3u);
+        c = atomic_fetch_or_explicit(&lck->lock, 3u, memory_order_acquire);
+    }
+    libtle_futexlock_acquire_barrier();
+}
+
+
+/* Single attempt to take the lock, without waiting; returns 1 on success */
+static inline int
+libtle_futexlock_try_lock(libtle_futexlock_t *lck)
+{
+    unsigned c = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if (c != 0u ||
+        !atomic_compare_exchange_strong_explicit(&lck->lock, &c, 1u,
+            memory_order_acquire, memory_order_relaxed)) {
+        return 0;
+    }
+    libtle_futexlock_acquire_barrier();
+    return 1;
+}
+
+
+static inline void
+libtle_futexlock_lock_uncontended(libtle_futexlock_t *lck)
+{
+    atomic_store_explicit(&lck->lock, 1u, memory_order_release);
+}
+
+
+static inline void
+libtle_futexlock_unlock(libtle_futexlock_t *lck)
+{
+    unsigned c = atomic_exchange_explicit(&lck->lock, 0u,
+                                          memory_order_release);
+    /* only enter the kernel if somebody may sleep on the lock */
+    if (c != 1u) {
+        libtle_futex_wake(&lck->lock, (c & 4u) ? INT_MAX : 1);
+    }
+}
+
+
+static inline int
+libtle_futexlock_is_locked(libtle_futexlock_t *lck)
+{
+    return atomic_load_explicit(&lck->lock, memory_order_acquire) != 0u;
+}
+
+
+static inline void
+libtle_futexlock_unlock_wait(libtle_futexlock_t *lck)
+{
+    unsigned c;
+    int i;
+
+    for (i = 0; i < LIBTLE_FUTEXLOCK_SPIN_LIMIT; ++i) {
+        if (!libtle_futexlock_is_locked(lck)) {
+            return;
+        }
+        libtle_lock_pause();
+    }
+
+    /* ask the owner to wake us up, then sleep until the lock is free */
+    c = atomic_load_explicit(&lck->lock, memory_order_acquire);
+    while (c != 0u) {
+        if ((c & 4u) ||
+            atomic_compare_exchange_weak_explicit(&lck->lock, &c, c | 4u,
+                memory_order_acquire, memory_order_acquire)) {
+            libtle_futex_wait(&lck->lock, c | 4u);
+            c = atomic_load_explicit(&lck->lock, memory_order_acquire);
+        }
+    }
+}
+
+
+/**
+ * @brief  Spin-then-park reader-writer lock
+ *
+ * %lock keeps an active writer in bit 0, a pending writer in bit 1, and the
+ * number of active readers in bits 4:N, like the lock word of libtle_rwlock_t
+ * with the reader count shifted. Bit 2 is set when some writers may sleep on
+ * %lock, and bit 3 when some readers (or threads that wait for the lock to be
+ * free) may sleep on it. The sleepers only set them while the lock is held
+ * or a writer is pending, so an elided critical section still subscribes to
+ * this single word.
+ *
+ * Each release is a single read-modify-write of %lock, which clears the
+ * sleeper bits once their waiters may go ahead, and enters the kernel only if
+ * it cleared one of them: it wakes up all the sleepers when bit 3 is set,
+ * and otherwise a single writer, which sets bit 2 again when it takes the
+ * lock, so its own release wakes up the next one. As for libtle_futexlock_t,
+ * that read-modify-write is the last access to the lock.
+ */
+typedef struct {
+    atomic_uint lock;
+} libtle_futex_rwlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_FUTEX_RWLOCK_INIT { ATOMIC_VAR_INIT(0u) }
+#endif
+
+
+static inline void
+libtle_futex_rwlock_init(libtle_futex_rwlock_t *lck)
+{
+    atomic_init(&lck->lock, 0u);
+}
+
+
+/*
+ * One wait step while (%lock & mask) != 0: spin for the first *spins steps,
+ * then set the sleeper bit %flag and sleep on %lock, until it changes.
+ */
+static inline void
+libtle_futex_rwlock_wait(libtle_futex_rwlock_t *lck, unsigned flag,
+                         unsigned mask, int *spins)
+{
+    unsigned s;
+    if (*spins < LIBTLE_FUTEXLOCK_SPIN_LIMIT) {
+        ++*spins;
+        libtle_lock_pause();
+        return;
+    }
+    s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if ((s & mask) &&
+        ((s & flag) ||
+         atomic_compare_exchange_strong_explicit(&lck->lock, &s, s | flag,
+             memory_order_relaxed, memory_order_relaxed))) {
+        libtle_futex_wait(&lck->lock, s | flag);
+    }
+}
+
+
+/*
+ * Wake up the sleepers after a release changed %lock from s to n. Readers and
+ * writers sleep on the same word, so a single writer is only woken up when no
+ * reader may sleep; otherwise it could be a reader that goes back to sleep.
+ */
+static inline void
+libtle_futex_rwlock_wake(libtle_futex_rwlock_t *lck, unsigned s, unsigned n)
+{
+    if (s & ~n & 12u) {
+        libtle_futex_wake(&lck->lock, (s & 8u) ? INT_MAX : 1);
+    }
+}
+
+
+static inline void
+libtle_futex_rwlock_write_lock(libtle_futex_rwlock_t *lck)
+{
+    int spins = 0;
+    while (1) {
+        unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (!(s & ~14u)) {
+            /* the lock is not acquired by any readers or a writer; once we
+               slept, keep bit 2 set for the writers that sleep after us */
+            unsigned n = 1u | (s & 12u) |
+                         (spins >= LIBTLE_FUTEXLOCK_SPIN_LIMIT ? 4u : 0u);
+            if (atomic_compare_exchange_weak_explicit(&lck->lock, &s, n,
+                    memory_order_acquire, memory_order_relaxed)) {
+                break;
+            }
+        } else if (!(s & 2u)) {
+            /* no other pending writers, mark as pending to block readers */
+            (void) atomic_fetch_or_explicit(&lck->lock, 2u,
+                                            memory_order_relaxed);
+        } else {
+            libtle_futex_rwlock_wait(lck, 4u, ~14u, &spins);
+        }
+    }
+    libtle_futexlock_acquire_barrier();
+}
+
+
+/*
+ * Drop a reader; the last holder lets the sleeping writers go, and the
+ * sleeping readers too when no writer is pending.
+ */
+static inline void
+libtle_futex_rwlock_read_release(libtle_futex_rwlock_t *lck)
+{
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    unsigned n;
+    do {
+        n = s - 16u;
+        if (!(n & ~14u)) {
+            n &= (n & 2u) ? ~4u : ~12u;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&lck->lock, &s, n,
+                 memory_order_release, memory_order_relaxed));
+    libtle_futex_rwlock_wake(lck, s, n);
+}
+
+
+static inline void
+libtle_futex_rwlock_read_lock(libtle_futex_rwlock_t *lck)
+{
+    int spins = 0;
+    while (1) {
+        unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (!(s & 3u)) {
+            /* there is no pending or active writer, so we can
+               acquire a reader lock (increment reader count) */
+            unsigned t = atomic_fetch_add_explicit(&lck->lock, 16u,
+                                                   memory_order_acquire);
+            if (!(t & 1u)) {
+                /* really no active writers, so we're OK */
+                break;
+            }
+            /* writer got there first, undo the increment */
+            libtle_futex_rwlock_read_release(lck);
+        } else {
+            libtle_futex_rwlock_wait(lck, 8u, 3u, &spins);
+        }
+    }
+    libtle_futexlock_acquire_barrier();
+}
+
+
+/*
+ * Single attempts to take the lock, without waiting and without marking a
+ * pending writer; they return 1 on success.
+ */
+static inline int
+libtle_futex_rwlock_try_write_lock(libtle_futex_rwlock_t *lck)
+{
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if ((s & ~14u) ||
+        !atomic_compare_exchange_strong_explicit(&lck->lock, &s,
+            1u | (s & 12u), memory_order_acquire, memory_order_relaxed)) {
+        return 0;
+    }
+    libtle_futexlock_acquire_barrier();
+    return 1;
+}
+
+
+static inline int
+libtle_futex_rwlock_try_read_lock(libtle_futex_rwlock_t *lck)
+{
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if (s & 3u) {
+        return 0;
+    }
+    if (atomic_fetch_add_explicit(&lck->lock, 16u, memory_order_acquire) & 1u) {
+        /* writer got there first, undo the increment */
+        libtle_futex_rwlock_read_release(lck);
+        return 0;
+    }
+    libtle_futexlock_acquire_barrier();
+    return 1;
+}
+
+
+static inline void
+libtle_futex_rwlock_write_unlock(libtle_futex_rwlock_t *lck)
+{
+    /* clear the writer and sleeper bits, but not the readers that are
+       about to undo their increment (see libtle_futex_rwlock_read_lock) */
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&lck->lock, &s, s & ~15u,
+               memory_order_release, memory_order_relaxed)) {
+    }
+    libtle_futex_rwlock_wake(lck, s, s & ~15u);
+}
+
+
+static inline void
+libtle_futex_rwlock_read_unlock(libtle_futex_rwlock_t *lck)
+{
+    libtle_futex_rwlock_read_release(lck);
+}
+
+
+static inline int
+libtle_futex_rwlock_is_locked(libtle_futex_rwlock_t *lck)
+{
+    /* true if any readers or writers hold (or wait for) the lock */
+    return (atomic_load_explicit(&lck->lock, memory_order_acquire) & ~12u) != 0u;
+}
+
+
+static inline void
+libtle_futex_rwlock_unlock_wait(libtle_futex_rwlock_t *lck)
+{
+    /* wait until no readers or writers hold the lock */
+    int spins = 0;
+    while (libtle_futex_rwlock_is_locked(lck)) {
+        libtle_futex_rwlock_wait(lck, 8u, ~12u, &spins);
+    }
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_FUTEXLOCK_H__ */
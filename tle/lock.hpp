@@ -6,6 +6,9 @@
 #ifndef __TLE_LOCK_HPP__
 #define __TLE_LOCK_HPP__
 
+#include <chrono>
+#include <mutex>
+
 namespace tle {
 
     //
@@ -19,10 +22,23 @@ namespace tle {
     //
     constexpr defer_lock_t  defer_lock = defer_lock_t();
 
+    //
+    // Try to lock without waiting; the same tag as std::try_to_lock
+    //
+    using std::try_to_lock_t;
+    using std::try_to_lock;
+
+    //
+    // Take over a mutex that the caller already locked; the same tag as
+    // std::adopt_lock
+    //
+    using std::adopt_lock_t;
+    using std::adopt_lock;
+
 
     //
     // A unique_lock controls mutex ownership within a scope, releasing
-    // ownership in the destructor.
+    // ownership in the destructor if it owns the mutex.
     //
     template<typename _Mutex> struct unique_lock {
         typedef _Mutex mutex_type;
@@ -36,35 +52,88 @@ namespace tle {
         unique_lock& operator=(unique_lock&&) = delete;
 
         explicit unique_lock(mutex_type& __m) noexcept
-        : _M_handle(__m) {
+        : _M_handle(__m), _M_owns(false) {
             lock();
         }
 
         unique_lock(mutex_type& __m, defer_lock_t) noexcept
-        : _M_handle(__m) {
-            // defer locking, must explicitly lock the unique_lock or the mutex
+        : _M_handle(__m), _M_owns(false) {
+            // defer locking, must explicitly lock the unique_lock; a mutex
+            // locked directly is not released by the destructor
+        }
+
+        unique_lock(mutex_type& __m, adopt_lock_t) noexcept
+        : _M_handle(__m), _M_owns(true) {
+            // the caller locked the mutex, the destructor releases it
+        }
+
+        // see owns_lock() for the outcome of these
+        unique_lock(mutex_type& __m, try_to_lock_t)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock();
+        }
+
+        template<typename _Rep, typename _Period>
+        unique_lock(mutex_type& __m,
+                    const std::chrono::duration<_Rep,_Period>& __d)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock_for(__d);
+        }
+
+        template<typename _Clock, typename _Duration>
+        unique_lock(mutex_type& __m,
+                    const std::chrono::time_point<_Clock,_Duration>& __t)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock_until(__t);
         }
 
         ~unique_lock() {
-            unlock();
+            if (_M_owns) {
+                unlock();
+            }
         }
 
         void lock() {
             _M_handle.lock();
+            _M_owns = true;
+        }
+
+        bool try_lock() {
+            return _M_owns = _M_handle.try_lock();
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+            return _M_owns = _M_handle.try_lock_for(__d);
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+            return _M_owns = _M_handle.try_lock_until(__t);
         }
 
         void unlock() {
             _M_handle.unlock();
+            _M_owns = false;
+        }
+
+        bool owns_lock() const noexcept {
+            return _M_owns;
+        }
+
+        explicit operator bool() const noexcept {
+            return _M_owns;
         }
 
     private:
         mutex_type&     _M_handle;
+        bool            _M_owns;
     };
 
 
     //
     // A shared_lock controls shared_mutex ownership within a scope, releasing
-    // ownership in the destructor.
+    // ownership in the destructor if it owns the mutex.
     //
     template<typename _Mutex> struct shared_lock {
         typedef _Mutex mutex_type;
@@ -78,29 +147,82 @@ namespace tle {
         shared_lock& operator=(shared_lock&&) = delete;
 
         explicit shared_lock(mutex_type& __m) noexcept
-        : _M_handle(__m) {
+        : _M_handle(__m), _M_owns(false) {
             lock();
         }
 
         shared_lock(mutex_type& __m, defer_lock_t) noexcept
-        : _M_handle(__m) {
-            // defer locking, must explicitly lock the shared_lock or the mutex
+        : _M_handle(__m), _M_owns(false) {
+            // defer locking, must explicitly lock the shared_lock; a mutex
+            // locked directly is not released by the destructor
+        }
+
+        shared_lock(mutex_type& __m, adopt_lock_t) noexcept
+        : _M_handle(__m), _M_owns(true) {
+            // the caller locked the mutex (shared), the destructor releases it
+        }
+
+        // see owns_lock() for the outcome of these
+        shared_lock(mutex_type& __m, try_to_lock_t)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock();
+        }
+
+        template<typename _Rep, typename _Period>
+        shared_lock(mutex_type& __m,
+                    const std::chrono::duration<_Rep,_Period>& __d)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock_for(__d);
+        }
+
+        template<typename _Clock, typename _Duration>
+        shared_lock(mutex_type& __m,
+                    const std::chrono::time_point<_Clock,_Duration>& __t)
+        : _M_handle(__m), _M_owns(false) {
+            try_lock_until(__t);
         }
 
         ~shared_lock() {
-            unlock();
+            if (_M_owns) {
+                unlock();
+            }
         }
 
         void lock() {
             _M_handle.lock_shared();
+            _M_owns = true;
+        }
+
+        bool try_lock() {
+            return _M_owns = _M_handle.try_lock_shared();
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+            return _M_owns = _M_handle.try_lock_shared_for(__d);
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+            return _M_owns = _M_handle.try_lock_shared_until(__t);
         }
 
         void unlock() {
             _M_handle.unlock_shared();
+            _M_owns = false;
+        }
+
+        bool owns_lock() const noexcept {
+            return _M_owns;
+        }
+
+        explicit operator bool() const noexcept {
+            return _M_owns;
         }
 
     private:
         mutex_type&     _M_handle;
+        bool            _M_owns;
     };
 
 } // namespace tle
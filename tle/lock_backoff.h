@@ -0,0 +1,81 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_LOCK_BACKOFF_H__
+#define __LIBTLE_LOCK_BACKOFF_H__
+
+/*
+ * Selection of the lock acquisition sequences of spinlock.h and rwlock.h
+ *
+ * LIBTLE_LOCK_BACKOFF: when defined, the contended acquisitions wait with a
+ * bounded exponential backoff (between LIBTLE_LOCK_BACKOFF_MIN and
+ * LIBTLE_LOCK_BACKOFF_MAX pauses) before each new attempt, instead of
+ * retrying as soon as the lock looks free. This trades some hand-over
+ * latency for less cache line traffic when many threads fall back at once.
+ *
+ * LIBTLE_LOCK_LSE: defined on AArch64 when the target has the Armv8.1 Large
+ * System Extensions (e.g., -march=armv8-a+lse), unless LIBTLE_LOCK_NO_LSE is
+ * defined. The acquisitions then use LSE atomics (SWPA, CASA, LDADDA), which
+ * are safe with TME lock elision without the DMB of the Load-Exclusive/
+ * Store-Exclusive sequences (see the note in spinlock.h).
+ */
+
+#ifndef LIBTLE_LOCK_BACKOFF_MIN
+#define LIBTLE_LOCK_BACKOFF_MIN (4)
+#endif
+
+#ifndef LIBTLE_LOCK_BACKOFF_MAX
+#define LIBTLE_LOCK_BACKOFF_MAX (1024)
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_ATOMICS) && \
+    !defined(LIBTLE_LOCK_NO_LSE) && !defined(LIBTLE_LOCK_LSE)
+#define LIBTLE_LOCK_LSE 1
+#endif
+
+
+#ifdef __cplusplus
+namespace tle{ namespace detail{
+#endif
+
+
+/*
+ * Short delay of a spin loop: PAUSE on x86-64, and ISB on AArch64, since
+ * YIELD is a no-op on most cores while ISB takes tens of cycles.
+ */
+static inline void
+libtle_lock_pause(void)
+{
+#if defined(__x86_64__)
+    __asm__ volatile("pause" ::: "memory");
+#elif defined(__aarch64__)
+    __asm__ volatile("isb" ::: "memory");
+#else
+    __asm__ volatile("" ::: "memory");
+#endif
+}
+
+
+/*
+ * Pause for *delay iterations, then double *delay up to the maximum.
+ */
+static inline void
+libtle_lock_backoff(unsigned *delay)
+{
+    unsigned i;
+    for (i = 0; i < *delay; ++i) {
+        libtle_lock_pause();
+    }
+    if (*delay < LIBTLE_LOCK_BACKOFF_MAX) {
+        *delay *= 2;
+    }
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_LOCK_BACKOFF_H__ */
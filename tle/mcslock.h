@@ -0,0 +1,203 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_MCSLOCK_H__
+#define __LIBTLE_MCSLOCK_H__
+
+#ifdef __cplusplus
+#include <atomic>
+#include <cstdint>
+
+namespace tle{ namespace detail{
+
+using std::atomic_int;
+using std::atomic_uintptr_t;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_acq_rel;
+
+#else
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdalign.h>
+#endif
+
+
+/**
+ * @brief  Queue node of an MCS lock.
+ *
+ * Each waiter spins on the %locked flag of its own node, which lives in its
+ * own cache line, until its predecessor hands the lock over. %next points to
+ * the successor node, if any.
+ */
+typedef struct {
+    alignas(64) atomic_uintptr_t next;
+    atomic_int locked;
+} libtle_mcslock_node_t;
+
+
+/**
+ * @brief  MCS queue lock
+ *
+ * %tail points to the node of the last thread in the queue, or 0 when the lock
+ * is free. The lock is busy whenever %tail is not 0, so this is the only word
+ * an elided critical section needs to subscribe to.
+ */
+typedef struct {
+    atomic_uintptr_t tail;
+} libtle_mcslock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_MCSLOCK_INIT    { ATOMIC_VAR_INIT(0) }
+#endif
+
+
+static inline void
+libtle_mcslock_init(libtle_mcslock_t *lck)
+{
+    atomic_init(&lck->tail, (uintptr_t) 0);
+}
+
+
+static inline void
+libtle_mcslock_node_init(libtle_mcslock_node_t *node)
+{
+    atomic_init(&node->next, (uintptr_t) 0);
+    atomic_init(&node->locked, 0);
+}
+
+
+static inline void
+libtle_mcslock_node_wait(libtle_mcslock_node_t *node)
+{
+#if defined(__x86_64__)
+    while (atomic_load_explicit(&node->locked, memory_order_acquire))
+        __asm__ volatile("pause");
+#elif defined(__aarch64__)
+    int tmp;
+    __asm__ volatile(
+"       sevl\n"
+"    1: wfe\n"
+"       ldaxr   %w0, %1\n"
+"       cbnz    %w0, 1b\n"
+        : "=&r" (tmp)
+        : "Q" (node->locked)
+        : "memory");
+#else
+    while (atomic_load_explicit(&node->locked, memory_order_acquire))
+        ;
+#endif
+}
+
+
+static inline void
+libtle_mcslock_lock(libtle_mcslock_t *lck, libtle_mcslock_node_t *node)
+{
+    uintptr_t prev;
+
+    atomic_store_explicit(&node->next, (uintptr_t) 0, memory_order_relaxed);
+    atomic_store_explicit(&node->locked, 1, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&lck->tail, (uintptr_t) node,
+                                    memory_order_acq_rel);
+    if (prev) {
+        /* queue up behind the previous tail and wait for our turn */
+        atomic_store_explicit(&((libtle_mcslock_node_t *) prev)->next,
+                              (uintptr_t) node, memory_order_release);
+        libtle_mcslock_node_wait(node);
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+/*
+ * Take the lock only if the queue is empty, without queueing up; returns 1
+ * on success.
+ */
+static inline int
+libtle_mcslock_try_lock(libtle_mcslock_t *lck, libtle_mcslock_node_t *node)
+{
+    uintptr_t expected = 0;
+
+    if (atomic_load_explicit(&lck->tail, memory_order_relaxed)) {
+        return 0;
+    }
+    atomic_store_explicit(&node->next, (uintptr_t) 0, memory_order_relaxed);
+    atomic_store_explicit(&node->locked, 0, memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&lck->tail, &expected,
+            (uintptr_t) node, memory_order_acq_rel, memory_order_relaxed)) {
+        return 0;
+    }
+#if defined(__aarch64__)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+}
+
+
+static inline void
+libtle_mcslock_unlock(libtle_mcslock_t *lck, libtle_mcslock_node_t *node)
+{
+    uintptr_t next = atomic_load_explicit(&node->next, memory_order_acquire);
+    if (!next) {
+        uintptr_t expected = (uintptr_t) node;
+        if (atomic_compare_exchange_strong_explicit(&lck->tail, &expected,
+                (uintptr_t) 0, memory_order_release, memory_order_relaxed)) {
+            /* nobody is waiting */
+            return;
+        }
+        /* a successor swapped the tail, but it has not linked itself yet */
+        while (!(next = atomic_load_explicit(&node->next, memory_order_acquire))) {
+#if defined(__x86_64__)
+            __asm__ volatile("pause");
+#elif defined(__aarch64__)
+            __asm__ volatile("yield");
+#endif
+        }
+    }
+    atomic_store_explicit(&((libtle_mcslock_node_t *) next)->locked, 0,
+                          memory_order_release);
+}
+
+
+static inline int
+libtle_mcslock_is_locked(libtle_mcslock_t *lck)
+{
+    return atomic_load_explicit(&lck->tail, memory_order_acquire) != 0;
+}
+
+
+static inline void
+libtle_mcslock_unlock_wait(libtle_mcslock_t *lck)
+{
+#if defined(__x86_64__)
+    while (libtle_mcslock_is_locked(lck))
+        __asm__ volatile("pause");
+#elif defined(__aarch64__)
+    uintptr_t tmp;
+    __asm__ volatile(
+"       sevl\n"
+"    1: wfe\n"
+"       ldaxr   %0, %1\n"
+"       cbnz    %0, 1b\n"
+        : "=&r" (tmp)
+        : "Q" (lck->tail));
+#else
+    while (libtle_mcslock_is_locked(lck))
+        ;
+#endif
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_MCSLOCK_H__ */
@@ -8,28 +8,52 @@
 
 #ifdef __cplusplus
 #include <cassert>
+#include <cstdlib>
 #else
 #include <assert.h>
 #include <stdalign.h>
+#include <stdlib.h>
 #endif
 #include "profile.h"
 #include "spinlock.h"
 #include "rwlock.h"
+#include "pfrwlock.h"
+#include "mcslock.h"
+#include "cohortlock.h"
+#include "distrwlock.h"
+#ifdef __linux__
+#include "futexlock.h"
+#endif
 
 #if defined(__x86_64__)
 
 #include <immintrin.h>
+#include <cpuid.h>
 
 #define LIBTLE_LOCK_IS_LOCKED   (255)
+#define LIBTLE_LOCK_NO_RETRY    (254)
+
+#define _XABORT_NO_RETRY(s) \
+    (((s) & _XABORT_EXPLICIT) && _XABORT_CODE(s) == LIBTLE_LOCK_NO_RETRY)
 
 #define _XBEGIN_RESTART(s) \
-    ((s) & (_XABORT_EXPLICIT | _XABORT_RETRY | _XABORT_CONFLICT))
+    (((s) & (_XABORT_EXPLICIT | _XABORT_RETRY | _XABORT_CONFLICT)) && \
+     !_XABORT_NO_RETRY(s))
 
 #elif defined(__aarch64__)
 
 #include "tme.h"
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
 
 #define LIBTLE_LOCK_IS_LOCKED   (65535)
+/* without the retry bit (bit 15) of the tcancel immediate */
+#define LIBTLE_LOCK_NO_RETRY    (0x7ffe)
+
+#define _XABORT_NO_RETRY(s) \
+    (((s) & _XABORT_EXPLICIT) && _XABORT_CODE(s) == LIBTLE_LOCK_NO_RETRY)
 
 #define _XBEGIN_RESTART(s) \
     ((s) & _XABORT_RETRY)
@@ -53,9 +77,63 @@
 #define LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT (10)
 #endif
 
+/* Upper bound of the retry budget learned by the adaptive mutexes */
+#ifndef LIBTLE_HTM_ADAPTIVE_RETRY_LIMIT
+#define LIBTLE_HTM_ADAPTIVE_RETRY_LIMIT (LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT)
+#endif
+
+/* Shortest and longest cooling-off periods, in acquisitions */
+#ifndef LIBTLE_HTM_ADAPTIVE_SKIP_MIN
+#define LIBTLE_HTM_ADAPTIVE_SKIP_MIN (16)
+#endif
+
+#ifndef LIBTLE_HTM_ADAPTIVE_SKIP_MAX
+#define LIBTLE_HTM_ADAPTIVE_SKIP_MAX (4096)
+#endif
+
+/* Consecutive fallbacks without a commit before a call site stops eliding */
+#ifndef LIBTLE_HTM_SITE_THRESHOLD
+#define LIBTLE_HTM_SITE_THRESHOLD (16)
+#endif
+
+/* A call site that stopped eliding probes elision once per interval */
+#ifndef LIBTLE_HTM_SITE_PROBE_INTERVAL
+#define LIBTLE_HTM_SITE_PROBE_INTERVAL (256)
+#endif
+
+/*
+ * LIBTLE_HTM_PRESSURE: when defined, libtle_htm_spin_mutex_t keeps an
+ * abort-pressure word, so that its waiters back off during fallback storms
+ * (see libtle_htm_pressure_t).
+ */
+
+/* Cycles after the last fallback before a mutex goes back to speculation */
+#ifndef LIBTLE_HTM_PRESSURE_DECAY
+#define LIBTLE_HTM_PRESSURE_DECAY (1u << 16)
+#endif
+
+/* Pressure level from which the waiters skip elision */
+#ifndef LIBTLE_HTM_PRESSURE_THRESHOLD
+#define LIBTLE_HTM_PRESSURE_THRESHOLD (4)
+#endif
+
+/* Longest randomized delay (in pauses) before an attempt, per level */
+#ifndef LIBTLE_HTM_PRESSURE_DELAY
+#define LIBTLE_HTM_PRESSURE_DELAY (16)
+#endif
+
+/* True for aborts that are unlikely to succeed on retry (capacity, other) */
+#define _XABORT_HARD(s) \
+    (((s) & _XABORT_CAPACITY) || \
+     !((s) & (_XABORT_EXPLICIT | _XABORT_RETRY | _XABORT_CONFLICT)))
+
 
 #ifdef __cplusplus
 namespace tle{ namespace detail{
+
+using std::atomic_int;
+using std::atomic_ullong;
+using std::memory_order_relaxed;
 #endif
 
 
@@ -73,6 +151,464 @@ enum libtle_mutex_status_t {
 };
 
 
+/*
+ * Wait step of the timed lock operations, between two attempts. Returns 0 if
+ * the counter (see libtle_cycles()) is past %deadline, otherwise backs off
+ * for *delay pauses (see libtle_lock_backoff()) and returns 1. The deadlines
+ * are compared modulo 2^64, so they must be less than 2^63 ticks away.
+ */
+static inline int
+libtle_mutex_wait_until(unsigned *delay, uint64_t deadline)
+{
+    if ((int64_t) (libtle_cycles() - deadline) >= 0) {
+        return 0;
+    }
+    libtle_lock_backoff(delay);
+    return 1;
+}
+
+
+/*
+ * Define %name as the timed form of %try_lock, a single attempt that takes
+ * the (mutex, handle, profile) arguments: it repeats the attempt, with the
+ * wait steps of libtle_mutex_wait_until() in between, and returns 0 once the
+ * deadline passed, 1 when it got the mutex.
+ */
+#define LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(name, try_lock, mutex_t, handle_t, \
+                                           profile_t)                        \
+static inline int                                                            \
+name(mutex_t *mtx, handle_t *st, profile_t *p, uint64_t deadline)            \
+{                                                                            \
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;                                \
+    while (!try_lock(mtx, st, p)) {                                          \
+        if (!libtle_mutex_wait_until(&delay, deadline)) {                    \
+            return 0;                                                        \
+        }                                                                    \
+    }                                                                        \
+    return 1;                                                                \
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM support detection                                                      */
+/* -------------------------------------------------------------------------- */
+
+
+#if defined(__aarch64__)
+/*
+ * The handler blocks SIGILL while it runs, and sigsetjmp() restores the
+ * signal mask on the jump out of it, so SIGILL is not left blocked in the
+ * probing thread (and the threads that it creates later). Both are only
+ * declared with POSIX; in strict ISO C, signal() of glibc has System V
+ * semantics (SA_NODEFER), so SIGILL is not blocked while the handler runs
+ * and setjmp() is enough.
+ */
+#if defined(_POSIX_C_SOURCE)
+typedef sigjmp_buf libtle_htm_probe_jmp_buf;
+#define LIBTLE_HTM_PROBE_SETJMP(env)    sigsetjmp(env, 1)
+#define LIBTLE_HTM_PROBE_LONGJMP(env)   siglongjmp(env, 1)
+#else
+typedef jmp_buf libtle_htm_probe_jmp_buf;
+#define LIBTLE_HTM_PROBE_SETJMP(env)    setjmp(env)
+#define LIBTLE_HTM_PROBE_LONGJMP(env)   longjmp(env, 1)
+#endif
+
+
+#ifdef __cplusplus
+#define LIBTLE_HTM_PROBE_THREAD_LOCAL   thread_local
+#else
+#define LIBTLE_HTM_PROBE_THREAD_LOCAL   _Thread_local
+#endif
+
+
+static inline libtle_htm_probe_jmp_buf *
+libtle_htm_probe_env(void)
+{
+    static LIBTLE_HTM_PROBE_THREAD_LOCAL libtle_htm_probe_jmp_buf env;
+    return &env;
+}
+
+
+static inline void
+libtle_htm_probe_sigill(int sig)
+{
+    (void) sig;
+    LIBTLE_HTM_PROBE_LONGJMP(*libtle_htm_probe_env());
+}
+
+
+/*
+ * Run a transaction once, with a SIGILL handler installed for the duration
+ * of the probe; returns 1 if TSTART did not trap. The handler of SIGILL is
+ * process-wide, so the probe must not run while another thread expects
+ * SIGILL. libtle_htm_supported() runs it at most once per process.
+ */
+static inline int
+libtle_htm_probe_tme(void)
+{
+    volatile int ok = 0;
+#if defined(_POSIX_C_SOURCE)
+    struct sigaction sa, old;
+    sa.sa_handler = libtle_htm_probe_sigill;
+    sa.sa_flags = 0;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGILL, &sa, &old)) {
+        return 0;
+    }
+#else
+    void (*old)(int) = signal(SIGILL, libtle_htm_probe_sigill);
+    if (old == SIG_ERR) {
+        return 0;
+    }
+#endif
+    if (!LIBTLE_HTM_PROBE_SETJMP(*libtle_htm_probe_env())) {
+        if (_xbegin() == _XBEGIN_STARTED) {
+            _xend();
+        }
+        ok = 1;
+    }
+#if defined(_POSIX_C_SOURCE)
+    (void) sigaction(SIGILL, &old, NULL);
+#else
+    (void) signal(SIGILL, old);
+#endif
+    return ok;
+}
+#endif
+
+
+/*
+ * Query the CPU for HTM support: the RTM feature bit on x86-64 (ignoring CPUs
+ * where RTM always aborts), and on AArch64 a trial transaction, guarded
+ * against SIGILL. The TME field of ID_AA64ISAR0_EL1 (read through the kernel
+ * emulation, when the kernel exposes HWCAP_CPUID) is only advisory there:
+ * Linux hides the field from user space, so it reads as 0 on most kernels,
+ * and only a set field skips the trial.
+ *
+ * The environment variable LIBTLE_HTM overrides the detection: "0" turns
+ * elision off, and "1" forces it on (on a CPU without HTM, the first
+ * elision attempt then faults).
+ */
+static inline int
+libtle_htm_detect(void)
+{
+#if defined(LIBTLE_HTM_ASSUME_SUPPORTED)
+    return 1;
+#else
+    const char *env = getenv("LIBTLE_HTM");
+    if (env && (env[0] == '0' || env[0] == '1') && !env[1]) {
+        return env[0] == '1';
+    }
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return 0;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    /* RTM is bit 11 of EBX, RTM_ALWAYS_ABORT is bit 11 of EDX */
+    return (ebx & (1u << 11)) && !(edx & (1u << 11));
+#elif defined(__aarch64__)
+    unsigned long isar0;
+    if (getauxval(AT_HWCAP) & HWCAP_CPUID) {
+        __asm__ ("mrs %0, ID_AA64ISAR0_EL1" : "=r" (isar0));
+        /* TME is bits 27:24 */
+        if ((isar0 >> 24) & 0xf) {
+            return 1;
+        }
+    }
+    return libtle_htm_probe_tme();
+#endif
+#endif
+}
+
+
+#ifdef __cplusplus
+/* A static member of a class template has a single instance per process */
+template <typename T = void>
+struct libtle_htm_supported_cache {
+    static atomic_int value;
+};
+
+template <typename T>
+atomic_int libtle_htm_supported_cache<T>::value(-1);
+
+#define LIBTLE_HTM_SUPPORTED_CACHE  (libtle_htm_supported_cache<>::value)
+#else
+/* A weak definition has a single instance per process */
+__attribute__((weak)) atomic_int libtle_htm_supported_cache =
+    ATOMIC_VAR_INIT(-1);
+
+#define LIBTLE_HTM_SUPPORTED_CACHE  (libtle_htm_supported_cache)
+#endif
+
+
+/*
+ * Slow path of libtle_htm_supported(). The first caller moves the cache from
+ * -1 (unknown) to -2 (detecting) and runs libtle_htm_detect(); concurrent
+ * callers wait for its result, so the detection runs once per process.
+ */
+static inline int
+libtle_htm_supported_detect(void)
+{
+    int s = -1;
+    if (atomic_compare_exchange_strong_explicit(&LIBTLE_HTM_SUPPORTED_CACHE,
+            &s, -2, memory_order_relaxed, memory_order_relaxed)) {
+        s = libtle_htm_detect();
+        atomic_store_explicit(&LIBTLE_HTM_SUPPORTED_CACHE, s,
+                              memory_order_relaxed);
+        return s;
+    }
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+    while (s < 0) {
+        libtle_lock_backoff(&delay);
+        s = atomic_load_explicit(&LIBTLE_HTM_SUPPORTED_CACHE,
+                                 memory_order_relaxed);
+    }
+    return s;
+}
+
+
+/*
+ * True if the CPU supports HTM. The HTM-based mutexes check this before each
+ * elision attempt, and go straight to their fallback lock when it is false,
+ * so the same binary runs on CPUs with HTM fused off or disabled. The result
+ * is detected once per process, on the first call, and cached, and the check
+ * is a load and a well predicted branch. Define LIBTLE_HTM_ASSUME_SUPPORTED
+ * to skip the detection.
+ */
+static inline int
+libtle_htm_supported(void)
+{
+    int s = atomic_load_explicit(&LIBTLE_HTM_SUPPORTED_CACHE,
+                                 memory_order_relaxed);
+    if (__builtin_expect(s < 0, 0)) {
+        s = libtle_htm_supported_detect();
+    }
+    return s;
+}
+
+
+/*
+ * True inside a transaction. Critical sections that must not run elided
+ * (e.g., that block in the kernel) abort with LIBTLE_LOCK_NO_RETRY, after
+ * which the HTM-based mutexes go straight to their fallback lock.
+ */
+static inline int
+libtle_htm_in_transaction(void)
+{
+    return libtle_htm_supported() && _xtest();
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Per call site elision predictor                                            */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Commit/abort history of one critical section (call site).
+ *
+ * %score counts down the fallbacks since the last commit at this site. When
+ * it reaches 0 the site is considered to never commit, and its acquisitions
+ * go straight to the fallback lock; only one in LIBTLE_HTM_SITE_PROBE_INTERVAL
+ * of them (counted in %skipped) tries to elide again. A single commit makes
+ * the site elide again.
+ *
+ * The counters are only written on the fallback path, or when a commit
+ * changes the prediction, so in steady state the site is read-only and stays
+ * shared in all the caches.
+ */
+typedef struct {
+    alignas(64) atomic_int score;
+    atomic_uint   skipped;
+    const char   *file;
+    int           line;
+} libtle_htm_site_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_SITE_INIT(F,L) \
+    { ATOMIC_VAR_INIT(LIBTLE_HTM_SITE_THRESHOLD), ATOMIC_VAR_INIT(0u), (F), (L) }
+#else
+#define LIBTLE_HTM_SITE_INIT(F,L) \
+    { {LIBTLE_HTM_SITE_THRESHOLD}, {0u}, (F), (L) }
+#endif
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_SITE_T libtle_htm_site_t
+#else
+#define LIBTLE_HTM_SITE_T ::tle::detail::libtle_htm_site_t
+#endif
+
+/* Define a call site token named N, tagged with the current file and line */
+#define LIBTLE_HTM_SITE_DEFINE(N) \
+    static LIBTLE_HTM_SITE_T N = LIBTLE_HTM_SITE_INIT(__FILE__, __LINE__)
+
+
+static inline void
+libtle_htm_site_init(libtle_htm_site_t *site, const char *file, int line)
+{
+    atomic_init(&site->score, LIBTLE_HTM_SITE_THRESHOLD);
+    atomic_init(&site->skipped, 0u);
+    site->file = file;
+    site->line = line;
+}
+
+
+static inline int
+libtle_htm_site_should_elide(libtle_htm_site_t *site)
+{
+    if (__builtin_expect(!site ||
+            atomic_load_explicit(&site->score, memory_order_relaxed) > 0, 1)) {
+        return 1;
+    }
+    /* this site never commits; only probe once in a while */
+    return (atomic_fetch_add_explicit(&site->skipped, 1u, memory_order_relaxed)
+            % LIBTLE_HTM_SITE_PROBE_INTERVAL) == LIBTLE_HTM_SITE_PROBE_INTERVAL - 1;
+}
+
+
+static inline void
+libtle_htm_site_update_commit(libtle_htm_site_t *site)
+{
+    if (site && atomic_load_explicit(&site->score, memory_order_relaxed)
+            != LIBTLE_HTM_SITE_THRESHOLD) {
+        atomic_store_explicit(&site->score, LIBTLE_HTM_SITE_THRESHOLD,
+                              memory_order_relaxed);
+    }
+}
+
+
+static inline void
+libtle_htm_site_update_fallback(libtle_htm_site_t *site)
+{
+    if (site && atomic_load_explicit(&site->score, memory_order_relaxed) > 0) {
+        (void) atomic_fetch_sub_explicit(&site->score, 1, memory_order_relaxed);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Abort-pressure signal                                                      */
+/* -------------------------------------------------------------------------- */
+
+
+#define LIBTLE_HTM_PRESSURE_LEVELS  (0xfull)
+
+
+/**
+ * @brief  Recent fallbacks of one mutex.
+ *
+ * When a thread falls back, the transactions of all the others abort, and
+ * they retry in lockstep as soon as the lock is released, which tends to
+ * make them all fall back in turn. %word holds the time (libtle_cycles())
+ * of the last fallback in its high bits, and the number of fallbacks in a
+ * row, each within LIBTLE_HTM_PRESSURE_DECAY cycles of the previous one, in
+ * its low 4 bits (the level). Before each attempt, a thread waits for a
+ * random delay of up to LIBTLE_HTM_PRESSURE_DELAY << level pauses, to break
+ * the lockstep; from LIBTLE_HTM_PRESSURE_THRESHOLD on, it goes straight to
+ * the fallback lock. The acquisitions that skip elision do not count as
+ * fallbacks, so the pressure decays LIBTLE_HTM_PRESSURE_DECAY cycles after
+ * the storm. A time ahead of the counter of the reader (read on another
+ * CPU) counts as recent.
+ *
+ * The word shares the cache line of the lock, which the transactions read,
+ * so it is written as rarely as possible: a thread that falls back updates
+ * it with the lock held, and the first thread that sees it decayed, before
+ * an attempt or a fallback, clears it with a compare-and-swap (which aborts
+ * the transactions in flight once per storm). While the word is 0, reading
+ * it costs no more than the load of the lock the waiters already do. Note
+ * that the counter of libtle_cycles() is slower on AArch64, which makes
+ * LIBTLE_HTM_PRESSURE_DECAY longer there.
+ */
+typedef struct {
+    atomic_ullong word;
+} libtle_htm_pressure_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_PRESSURE_INIT  { ATOMIC_VAR_INIT(0ull) }
+#endif
+
+
+static inline void
+libtle_htm_pressure_init(libtle_htm_pressure_t *pr)
+{
+    atomic_init(&pr->word, 0ull);
+}
+
+
+static inline int
+libtle_htm_pressure_is_recent(unsigned long long w, unsigned long long now)
+{
+    unsigned long long t = w & ~LIBTLE_HTM_PRESSURE_LEVELS;
+    return now < t || now - t <= LIBTLE_HTM_PRESSURE_DECAY;
+}
+
+
+/*
+ * Called before each elision attempt; waits for a random delay under
+ * pressure, and returns 0 when the thread should take the fallback lock
+ * instead.
+ */
+static inline int
+libtle_htm_pressure_should_elide(libtle_htm_pressure_t *pr)
+{
+    unsigned long long w = atomic_load_explicit(&pr->word, memory_order_relaxed);
+    unsigned long long now, level, delay;
+    if (__builtin_expect(w == 0, 1)) {
+        return 1;
+    }
+    now = libtle_cycles();
+    if (!libtle_htm_pressure_is_recent(w, now)) {
+        /* the storm is over, back to speculation (and to a single load) */
+        (void) atomic_compare_exchange_strong_explicit(&pr->word, &w, 0ull,
+            memory_order_relaxed, memory_order_relaxed);
+        return 1;
+    }
+    level = w & LIBTLE_HTM_PRESSURE_LEVELS;
+    if (level >= LIBTLE_HTM_PRESSURE_THRESHOLD) {
+        return 0;
+    }
+    /* the low bits of the counter differ enough between the waiters */
+    delay = ((now * 0x9e3779b97f4a7c15ull) >> 32) %
+        ((unsigned long long) LIBTLE_HTM_PRESSURE_DELAY << level);
+    while (delay--) {
+        libtle_lock_pause();
+    }
+    return 1;
+}
+
+
+/*
+ * Called with the fallback lock held; %failed is true when elision was
+ * attempted and failed, and false when it was skipped (or not supported)
+ */
+static inline void
+libtle_htm_pressure_update_fallback(libtle_htm_pressure_t *pr, int failed)
+{
+    unsigned long long w = atomic_load_explicit(&pr->word, memory_order_relaxed);
+    unsigned long long now, level = 1;
+    if (!failed && !w) {
+        return;
+    }
+    now = libtle_cycles();
+    if (!failed) {
+        if (!libtle_htm_pressure_is_recent(w, now)) {
+            atomic_store_explicit(&pr->word, 0ull, memory_order_relaxed);
+        }
+        return;
+    }
+    if (w && libtle_htm_pressure_is_recent(w, now)) {
+        level = w & LIBTLE_HTM_PRESSURE_LEVELS;
+        level += level < LIBTLE_HTM_PRESSURE_LEVELS;
+    }
+    /* never 0 */
+    atomic_store_explicit(&pr->word, (now & ~LIBTLE_HTM_PRESSURE_LEVELS) | level,
+                          memory_order_relaxed);
+}
+
+
 /* -------------------------------------------------------------------------- */
 /* Null mutex (no locking)                                                    */
 /* -------------------------------------------------------------------------- */
@@ -120,6 +656,27 @@ libtle_null_mutex_lock(libtle_null_mutex_t *mtx,
 }
 
 
+static inline int
+libtle_null_mutex_try_lock(libtle_null_mutex_t *mtx,
+                           libtle_null_mutex_handle_t *st,
+                           libtle_null_mutex_profile_t *p)
+{
+    libtle_null_mutex_lock(mtx, st, p);
+    return 1;
+}
+
+
+static inline int
+libtle_null_mutex_try_lock_until(libtle_null_mutex_t *mtx,
+                                 libtle_null_mutex_handle_t *st,
+                                 libtle_null_mutex_profile_t *p,
+                                 uint64_t deadline)
+{
+    libtle_null_mutex_lock(mtx, st, p);
+    return 1;
+}
+
+
 static inline void
 libtle_null_mutex_unlock(libtle_null_mutex_t *mtx,
                          libtle_null_mutex_handle_t *st,
@@ -186,6 +743,29 @@ libtle_spin_mutex_lock(libtle_spin_mutex_t *mtx,
 }
 
 
+static inline int
+libtle_spin_mutex_try_lock(libtle_spin_mutex_t *mtx,
+                           libtle_spin_mutex_handle_t *st,
+                           libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_spinlock_try_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_spin_mutex_try_lock_until,
+                                   libtle_spin_mutex_try_lock,
+                                   libtle_spin_mutex_t,
+                                   libtle_spin_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
 static inline void
 libtle_spin_mutex_unlock(libtle_spin_mutex_t *mtx,
                          libtle_spin_mutex_handle_t *st,
@@ -208,12 +788,19 @@ libtle_spin_mutex_unlock(libtle_spin_mutex_t *mtx,
 
 typedef struct {
     alignas(64) libtle_spinlock_t state;
+#ifdef LIBTLE_HTM_PRESSURE
+    libtle_htm_pressure_t pressure;
+#endif
 } libtle_htm_spin_mutex_t;
 
 
 #ifndef __cplusplus
+#ifdef LIBTLE_HTM_PRESSURE
+#define LIBTLE_HTM_SPIN_MUTEX_INIT  { LIBTLE_SPINLOCK_INIT, LIBTLE_HTM_PRESSURE_INIT }
+#else
 #define LIBTLE_HTM_SPIN_MUTEX_INIT  { LIBTLE_SPINLOCK_INIT }
 #endif
+#endif
 
 
 typedef struct {
@@ -236,41 +823,84 @@ static inline void
 libtle_htm_spin_mutex_init(libtle_htm_spin_mutex_t *mtx)
 {
     libtle_spinlock_init(&mtx->state);
+#ifdef LIBTLE_HTM_PRESSURE
+    libtle_htm_pressure_init(&mtx->pressure);
+#endif
+}
+
+
+static inline int
+libtle_htm_spin_mutex_should_elide(libtle_htm_spin_mutex_t *mtx)
+{
+#ifdef LIBTLE_HTM_PRESSURE
+    return libtle_htm_pressure_should_elide(&mtx->pressure);
+#else
+    return 1;
+#endif
 }
 
 
 static inline void
-libtle_htm_spin_mutex_lock(libtle_htm_spin_mutex_t *mtx,
-                           libtle_htm_spin_mutex_handle_t *st,
-                           libtle_htm_mutex_profile_t *p)
+libtle_htm_spin_mutex_update_fallback(libtle_htm_spin_mutex_t *mtx, int failed)
+{
+#ifdef LIBTLE_HTM_PRESSURE
+    libtle_htm_pressure_update_fallback(&mtx->pressure, failed);
+#else
+    (void) mtx;
+    (void) failed;
+#endif
+}
+
+
+/*
+ * Lock for the critical section identified by %site, or for any critical
+ * section when %site is NULL.
+ */
+static inline void
+libtle_htm_spin_mutex_lock_site(libtle_htm_spin_mutex_t *mtx,
+                                libtle_htm_spin_mutex_handle_t *st,
+                                libtle_htm_mutex_profile_t *p,
+                                libtle_htm_site_t *site)
 {
     int num_retries = 0;
     unsigned xstatus;
     assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
-    do {
-        libtle_spinlock_unlock_wait(&mtx->state);
-        xstatus = _xbegin();
-        if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
-            // add the lock to our read-set
-            if (libtle_spinlock_is_locked(&mtx->state)) {
-                _xabort(LIBTLE_LOCK_IS_LOCKED);
-                __builtin_unreachable();
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->state);
+            if (!libtle_htm_spin_mutex_should_elide(mtx)) {
+                // a fallback storm; queue up for the lock
+                break;
             }
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                // add the lock to our read-set
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
 #ifndef NDEBUG
-            st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
 #endif
-            return;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
         }
-        ++num_retries;
-        if (p) {
-            libtle_htm_mutex_profile_update_abort(p, xstatus);
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+        if (num_retries) {
+            libtle_htm_site_update_fallback(site);
         }
     }
-    while (_XBEGIN_RESTART(xstatus) &&
-           num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
 
     // we failed too many times; grab the lock!
     libtle_spinlock_lock(&mtx->state);
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_htm_spin_mutex_update_fallback(mtx, num_retries != 0);
 #ifndef NDEBUG
     st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
 #endif
@@ -278,16 +908,100 @@ libtle_htm_spin_mutex_lock(libtle_htm_spin_mutex_t *mtx,
 
 
 static inline void
-libtle_htm_spin_mutex_unlock(libtle_htm_spin_mutex_t *mtx,
-                             libtle_htm_spin_mutex_handle_t *st,
-                             libtle_htm_mutex_profile_t *p)
+libtle_htm_spin_mutex_lock(libtle_htm_spin_mutex_t *mtx,
+                           libtle_htm_spin_mutex_handle_t *st,
+                           libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_mutex_lock_site(mtx, st, p, NULL);
+}
+
+
+/*
+ * Same as libtle_htm_spin_mutex_lock_site(), but returns 0 instead of waiting
+ * for a busy lock: the transactions only start while the lock looks free,
+ * and the fallback is a single attempt to take the lock. Returns 1 when the
+ * critical section is elided or locked.
+ */
+static inline int
+libtle_htm_spin_mutex_try_lock_site(libtle_htm_spin_mutex_t *mtx,
+                                    libtle_htm_spin_mutex_handle_t *st,
+                                    libtle_htm_mutex_profile_t *p,
+                                    libtle_htm_site_t *site)
 {
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
 #ifndef NDEBUG
-    switch (st->status) {
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_spinlock_try_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_fallback, mtx);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_htm_spin_mutex_try_lock(libtle_htm_spin_mutex_t *mtx,
+                               libtle_htm_spin_mutex_handle_t *st,
+                               libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_spin_mutex_try_lock_site(mtx, st, p, NULL);
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_spin_mutex_try_lock_until,
+                                   libtle_htm_spin_mutex_try_lock,
+                                   libtle_htm_spin_mutex_t,
+                                   libtle_htm_spin_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_spin_mutex_unlock_site(libtle_htm_spin_mutex_t *mtx,
+                                  libtle_htm_spin_mutex_handle_t *st,
+                                  libtle_htm_mutex_profile_t *p,
+                                  libtle_htm_site_t *site)
+{
+#ifndef NDEBUG
+    switch (st->status) {
     case LIBTLE_MUTEX_STATUS_ELIDED:
         _xend();
-        if (p && !_xtest()) {
-            libtle_htm_mutex_profile_update_commit(p);
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
         }
         break;
     case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
@@ -307,12 +1021,153 @@ libtle_htm_spin_mutex_unlock(libtle_htm_spin_mutex_t *mtx,
             libtle_htm_mutex_profile_update_unlock(p);
         }
     } else {
+        _xend();
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
+        }
+    }
+#endif
+}
+
+
+static inline void
+libtle_htm_spin_mutex_unlock(libtle_htm_spin_mutex_t *mtx,
+                             libtle_htm_spin_mutex_handle_t *st,
+                             libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_mutex_unlock_site(mtx, st, p, NULL);
+}
+
+
+/*
+ * Lock the %n distinct mutexes mtx[0..n-1], through the handles st[0..n-1],
+ * as one critical section: a single transaction subscribes to all the locks,
+ * instead of nesting one elision per mutex, so an abort restarts the whole
+ * critical section once. When elision fails, the locks are taken in address
+ * order, so that concurrent callers with overlapping sets cannot deadlock.
+ * The statistics of the group go to %p. With LIBTLE_HTM_PRESSURE, the group
+ * skips elision while any of the mutexes is under pressure, and its
+ * fallbacks count towards the pressure of each mutex.
+ */
+static inline void
+libtle_htm_spin_mutex_lock_all(libtle_htm_spin_mutex_t *const *mtx,
+                               libtle_htm_spin_mutex_handle_t *const *st,
+                               unsigned n,
+                               libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    unsigned i;
+    uintptr_t last = 0;
+    for (i = 0; i < n; ++i) {
+        assert(st[i]->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    }
+    if (libtle_htm_supported()) {
+        do {
+            for (i = 0; i < n; ++i) {
+                libtle_spinlock_unlock_wait(&mtx[i]->state);
+            }
+            for (i = 0; i < n; ++i) {
+                if (!libtle_htm_spin_mutex_should_elide(mtx[i])) {
+                    break;
+                }
+            }
+            if (i < n) {
+                /* a fallback storm; queue up for the locks */
+                break;
+            }
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add all the locks to our read-set */
+                for (i = 0; i < n; ++i) {
+                    if (libtle_spinlock_is_locked(&mtx[i]->state)) {
+                        _xabort(LIBTLE_LOCK_IS_LOCKED);
+                        __builtin_unreachable();
+                    }
+                }
+#ifndef NDEBUG
+                for (i = 0; i < n; ++i) {
+                    st[i]->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                }
+#endif
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx[0], xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+    }
+
+    /*
+     * grab the locks, lowest address first; there are only a few of them.
+     * The addresses are compared as integers, since the mutexes are distinct
+     * objects.
+     */
+    for (;;) {
+        libtle_htm_spin_mutex_t *next = NULL;
+        for (i = 0; i < n; ++i) {
+            uintptr_t a = (uintptr_t) mtx[i];
+            if (a > last && (!next || a < (uintptr_t) next)) {
+                next = mtx[i];
+            }
+        }
+        if (!next) {
+            break;
+        }
+        libtle_spinlock_lock(&next->state);
+        LIBTLE_PROBE1(htm_fallback, next);
+        libtle_htm_spin_mutex_update_fallback(next, num_retries != 0);
+        last = (uintptr_t) next;
+    }
+#ifndef NDEBUG
+    for (i = 0; i < n; ++i) {
+        st[i]->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    }
+#endif
+}
+
+
+/*
+ * Release the mutexes locked by libtle_htm_spin_mutex_lock_all()
+ */
+static inline void
+libtle_htm_spin_mutex_unlock_all(libtle_htm_spin_mutex_t *const *mtx,
+                                 libtle_htm_spin_mutex_handle_t *const *st,
+                                 unsigned n,
+                                 libtle_htm_mutex_profile_t *p)
+{
+    unsigned i;
+    /* either all the locks are elided, or all are held */
+#ifndef NDEBUG
+    int elided = n && st[0]->status == LIBTLE_MUTEX_STATUS_ELIDED;
+    for (i = 0; i < n; ++i) {
+        assert(st[i]->status == (elided ? LIBTLE_MUTEX_STATUS_ELIDED
+                                        : LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE));
+        st[i]->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+    }
+#else
+    int elided = n && !libtle_spinlock_is_locked(&mtx[0]->state);
+#endif
+    if (elided) {
         _xend();
         if (p && !_xtest()) {
             libtle_htm_mutex_profile_update_commit(p);
         }
+    } else if (n) {
+        for (i = 0; i < n; ++i) {
+            libtle_spinlock_unlock(&mtx[i]->state);
+        }
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
     }
-#endif
 }
 
 
@@ -375,6 +1230,48 @@ libtle_null_shared_mutex_lock_shared(libtle_null_shared_mutex_t *mtx,
 }
 
 
+static inline int
+libtle_null_shared_mutex_try_lock(libtle_null_shared_mutex_t *mtx,
+                                  libtle_null_shared_mutex_handle_t *st,
+                                  libtle_null_mutex_profile_t *p)
+{
+    libtle_null_shared_mutex_lock(mtx, st, p);
+    return 1;
+}
+
+
+static inline int
+libtle_null_shared_mutex_try_lock_shared(libtle_null_shared_mutex_t *mtx,
+                                         libtle_null_shared_mutex_handle_t *st,
+                                         libtle_null_mutex_profile_t *p)
+{
+    libtle_null_shared_mutex_lock_shared(mtx, st, p);
+    return 1;
+}
+
+
+static inline int
+libtle_null_shared_mutex_try_lock_until(libtle_null_shared_mutex_t *mtx,
+                                        libtle_null_shared_mutex_handle_t *st,
+                                        libtle_null_mutex_profile_t *p,
+                                        uint64_t deadline)
+{
+    libtle_null_shared_mutex_lock(mtx, st, p);
+    return 1;
+}
+
+
+static inline int
+libtle_null_shared_mutex_try_lock_shared_until(libtle_null_shared_mutex_t *mtx,
+                                               libtle_null_shared_mutex_handle_t *st,
+                                               libtle_null_mutex_profile_t *p,
+                                               uint64_t deadline)
+{
+    libtle_null_shared_mutex_lock_shared(mtx, st, p);
+    return 1;
+}
+
+
 static inline void
 libtle_null_shared_mutex_unlock(libtle_null_shared_mutex_t *mtx,
                                 libtle_null_shared_mutex_handle_t *st,
@@ -469,6 +1366,52 @@ libtle_spin_shared_mutex_lock_shared(libtle_spin_shared_mutex_t *mtx,
 }
 
 
+static inline int
+libtle_spin_shared_mutex_try_lock(libtle_spin_shared_mutex_t *mtx,
+                                  libtle_spin_shared_mutex_handle_t *st,
+                                  libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_spin_shared_mutex_try_lock_shared(libtle_spin_shared_mutex_t *mtx,
+                                         libtle_spin_shared_mutex_handle_t *st,
+                                         libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_spin_shared_mutex_try_lock_until,
+                                   libtle_spin_shared_mutex_try_lock,
+                                   libtle_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_spin_shared_mutex_try_lock_shared,
+                                   libtle_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
 static inline void
 libtle_spin_shared_mutex_unlock(libtle_spin_shared_mutex_t *mtx,
                                 libtle_spin_shared_mutex_handle_t *st,
@@ -538,84 +1481,245 @@ libtle_htm_spin_shared_mutex_init(libtle_htm_spin_shared_mutex_t *mtx)
 
 
 static inline void
-libtle_htm_spin_shared_mutex_lock(libtle_htm_spin_shared_mutex_t *mtx,
-                                  libtle_htm_spin_shared_mutex_handle_t *st,
-                                  libtle_htm_mutex_profile_t *p)
+libtle_htm_spin_shared_mutex_lock_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                       libtle_htm_spin_shared_mutex_handle_t *st,
+                                       libtle_htm_mutex_profile_t *p,
+                                       libtle_htm_site_t *site)
 {
     int num_retries = 0;
     unsigned xstatus;
     assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
-    do {
-        libtle_rwlock_unlock_wait(&mtx->state);
-        xstatus = _xbegin();
-        if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
-            /* add the lock to our read-set */
-            if (libtle_rwlock_is_locked(&mtx->state)) {
-                _xabort(LIBTLE_LOCK_IS_LOCKED);
-                __builtin_unreachable();
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_rwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
             }
-            st->status = LIBTLE_MUTEX_STATUS_ELIDED;
-            return;
-        }
-        ++num_retries;
-        if (p) {
-            libtle_htm_mutex_profile_update_abort(p, xstatus);
         }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
     }
-    while (_XBEGIN_RESTART(xstatus) &&
-           num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
 
     /* we failed too many times; grab the lock! */
     libtle_rwlock_write_lock(&mtx->state);
+    LIBTLE_PROBE1(htm_fallback, mtx);
     libtle_spinlock_lock_uncontended(&mtx->wflag);
     st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
 }
 
 
+static inline void
+libtle_htm_spin_shared_mutex_lock(libtle_htm_spin_shared_mutex_t *mtx,
+                                  libtle_htm_spin_shared_mutex_handle_t *st,
+                                  libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_shared_mutex_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_spin_shared_mutex_lock_shared_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                              libtle_htm_spin_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p,
+                                              libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_rwlock_read_lock(&mtx->state);
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
 static inline void
 libtle_htm_spin_shared_mutex_lock_shared(libtle_htm_spin_shared_mutex_t *mtx,
                                          libtle_htm_spin_shared_mutex_handle_t *st,
                                          libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_shared_mutex_lock_shared_site(mtx, st, p, NULL);
+}
+
+
+/*
+ * Same as the lock_site() and lock_shared_site() functions, but they return 0
+ * instead of waiting for a busy lock (see libtle_htm_spin_mutex_try_lock_site()).
+ */
+static inline int
+libtle_htm_spin_shared_mutex_try_lock_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                           libtle_htm_spin_shared_mutex_handle_t *st,
+                                           libtle_htm_mutex_profile_t *p,
+                                           libtle_htm_site_t *site)
 {
     int num_retries = 0;
     unsigned xstatus;
     assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
-    do {
-        libtle_spinlock_unlock_wait(&mtx->wflag);
-        xstatus = _xbegin();
-        if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
-            /* add the lock to our read-set */
-            if (libtle_spinlock_is_locked(&mtx->wflag)) {
-                _xabort(LIBTLE_LOCK_IS_LOCKED);
-                __builtin_unreachable();
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_rwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
             }
-            st->status = LIBTLE_MUTEX_STATUS_ELIDED;
-            return;
         }
-        ++num_retries;
-        if (p) {
-            libtle_htm_mutex_profile_update_abort(p, xstatus);
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_spin_shared_mutex_try_lock(libtle_htm_spin_shared_mutex_t *mtx,
+                                      libtle_htm_spin_shared_mutex_handle_t *st,
+                                      libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline int
+libtle_htm_spin_shared_mutex_try_lock_shared_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                                  libtle_htm_spin_shared_mutex_handle_t *st,
+                                                  libtle_htm_mutex_profile_t *p,
+                                                  libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
         }
     }
-    while (_XBEGIN_RESTART(xstatus) &&
-           num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
 
-    /* we failed too many times; grab the lock! */
-    libtle_rwlock_read_lock(&mtx->state);
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
     st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_spin_shared_mutex_try_lock_shared(libtle_htm_spin_shared_mutex_t *mtx,
+                                             libtle_htm_spin_shared_mutex_handle_t *st,
+                                             libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_shared_site(mtx, st, p, NULL);
 }
 
 
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_spin_shared_mutex_try_lock_until,
+                                   libtle_htm_spin_shared_mutex_try_lock,
+                                   libtle_htm_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_spin_shared_mutex_try_lock_shared,
+                                   libtle_htm_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
 static inline void
-libtle_htm_spin_shared_mutex_unlock(libtle_htm_spin_shared_mutex_t *mtx,
-                                    libtle_htm_spin_shared_mutex_handle_t *st,
-                                    libtle_htm_mutex_profile_t *p)
+libtle_htm_spin_shared_mutex_unlock_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                         libtle_htm_spin_shared_mutex_handle_t *st,
+                                         libtle_htm_mutex_profile_t *p,
+                                         libtle_htm_site_t *site)
 {
     switch (st->status) {
     case LIBTLE_MUTEX_STATUS_ELIDED:
         _xend();
-        if (p && !_xtest()) {
-            libtle_htm_mutex_profile_update_commit(p);
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
         }
         break;
     case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
@@ -633,15 +1737,28 @@ libtle_htm_spin_shared_mutex_unlock(libtle_htm_spin_shared_mutex_t *mtx,
 
 
 static inline void
-libtle_htm_spin_shared_mutex_unlock_shared(libtle_htm_spin_shared_mutex_t *mtx,
-                                           libtle_htm_spin_shared_mutex_handle_t *st,
-                                           libtle_htm_mutex_profile_t *p)
+libtle_htm_spin_shared_mutex_unlock(libtle_htm_spin_shared_mutex_t *mtx,
+                                    libtle_htm_spin_shared_mutex_handle_t *st,
+                                    libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_shared_mutex_unlock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_spin_shared_mutex_unlock_shared_site(libtle_htm_spin_shared_mutex_t *mtx,
+                                                libtle_htm_spin_shared_mutex_handle_t *st,
+                                                libtle_htm_mutex_profile_t *p,
+                                                libtle_htm_site_t *site)
 {
     switch (st->status) {
     case LIBTLE_MUTEX_STATUS_ELIDED:
         _xend();
-        if (p && !_xtest()) {
-            libtle_htm_mutex_profile_update_commit(p);
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
         }
         break;
     case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
@@ -657,327 +1774,5356 @@ libtle_htm_spin_shared_mutex_unlock_shared(libtle_htm_spin_shared_mutex_t *mtx,
 }
 
 
-/* -------------------------------------------------------------------------- */
-/* Generics                                                                   */
-/* -------------------------------------------------------------------------- */
+static inline void
+libtle_htm_spin_shared_mutex_unlock_shared(libtle_htm_spin_shared_mutex_t *mtx,
+                                           libtle_htm_spin_shared_mutex_handle_t *st,
+                                           libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_spin_shared_mutex_unlock_shared_site(mtx, st, p, NULL);
+}
 
-#ifndef __cplusplus
 
-#define libtle_mutex_handle_init(M) _Generic((M), \
-               libtle_null_mutex_handle_t*: libtle_null_mutex_handle_init, \
-               libtle_spin_mutex_handle_t*: libtle_spin_mutex_handle_init, \
-           libtle_htm_spin_mutex_handle_t*: libtle_htm_spin_mutex_handle_init, \
-        libtle_null_shared_mutex_handle_t*: libtle_null_shared_mutex_handle_init, \
-        libtle_spin_shared_mutex_handle_t*: libtle_spin_shared_mutex_handle_init, \
-    libtle_htm_spin_shared_mutex_handle_t*: libtle_htm_spin_shared_mutex_handle_init \
-)(M)
+/* -------------------------------------------------------------------------- */
+/* Reader-preferring rwlock based reader/writer mutex                         */
+/* -------------------------------------------------------------------------- */
 
 
-#define libtle_mutex_init(M) _Generic((M), \
-               libtle_null_mutex_t*: libtle_null_mutex_init, \
-               libtle_spin_mutex_t*: libtle_spin_mutex_init, \
-           libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_init, \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_init, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_init, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_init \
-)(M)
+/*
+ * Same as libtle_spin_shared_mutex_t, with a reader-preferring rwlock; the
+ * handles are libtle_spin_shared_mutex_handle_t.
+ */
+typedef struct {
+    alignas(64) libtle_rwlock_t state;
+} libtle_rp_spin_shared_mutex_t;
 
 
-#define libtle_mutex_lock(M,S) _Generic((M), \
-               libtle_null_mutex_t*: libtle_null_mutex_lock, \
-               libtle_spin_mutex_t*: libtle_spin_mutex_lock, \
-           libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock, \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock \
-)(M,S,NULL)
+#ifndef __cplusplus
+#define LIBTLE_RP_SPIN_SHARED_MUTEX_INIT  { LIBTLE_RWLOCK_INIT }
+#endif
 
 
-#define libtle_mutex_lock_profiled(M,S,P) _Generic((M), \
-               libtle_null_mutex_t*: libtle_null_mutex_lock, \
-               libtle_spin_mutex_t*: libtle_spin_mutex_lock, \
-           libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock, \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock \
-)(M,S,P)
+static inline void
+libtle_rp_spin_shared_mutex_init(libtle_rp_spin_shared_mutex_t *mtx)
+{
+    libtle_rwlock_init(&mtx->state);
+}
 
 
-#define libtle_mutex_lock_shared(M,S) _Generic((M), \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock_shared, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock_shared, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared \
-)(M,S,NULL)
+static inline void
+libtle_rp_spin_shared_mutex_lock(libtle_rp_spin_shared_mutex_t *mtx,
+                                 libtle_spin_shared_mutex_handle_t *st,
+                                 libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_rwlock_write_lock_rpref(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
 
 
-#define libtle_mutex_lock_shared_profiled(M,S,P) _Generic((M), \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock_shared, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock_shared, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared \
-)(M,S,P)
+static inline void
+libtle_rp_spin_shared_mutex_lock_shared(libtle_rp_spin_shared_mutex_t *mtx,
+                                        libtle_spin_shared_mutex_handle_t *st,
+                                        libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_rwlock_read_lock_rpref(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+}
+
+
+static inline int
+libtle_rp_spin_shared_mutex_try_lock(libtle_rp_spin_shared_mutex_t *mtx,
+                                     libtle_spin_shared_mutex_handle_t *st,
+                                     libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_rp_spin_shared_mutex_try_lock_shared(libtle_rp_spin_shared_mutex_t *mtx,
+                                            libtle_spin_shared_mutex_handle_t *st,
+                                            libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_rp_spin_shared_mutex_try_lock_until,
+                                   libtle_rp_spin_shared_mutex_try_lock,
+                                   libtle_rp_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_rp_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_rp_spin_shared_mutex_try_lock_shared,
+                                   libtle_rp_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+static inline void
+libtle_rp_spin_shared_mutex_unlock(libtle_rp_spin_shared_mutex_t *mtx,
+                                   libtle_spin_shared_mutex_handle_t *st,
+                                   libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE);
+    libtle_rwlock_write_unlock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+static inline void
+libtle_rp_spin_shared_mutex_unlock_shared(libtle_rp_spin_shared_mutex_t *mtx,
+                                          libtle_spin_shared_mutex_handle_t *st,
+                                          libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_SHARED);
+    libtle_rwlock_read_unlock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based reader/writer mutex with reader-preferring rwlock fallback       */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * Same as libtle_htm_spin_shared_mutex_t, with a reader-preferring rwlock as
+ * fallback; the handles are libtle_htm_spin_shared_mutex_handle_t.
+ */
+typedef struct {
+    alignas(64) libtle_rwlock_t     state;
+    alignas(64) libtle_spinlock_t   wflag;
+} libtle_htm_rp_spin_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_RP_SPIN_SHARED_MUTEX_INIT  { LIBTLE_RWLOCK_INIT, LIBTLE_SPINLOCK_INIT }
+#endif
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_init(libtle_htm_rp_spin_shared_mutex_t *mtx)
+{
+    libtle_rwlock_init(&mtx->state);
+    libtle_spinlock_init(&mtx->wflag);
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_lock_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                          libtle_htm_spin_shared_mutex_handle_t *st,
+                                          libtle_htm_mutex_profile_t *p,
+                                          libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_rwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_rwlock_write_lock_rpref(&mtx->state);
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_lock(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                     libtle_htm_spin_shared_mutex_handle_t *st,
+                                     libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_rp_spin_shared_mutex_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_lock_shared_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                                 libtle_htm_spin_shared_mutex_handle_t *st,
+                                                 libtle_htm_mutex_profile_t *p,
+                                                 libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_rwlock_read_lock_rpref(&mtx->state);
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_lock_shared(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                            libtle_htm_spin_shared_mutex_handle_t *st,
+                                            libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_rp_spin_shared_mutex_lock_shared_site(mtx, st, p, NULL);
+}
+
+
+/*
+ * Same as the lock_site() and lock_shared_site() functions, but they return 0
+ * instead of waiting for a busy lock (see libtle_htm_spin_mutex_try_lock_site()).
+ */
+static inline int
+libtle_htm_rp_spin_shared_mutex_try_lock_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                              libtle_htm_spin_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p,
+                                              libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_rwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_rp_spin_shared_mutex_try_lock(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                         libtle_htm_spin_shared_mutex_handle_t *st,
+                                         libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline int
+libtle_htm_rp_spin_shared_mutex_try_lock_shared_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                                     libtle_htm_spin_shared_mutex_handle_t *st,
+                                                     libtle_htm_mutex_profile_t *p,
+                                                     libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_rp_spin_shared_mutex_try_lock_shared(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                                libtle_htm_spin_shared_mutex_handle_t *st,
+                                                libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_shared_site(mtx, st, p, NULL);
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_rp_spin_shared_mutex_try_lock_until,
+                                   libtle_htm_rp_spin_shared_mutex_try_lock,
+                                   libtle_htm_rp_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_rp_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_rp_spin_shared_mutex_try_lock_shared,
+                                   libtle_htm_rp_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_unlock_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                            libtle_htm_spin_shared_mutex_handle_t *st,
+                                            libtle_htm_mutex_profile_t *p,
+                                            libtle_htm_site_t *site)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_spinlock_unlock(&mtx->wflag);
+        libtle_rwlock_write_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_unlock(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                       libtle_htm_spin_shared_mutex_handle_t *st,
+                                       libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_rp_spin_shared_mutex_unlock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_unlock_shared_site(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                                   libtle_htm_spin_shared_mutex_handle_t *st,
+                                                   libtle_htm_mutex_profile_t *p,
+                                                   libtle_htm_site_t *site)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_rwlock_read_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_rp_spin_shared_mutex_unlock_shared(libtle_htm_rp_spin_shared_mutex_t *mtx,
+                                              libtle_htm_spin_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_rp_spin_shared_mutex_unlock_shared_site(mtx, st, p, NULL);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Phase-fair rwlock based reader/writer mutex                                */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * Same as libtle_spin_shared_mutex_t, with a phase-fair rwlock; the
+ * handles are libtle_spin_shared_mutex_handle_t.
+ */
+typedef struct {
+    alignas(64) libtle_pfrwlock_t state;
+} libtle_pf_spin_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_PF_SPIN_SHARED_MUTEX_INIT  { LIBTLE_PFRWLOCK_INIT }
+#endif
+
+
+static inline void
+libtle_pf_spin_shared_mutex_init(libtle_pf_spin_shared_mutex_t *mtx)
+{
+    libtle_pfrwlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_pf_spin_shared_mutex_lock(libtle_pf_spin_shared_mutex_t *mtx,
+                                 libtle_spin_shared_mutex_handle_t *st,
+                                 libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_pfrwlock_write_lock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline void
+libtle_pf_spin_shared_mutex_lock_shared(libtle_pf_spin_shared_mutex_t *mtx,
+                                        libtle_spin_shared_mutex_handle_t *st,
+                                        libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_pfrwlock_read_lock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+}
+
+
+static inline int
+libtle_pf_spin_shared_mutex_try_lock(libtle_pf_spin_shared_mutex_t *mtx,
+                                     libtle_spin_shared_mutex_handle_t *st,
+                                     libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_pfrwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_pf_spin_shared_mutex_try_lock_shared(libtle_pf_spin_shared_mutex_t *mtx,
+                                            libtle_spin_shared_mutex_handle_t *st,
+                                            libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_pfrwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_pf_spin_shared_mutex_try_lock_until,
+                                   libtle_pf_spin_shared_mutex_try_lock,
+                                   libtle_pf_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_pf_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_pf_spin_shared_mutex_try_lock_shared,
+                                   libtle_pf_spin_shared_mutex_t,
+                                   libtle_spin_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+static inline void
+libtle_pf_spin_shared_mutex_unlock(libtle_pf_spin_shared_mutex_t *mtx,
+                                   libtle_spin_shared_mutex_handle_t *st,
+                                   libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE);
+    libtle_pfrwlock_write_unlock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+static inline void
+libtle_pf_spin_shared_mutex_unlock_shared(libtle_pf_spin_shared_mutex_t *mtx,
+                                          libtle_spin_shared_mutex_handle_t *st,
+                                          libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_SHARED);
+    libtle_pfrwlock_read_unlock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based reader/writer mutex with phase-fair rwlock as fallback           */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * Same as libtle_htm_spin_shared_mutex_t, with a phase-fair rwlock as
+ * fallback; the handles are libtle_htm_spin_shared_mutex_handle_t.
+ */
+typedef struct {
+    alignas(64) libtle_pfrwlock_t   state;
+    alignas(64) libtle_spinlock_t   wflag;
+} libtle_htm_pf_spin_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_PF_SPIN_SHARED_MUTEX_INIT  { LIBTLE_PFRWLOCK_INIT, LIBTLE_SPINLOCK_INIT }
+#endif
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_init(libtle_htm_pf_spin_shared_mutex_t *mtx)
+{
+    libtle_pfrwlock_init(&mtx->state);
+    libtle_spinlock_init(&mtx->wflag);
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_lock_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                          libtle_htm_spin_shared_mutex_handle_t *st,
+                                          libtle_htm_mutex_profile_t *p,
+                                          libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_pfrwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_pfrwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_pfrwlock_write_lock(&mtx->state);
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_lock(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                     libtle_htm_spin_shared_mutex_handle_t *st,
+                                     libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_pf_spin_shared_mutex_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_lock_shared_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                                 libtle_htm_spin_shared_mutex_handle_t *st,
+                                                 libtle_htm_mutex_profile_t *p,
+                                                 libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+        libtle_htm_site_update_fallback(site);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_pfrwlock_read_lock(&mtx->state);
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_lock_shared(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                            libtle_htm_spin_shared_mutex_handle_t *st,
+                                            libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_pf_spin_shared_mutex_lock_shared_site(mtx, st, p, NULL);
+}
+
+
+/*
+ * Same as the lock_site() and lock_shared_site() functions, but they return 0
+ * instead of waiting for a busy lock (see libtle_htm_spin_mutex_try_lock_site()).
+ */
+static inline int
+libtle_htm_pf_spin_shared_mutex_try_lock_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                              libtle_htm_spin_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p,
+                                              libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_pfrwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_pfrwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_pfrwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_fallback, mtx);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_pf_spin_shared_mutex_try_lock(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                         libtle_htm_spin_shared_mutex_handle_t *st,
+                                         libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_site(mtx, st, p, NULL);
+}
+
+
+static inline int
+libtle_htm_pf_spin_shared_mutex_try_lock_shared_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                                     libtle_htm_spin_shared_mutex_handle_t *st,
+                                                     libtle_htm_mutex_profile_t *p,
+                                                     libtle_htm_site_t *site)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_site_should_elide(site)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            LIBTLE_PROBE2(htm_read_abort, mtx, xstatus);
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                libtle_htm_site_update_fallback(site);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_pfrwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    LIBTLE_PROBE1(htm_read_fallback, mtx);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_pf_spin_shared_mutex_try_lock_shared(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                                libtle_htm_spin_shared_mutex_handle_t *st,
+                                                libtle_htm_mutex_profile_t *p)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_shared_site(mtx, st, p, NULL);
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_pf_spin_shared_mutex_try_lock_until,
+                                   libtle_htm_pf_spin_shared_mutex_try_lock,
+                                   libtle_htm_pf_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_pf_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_pf_spin_shared_mutex_try_lock_shared,
+                                   libtle_htm_pf_spin_shared_mutex_t,
+                                   libtle_htm_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_unlock_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                            libtle_htm_spin_shared_mutex_handle_t *st,
+                                            libtle_htm_mutex_profile_t *p,
+                                            libtle_htm_site_t *site)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_spinlock_unlock(&mtx->wflag);
+        libtle_pfrwlock_write_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_unlock(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                       libtle_htm_spin_shared_mutex_handle_t *st,
+                                       libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_pf_spin_shared_mutex_unlock_site(mtx, st, p, NULL);
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_unlock_shared_site(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                                   libtle_htm_spin_shared_mutex_handle_t *st,
+                                                   libtle_htm_mutex_profile_t *p,
+                                                   libtle_htm_site_t *site)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if ((p || site) && !_xtest()) {
+            libtle_htm_site_update_commit(site);
+            if (p) {
+                libtle_htm_mutex_profile_update_commit(p);
+            }
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_pfrwlock_read_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_pf_spin_shared_mutex_unlock_shared(libtle_htm_pf_spin_shared_mutex_t *mtx,
+                                              libtle_htm_spin_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p)
+{
+    libtle_htm_pf_spin_shared_mutex_unlock_shared_site(mtx, st, p, NULL);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Adaptive elision policy                                                    */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Per-handle elision state learned from the recent abort statuses.
+ *
+ * %budget is the number of transactions attempted before falling back to the
+ * lock. It grows when commits need most of the budget, and shrinks when the
+ * budget is exhausted by retryable aborts.
+ *
+ * %hard is a moving average (x256) of the acquisitions that fell back due to
+ * capacity or other non-retryable aborts. When those dominate, elision is
+ * skipped for %penalty acquisitions, after which one acquisition probes the
+ * transactional path again. %probe marks that acquisition. Each failed probe
+ * doubles the penalty. A probe that commits resets both the penalty and
+ * %hard, so a single hard abort right after a cool-off does not skip elision
+ * again; other commits only decay %hard.
+ *
+ * The state is only written by the thread owning the handle, so learning does
+ * not add any shared cache line writes.
+ */
+typedef struct {
+    unsigned budget;
+    unsigned skip;
+    unsigned penalty;
+    unsigned hard;
+    unsigned probe;
+} libtle_htm_adaptive_t;
+
+
+static inline void
+libtle_htm_adaptive_init(libtle_htm_adaptive_t *a)
+{
+    a->budget = LIBTLE_HTM_ADAPTIVE_RETRY_LIMIT;
+    a->skip = 0;
+    a->penalty = LIBTLE_HTM_ADAPTIVE_SKIP_MIN;
+    a->hard = 0;
+    a->probe = 0;
+}
+
+
+static inline int
+libtle_htm_adaptive_should_elide(libtle_htm_adaptive_t *a)
+{
+    if (__builtin_expect(a->skip == 0, 1)) {
+        return 1;
+    }
+    if (--a->skip == 0) {
+        /* the next acquisition probes the transactional path */
+        a->probe = 1;
+    }
+    return 0;
+}
+
+
+/*
+ * Called from within the transaction, so the update only becomes visible if
+ * the transaction actually commits.
+ */
+static inline void
+libtle_htm_adaptive_update_commit(libtle_htm_adaptive_t *a,
+                                  unsigned num_retries)
+{
+    if (a->probe) {
+        /* a probe after a cool-off committed */
+        a->probe = 0;
+        a->hard = 0;
+        a->penalty = LIBTLE_HTM_ADAPTIVE_SKIP_MIN;
+    } else {
+        a->hard -= a->hard >> 3;
+    }
+    if (num_retries + 1 >= a->budget &&
+        a->budget < LIBTLE_HTM_ADAPTIVE_RETRY_LIMIT) {
+        a->budget += 1;
+    }
+}
+
+
+static inline void
+libtle_htm_adaptive_update_fallback(libtle_htm_adaptive_t *a,
+                                    unsigned xstatus)
+{
+    if (_XABORT_NO_RETRY(xstatus)) {
+        /* the critical section asked for the lock; elision did not fail */
+        return;
+    }
+    a->probe = 0;
+    a->hard -= a->hard >> 3;
+    if (!_XABORT_HARD(xstatus)) {
+        /* the budget was exhausted by conflicts */
+        if (a->budget > 1) {
+            a->budget >>= 1;
+        }
+        return;
+    }
+    a->hard += 32;
+    if (a->hard >= 128) {
+        /* hard aborts dominate; cool off before probing again */
+        a->skip = a->penalty;
+        if (a->penalty < LIBTLE_HTM_ADAPTIVE_SKIP_MAX) {
+            a->penalty <<= 1;
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Adaptive HTM-based mutex with a spinlock as fallback                       */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_spinlock_t state;
+} libtle_htm_adaptive_spin_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_ADAPTIVE_SPIN_MUTEX_INIT  { LIBTLE_SPINLOCK_INIT }
+#endif
+
+
+typedef struct {
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+    libtle_htm_adaptive_t adapt;
+} libtle_htm_adaptive_spin_mutex_handle_t;
+
+
+static inline void
+libtle_htm_adaptive_spin_mutex_handle_init(libtle_htm_adaptive_spin_mutex_handle_t *st)
+{
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+    libtle_htm_adaptive_init(&st->adapt);
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_mutex_init(libtle_htm_adaptive_spin_mutex_t *mtx)
+{
+    libtle_spinlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_mutex_lock(libtle_htm_adaptive_spin_mutex_t *mtx,
+                                    libtle_htm_adaptive_spin_mutex_handle_t *st,
+                                    libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->adapt)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->adapt, num_retries);
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) && num_retries < st->adapt.budget);
+        libtle_htm_adaptive_update_fallback(&st->adapt, xstatus);
+    }
+
+    /* we failed too many times, or elision does not pay off; grab the lock! */
+    libtle_spinlock_lock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_htm_adaptive_spin_mutex_try_lock(libtle_htm_adaptive_spin_mutex_t *mtx,
+                                        libtle_htm_adaptive_spin_mutex_handle_t *st,
+                                        libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->adapt)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->adapt, num_retries);
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= st->adapt.budget) {
+                libtle_htm_adaptive_update_fallback(&st->adapt, xstatus);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_spinlock_try_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_adaptive_spin_mutex_try_lock_until,
+                                   libtle_htm_adaptive_spin_mutex_try_lock,
+                                   libtle_htm_adaptive_spin_mutex_t,
+                                   libtle_htm_adaptive_spin_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_adaptive_spin_mutex_unlock(libtle_htm_adaptive_spin_mutex_t *mtx,
+                                      libtle_htm_adaptive_spin_mutex_handle_t *st,
+                                      libtle_htm_mutex_profile_t *p)
+{
+#ifndef NDEBUG
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_spinlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#else
+    if (libtle_spinlock_is_locked(&mtx->state)) {
+        libtle_spinlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+    } else {
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+    }
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Adaptive HTM-based reader/writer mutex with rwlock as fallback             */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_rwlock_t     state;
+    alignas(64) libtle_spinlock_t   wflag;
+} libtle_htm_adaptive_spin_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_ADAPTIVE_SPIN_SHARED_MUTEX_INIT  { LIBTLE_RWLOCK_INIT, LIBTLE_SPINLOCK_INIT }
+#endif
+
+
+/*
+ * Readers and writers usually have very different footprints, so they learn
+ * their elision state separately.
+ */
+typedef struct {
+    enum libtle_mutex_status_t status;
+    libtle_htm_adaptive_t write;
+    libtle_htm_adaptive_t read;
+} libtle_htm_adaptive_spin_shared_mutex_handle_t;
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_handle_init(libtle_htm_adaptive_spin_shared_mutex_handle_t *st)
+{
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+    libtle_htm_adaptive_init(&st->write);
+    libtle_htm_adaptive_init(&st->read);
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_init(libtle_htm_adaptive_spin_shared_mutex_t *mtx)
+{
+    libtle_rwlock_init(&mtx->state);
+    libtle_spinlock_init(&mtx->wflag);
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_lock(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                           libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                           libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->write)) {
+        do {
+            libtle_rwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->write, num_retries);
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) && num_retries < st->write.budget);
+        libtle_htm_adaptive_update_fallback(&st->write, xstatus);
+    }
+
+    /* we failed too many times, or elision does not pay off; grab the lock! */
+    libtle_rwlock_write_lock(&mtx->state);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_lock_shared(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                                  libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                                  libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->read)) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->read, num_retries);
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) && num_retries < st->read.budget);
+        libtle_htm_adaptive_update_fallback(&st->read, xstatus);
+    }
+
+    /* we failed too many times, or elision does not pay off; grab the lock! */
+    libtle_rwlock_read_lock(&mtx->state);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline int
+libtle_htm_adaptive_spin_shared_mutex_try_lock(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                               libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                               libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->write)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_rwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->write, num_retries);
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= st->write.budget) {
+                libtle_htm_adaptive_update_fallback(&st->write, xstatus);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_adaptive_spin_shared_mutex_try_lock_shared(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                                      libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                                      libtle_htm_mutex_profile_t *p)
+{
+    unsigned num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported() && libtle_htm_adaptive_should_elide(&st->read)) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                libtle_htm_adaptive_update_commit(&st->read, num_retries);
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= st->read.budget) {
+                libtle_htm_adaptive_update_fallback(&st->read, xstatus);
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_adaptive_spin_shared_mutex_try_lock_until,
+                                   libtle_htm_adaptive_spin_shared_mutex_try_lock,
+                                   libtle_htm_adaptive_spin_shared_mutex_t,
+                                   libtle_htm_adaptive_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_adaptive_spin_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_adaptive_spin_shared_mutex_try_lock_shared,
+                                   libtle_htm_adaptive_spin_shared_mutex_t,
+                                   libtle_htm_adaptive_spin_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_unlock(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                             libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                             libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_spinlock_unlock(&mtx->wflag);
+        libtle_rwlock_write_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_adaptive_spin_shared_mutex_unlock_shared(libtle_htm_adaptive_spin_shared_mutex_t *mtx,
+                                                    libtle_htm_adaptive_spin_shared_mutex_handle_t *st,
+                                                    libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_rwlock_read_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* MCS queue lock based mutex                                                 */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_mcslock_t state;
+} libtle_mcs_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_MCS_MUTEX_INIT  { LIBTLE_MCSLOCK_INIT }
+#endif
+
+
+/*
+ * The handle holds the queue node, so it must stay alive (and not move) while
+ * the mutex is locked or being locked through it.
+ */
+typedef struct {
+    libtle_mcslock_node_t node;
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_mcs_mutex_handle_t;
+
+
+static inline void
+libtle_mcs_mutex_handle_init(libtle_mcs_mutex_handle_t *st)
+{
+    libtle_mcslock_node_init(&st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_mcs_mutex_init(libtle_mcs_mutex_t *mtx)
+{
+    libtle_mcslock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_mcs_mutex_lock(libtle_mcs_mutex_t *mtx,
+                      libtle_mcs_mutex_handle_t *st,
+                      libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_mcslock_lock(&mtx->state, &st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_mcs_mutex_try_lock(libtle_mcs_mutex_t *mtx,
+                          libtle_mcs_mutex_handle_t *st,
+                          libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_mcslock_try_lock(&mtx->state, &st->node)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+/*
+ * The timed lock polls libtle_mcs_mutex_try_lock(), without queueing, so it
+ * only succeeds when the queue is empty: while the lock is handed over from
+ * waiter to waiter it times out, however short each critical section is.
+ */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_mcs_mutex_try_lock_until,
+                                   libtle_mcs_mutex_try_lock,
+                                   libtle_mcs_mutex_t,
+                                   libtle_mcs_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+static inline void
+libtle_mcs_mutex_unlock(libtle_mcs_mutex_t *mtx,
+                        libtle_mcs_mutex_handle_t *st,
+                        libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE);
+    libtle_mcslock_unlock(&mtx->state, &st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based mutex with an MCS queue lock as fallback                         */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_mcslock_t state;
+} libtle_htm_mcs_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_MCS_MUTEX_INIT  { LIBTLE_MCSLOCK_INIT }
+#endif
+
+
+typedef struct {
+    libtle_mcslock_node_t node;
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_htm_mcs_mutex_handle_t;
+
+
+static inline void
+libtle_htm_mcs_mutex_handle_init(libtle_htm_mcs_mutex_handle_t *st)
+{
+    libtle_mcslock_node_init(&st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_htm_mcs_mutex_init(libtle_htm_mcs_mutex_t *mtx)
+{
+    libtle_mcslock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_htm_mcs_mutex_lock(libtle_htm_mcs_mutex_t *mtx,
+                          libtle_htm_mcs_mutex_handle_t *st,
+                          libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_mcslock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the queue tail to our read-set */
+                if (libtle_mcslock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; queue up for the lock! */
+    libtle_mcslock_lock(&mtx->state, &st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_htm_mcs_mutex_try_lock(libtle_htm_mcs_mutex_t *mtx,
+                              libtle_htm_mcs_mutex_handle_t *st,
+                              libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_mcslock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the queue tail to our read-set */
+                if (libtle_mcslock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_mcslock_try_lock(&mtx->state, &st->node)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+/*
+ * Same as libtle_mcs_mutex_try_lock_until(): the fallback only succeeds when
+ * the queue is empty.
+ */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_mcs_mutex_try_lock_until,
+                                   libtle_htm_mcs_mutex_try_lock,
+                                   libtle_htm_mcs_mutex_t,
+                                   libtle_htm_mcs_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_mcs_mutex_unlock(libtle_htm_mcs_mutex_t *mtx,
+                            libtle_htm_mcs_mutex_handle_t *st,
+                            libtle_htm_mutex_profile_t *p)
+{
+#ifndef NDEBUG
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_mcslock_unlock(&mtx->state, &st->node);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#else
+    /* an elided critical section always sees an empty queue */
+    if (libtle_mcslock_is_locked(&mtx->state)) {
+        libtle_mcslock_unlock(&mtx->state, &st->node);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+    } else {
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+    }
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based mutex with a NUMA-aware cohort lock as fallback                  */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    libtle_cohortlock_t state;
+} libtle_htm_cohort_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_COHORT_MUTEX_INIT  { LIBTLE_COHORTLOCK_INIT }
+#endif
+
+
+/*
+ * The handle caches the NUMA node of its thread, so it should be initialized
+ * by the thread that uses it.
+ */
+typedef struct {
+    unsigned node;
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_htm_cohort_mutex_handle_t;
+
+
+static inline void
+libtle_htm_cohort_mutex_handle_init(libtle_htm_cohort_mutex_handle_t *st)
+{
+    st->node = libtle_cohortlock_current_node();
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_htm_cohort_mutex_init(libtle_htm_cohort_mutex_t *mtx)
+{
+    libtle_cohortlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_htm_cohort_mutex_lock(libtle_htm_cohort_mutex_t *mtx,
+                             libtle_htm_cohort_mutex_handle_t *st,
+                             libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_cohortlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the global lock to our read-set */
+                if (libtle_cohortlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; take the lock through our node! */
+    libtle_cohortlock_lock(&mtx->state, st->node);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_htm_cohort_mutex_try_lock(libtle_htm_cohort_mutex_t *mtx,
+                                 libtle_htm_cohort_mutex_handle_t *st,
+                                 libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_cohortlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the global lock to our read-set */
+                if (libtle_cohortlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_cohortlock_try_lock(&mtx->state, st->node)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+/*
+ * The timed lock polls libtle_htm_cohort_mutex_try_lock(), without waiting
+ * on the local lock, so it only succeeds when the lock is idle, or when the
+ * global lock was just passed over within its node; the batches of the other
+ * nodes shut it out.
+ */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_cohort_mutex_try_lock_until,
+                                   libtle_htm_cohort_mutex_try_lock,
+                                   libtle_htm_cohort_mutex_t,
+                                   libtle_htm_cohort_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_cohort_mutex_unlock(libtle_htm_cohort_mutex_t *mtx,
+                               libtle_htm_cohort_mutex_handle_t *st,
+                               libtle_htm_mutex_profile_t *p)
+{
+#ifndef NDEBUG
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_cohortlock_unlock(&mtx->state, st->node);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#else
+    /* an elided critical section always sees a free global lock */
+    if (libtle_cohortlock_is_locked(&mtx->state)) {
+        libtle_cohortlock_unlock(&mtx->state, st->node);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+    } else {
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+    }
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based reader/writer mutex with a cohort lock for the fallback writers  */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * The fallback writers take the cohort lock %writers, and then the write lock
+ * of %state for the critical section only, so the write ownership (and the
+ * data it protects) stays on one NUMA node while writers of that node queue
+ * up. The readers and the elided critical sections use %state and %wflag as
+ * libtle_htm_spin_shared_mutex_t does: the elided writers only subscribe to
+ * %state, and the elided readers only to %wflag, so the cohort lock adds no
+ * read-set cost.
+ */
+typedef struct {
+    alignas(64) libtle_rwlock_t     state;
+    alignas(64) libtle_spinlock_t   wflag;
+    libtle_cohortlock_t             writers;
+} libtle_htm_cohort_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_COHORT_SHARED_MUTEX_INIT \
+    { LIBTLE_RWLOCK_INIT, LIBTLE_SPINLOCK_INIT, LIBTLE_COHORTLOCK_INIT }
+#endif
+
+
+/*
+ * The handle caches the NUMA node of its thread, so it should be initialized
+ * by the thread that uses it.
+ */
+typedef struct {
+    unsigned node;
+    enum libtle_mutex_status_t status;
+} libtle_htm_cohort_shared_mutex_handle_t;
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_handle_init(libtle_htm_cohort_shared_mutex_handle_t *st)
+{
+    st->node = libtle_cohortlock_current_node();
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+}
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_init(libtle_htm_cohort_shared_mutex_t *mtx)
+{
+    libtle_rwlock_init(&mtx->state);
+    libtle_spinlock_init(&mtx->wflag);
+    libtle_cohortlock_init(&mtx->writers);
+}
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_lock(libtle_htm_cohort_shared_mutex_t *mtx,
+                                    libtle_htm_cohort_shared_mutex_handle_t *st,
+                                    libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_rwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; queue up with the writers of our node! */
+    libtle_cohortlock_lock(&mtx->writers, st->node);
+    libtle_rwlock_write_lock(&mtx->state);
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_lock_shared(libtle_htm_cohort_shared_mutex_t *mtx,
+                                           libtle_htm_cohort_shared_mutex_handle_t *st,
+                                           libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_rwlock_read_lock(&mtx->state);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline int
+libtle_htm_cohort_shared_mutex_try_lock(libtle_htm_cohort_shared_mutex_t *mtx,
+                                        libtle_htm_cohort_shared_mutex_handle_t *st,
+                                        libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_rwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab both locks */
+    if (!libtle_cohortlock_try_lock(&mtx->writers, st->node)) {
+        return 0;
+    }
+    if (!libtle_rwlock_try_write_lock(&mtx->state)) {
+        libtle_cohortlock_unlock(&mtx->writers, st->node);
+        return 0;
+    }
+    libtle_spinlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_cohort_shared_mutex_try_lock_shared(libtle_htm_cohort_shared_mutex_t *mtx,
+                                               libtle_htm_cohort_shared_mutex_handle_t *st,
+                                               libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+/* see libtle_htm_cohort_mutex_try_lock_until() */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_cohort_shared_mutex_try_lock_until,
+                                   libtle_htm_cohort_shared_mutex_try_lock,
+                                   libtle_htm_cohort_shared_mutex_t,
+                                   libtle_htm_cohort_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_cohort_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_cohort_shared_mutex_try_lock_shared,
+                                   libtle_htm_cohort_shared_mutex_t,
+                                   libtle_htm_cohort_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_unlock(libtle_htm_cohort_shared_mutex_t *mtx,
+                                      libtle_htm_cohort_shared_mutex_handle_t *st,
+                                      libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_spinlock_unlock(&mtx->wflag);
+        libtle_rwlock_write_unlock(&mtx->state);
+        /* pass the cohort lock over to the next writer of our node, if any */
+        libtle_cohortlock_unlock(&mtx->writers, st->node);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_cohort_shared_mutex_unlock_shared(libtle_htm_cohort_shared_mutex_t *mtx,
+                                             libtle_htm_cohort_shared_mutex_handle_t *st,
+                                             libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_rwlock_read_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Distributed rwlock based reader/writer mutex                               */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_distrwlock_t state;
+} libtle_dist_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_DIST_SHARED_MUTEX_INIT  { LIBTLE_DISTRWLOCK_INIT }
+#endif
+
+
+/*
+ * The handle holds the reader slot of the thread, which is picked from the
+ * address of the handle when it is initialized.
+ */
+typedef struct {
+    unsigned slot;
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_dist_shared_mutex_handle_t;
+
+
+static inline void
+libtle_dist_shared_mutex_handle_init(libtle_dist_shared_mutex_handle_t *st)
+{
+    st->slot = libtle_distrwlock_slot_of(st);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_dist_shared_mutex_init(libtle_dist_shared_mutex_t *mtx)
+{
+    libtle_distrwlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_dist_shared_mutex_lock(libtle_dist_shared_mutex_t *mtx,
+                              libtle_dist_shared_mutex_handle_t *st,
+                              libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_distrwlock_write_lock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline void
+libtle_dist_shared_mutex_lock_shared(libtle_dist_shared_mutex_t *mtx,
+                                     libtle_dist_shared_mutex_handle_t *st,
+                                     libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    libtle_distrwlock_read_lock(&mtx->state, st->slot);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+}
+
+
+static inline int
+libtle_dist_shared_mutex_try_lock(libtle_dist_shared_mutex_t *mtx,
+                                  libtle_dist_shared_mutex_handle_t *st,
+                                  libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_distrwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_dist_shared_mutex_try_lock_shared(libtle_dist_shared_mutex_t *mtx,
+                                         libtle_dist_shared_mutex_handle_t *st,
+                                         libtle_mutex_profile_t *p)
+{
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (!libtle_distrwlock_try_read_lock(&mtx->state, st->slot)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_dist_shared_mutex_try_lock_until,
+                                   libtle_dist_shared_mutex_try_lock,
+                                   libtle_dist_shared_mutex_t,
+                                   libtle_dist_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_dist_shared_mutex_try_lock_shared_until,
+                                   libtle_dist_shared_mutex_try_lock_shared,
+                                   libtle_dist_shared_mutex_t,
+                                   libtle_dist_shared_mutex_handle_t,
+                                   libtle_mutex_profile_t)
+
+
+static inline void
+libtle_dist_shared_mutex_unlock(libtle_dist_shared_mutex_t *mtx,
+                                libtle_dist_shared_mutex_handle_t *st,
+                                libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE);
+    libtle_distrwlock_write_unlock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+static inline void
+libtle_dist_shared_mutex_unlock_shared(libtle_dist_shared_mutex_t *mtx,
+                                       libtle_dist_shared_mutex_handle_t *st,
+                                       libtle_mutex_profile_t *p)
+{
+    assert(st->status == LIBTLE_MUTEX_STATUS_LOCKED_SHARED);
+    libtle_distrwlock_read_unlock(&mtx->state, st->slot);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#endif
+    if (p) {
+        libtle_mutex_profile_update_unlock(p);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based reader/writer mutex with distributed rwlock as fallback          */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_distrwlock_t state;
+} libtle_htm_dist_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_DIST_SHARED_MUTEX_INIT  { LIBTLE_DISTRWLOCK_INIT }
+#endif
+
+
+typedef struct {
+    unsigned slot;
+    enum libtle_mutex_status_t status;
+} libtle_htm_dist_shared_mutex_handle_t;
+
+
+static inline void
+libtle_htm_dist_shared_mutex_handle_init(libtle_htm_dist_shared_mutex_handle_t *st)
+{
+    st->slot = libtle_distrwlock_slot_of(st);
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+}
+
+
+static inline void
+libtle_htm_dist_shared_mutex_init(libtle_htm_dist_shared_mutex_t *mtx)
+{
+    libtle_distrwlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_htm_dist_shared_mutex_lock(libtle_htm_dist_shared_mutex_t *mtx,
+                                  libtle_htm_dist_shared_mutex_handle_t *st,
+                                  libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_distrwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the writer flag and all the reader slots to our read-set */
+                if (libtle_distrwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_distrwlock_write_lock(&mtx->state);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_dist_shared_mutex_lock_shared(libtle_htm_dist_shared_mutex_t *mtx,
+                                         libtle_htm_dist_shared_mutex_handle_t *st,
+                                         libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_distrwlock_write_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the writer flag to our read-set */
+                if (libtle_distrwlock_is_write_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_distrwlock_read_lock(&mtx->state, st->slot);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline int
+libtle_htm_dist_shared_mutex_try_lock(libtle_htm_dist_shared_mutex_t *mtx,
+                                      libtle_htm_dist_shared_mutex_handle_t *st,
+                                      libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_distrwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the writer flag and all the reader slots to our read-set */
+                if (libtle_distrwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_distrwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_dist_shared_mutex_try_lock_shared(libtle_htm_dist_shared_mutex_t *mtx,
+                                             libtle_htm_dist_shared_mutex_handle_t *st,
+                                             libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_distrwlock_is_write_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the writer flag to our read-set */
+                if (libtle_distrwlock_is_write_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_distrwlock_try_read_lock(&mtx->state, st->slot)) {
+        return 0;
+    }
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_dist_shared_mutex_try_lock_until,
+                                   libtle_htm_dist_shared_mutex_try_lock,
+                                   libtle_htm_dist_shared_mutex_t,
+                                   libtle_htm_dist_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_dist_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_dist_shared_mutex_try_lock_shared,
+                                   libtle_htm_dist_shared_mutex_t,
+                                   libtle_htm_dist_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_dist_shared_mutex_unlock(libtle_htm_dist_shared_mutex_t *mtx,
+                                    libtle_htm_dist_shared_mutex_handle_t *st,
+                                    libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_distrwlock_write_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_dist_shared_mutex_unlock_shared(libtle_htm_dist_shared_mutex_t *mtx,
+                                           libtle_htm_dist_shared_mutex_handle_t *st,
+                                           libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_distrwlock_read_unlock(&mtx->state, st->slot);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+#ifdef __linux__
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based mutex with a futex lock as fallback                              */
+/* -------------------------------------------------------------------------- */
+
+
+typedef struct {
+    alignas(64) libtle_futexlock_t state;
+} libtle_htm_futex_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_FUTEX_MUTEX_INIT  { LIBTLE_FUTEXLOCK_INIT }
+#endif
+
+
+typedef struct {
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_htm_futex_mutex_handle_t;
+
+
+static inline void
+libtle_htm_futex_mutex_handle_init(libtle_htm_futex_mutex_handle_t *st)
+{
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_htm_futex_mutex_init(libtle_htm_futex_mutex_t *mtx)
+{
+    libtle_futexlock_init(&mtx->state);
+}
+
+
+static inline void
+libtle_htm_futex_mutex_lock(libtle_htm_futex_mutex_t *mtx,
+                            libtle_htm_futex_mutex_handle_t *st,
+                            libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            /* this may sleep until the owner releases the lock */
+            libtle_futexlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futexlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_futexlock_lock(&mtx->state);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_htm_futex_mutex_try_lock(libtle_htm_futex_mutex_t *mtx,
+                                libtle_htm_futex_mutex_handle_t *st,
+                                libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_futexlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futexlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_futexlock_try_lock(&mtx->state)) {
+        return 0;
+    }
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+/*
+ * The timed lock polls libtle_htm_futex_mutex_try_lock() with a backoff,
+ * without sleeping in the kernel, so it only succeeds when it finds the lock
+ * idle, between a release and the next acquisition.
+ */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_futex_mutex_try_lock_until,
+                                   libtle_htm_futex_mutex_try_lock,
+                                   libtle_htm_futex_mutex_t,
+                                   libtle_htm_futex_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_futex_mutex_unlock(libtle_htm_futex_mutex_t *mtx,
+                              libtle_htm_futex_mutex_handle_t *st,
+                              libtle_htm_mutex_profile_t *p)
+{
+#ifndef NDEBUG
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_futexlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#else
+    if (libtle_futexlock_is_locked(&mtx->state)) {
+        libtle_futexlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+    } else {
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+    }
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based reader/writer mutex with futex rwlock as fallback                */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * As for libtle_htm_spin_shared_mutex_t, the elided readers only subscribe to
+ * %wflag, which the writers take after %state, so they do not abort when
+ * other readers take the fallback lock.
+ */
+typedef struct {
+    alignas(64) libtle_futex_rwlock_t   state;
+    alignas(64) libtle_futexlock_t      wflag;
+} libtle_htm_futex_shared_mutex_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_FUTEX_SHARED_MUTEX_INIT  { LIBTLE_FUTEX_RWLOCK_INIT, LIBTLE_FUTEXLOCK_INIT }
+#endif
+
+
+typedef struct {
+    enum libtle_mutex_status_t status;
+} libtle_htm_futex_shared_mutex_handle_t;
+
+
+static inline void
+libtle_htm_futex_shared_mutex_handle_init(libtle_htm_futex_shared_mutex_handle_t *st)
+{
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+}
+
+
+static inline void
+libtle_htm_futex_shared_mutex_init(libtle_htm_futex_shared_mutex_t *mtx)
+{
+    libtle_futex_rwlock_init(&mtx->state);
+    libtle_futexlock_init(&mtx->wflag);
+}
+
+
+static inline void
+libtle_htm_futex_shared_mutex_lock(libtle_htm_futex_shared_mutex_t *mtx,
+                                   libtle_htm_futex_shared_mutex_handle_t *st,
+                                   libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_futex_rwlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futex_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_futex_rwlock_write_lock(&mtx->state);
+    libtle_futexlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+}
+
+
+static inline void
+libtle_htm_futex_shared_mutex_lock_shared(libtle_htm_futex_shared_mutex_t *mtx,
+                                          libtle_htm_futex_shared_mutex_handle_t *st,
+                                          libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_futexlock_unlock_wait(&mtx->wflag);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futexlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_futex_rwlock_read_lock(&mtx->state);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+}
+
+
+static inline int
+libtle_htm_futex_shared_mutex_try_lock(libtle_htm_futex_shared_mutex_t *mtx,
+                                       libtle_htm_futex_shared_mutex_handle_t *st,
+                                       libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_futex_rwlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futex_rwlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_WRITE_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_futex_rwlock_try_write_lock(&mtx->state)) {
+        return 0;
+    }
+    libtle_futexlock_lock_uncontended(&mtx->wflag);
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+    return 1;
+}
+
+
+static inline int
+libtle_htm_futex_shared_mutex_try_lock_shared(libtle_htm_futex_shared_mutex_t *mtx,
+                                              libtle_htm_futex_shared_mutex_handle_t *st,
+                                              libtle_htm_mutex_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_futexlock_is_locked(&mtx->wflag)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_futexlock_is_locked(&mtx->wflag)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(p, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_SHARED_MUTEX_READ_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_futex_rwlock_try_read_lock(&mtx->state)) {
+        return 0;
+    }
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_SHARED;
+    return 1;
+}
+
+
+/*
+ * As for libtle_htm_futex_mutex_try_lock_until(), the timed locks only
+ * succeed when they find the lock idle (or, for a reader, held by readers
+ * only).
+ */
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_futex_shared_mutex_try_lock_until,
+                                   libtle_htm_futex_shared_mutex_try_lock,
+                                   libtle_htm_futex_shared_mutex_t,
+                                   libtle_htm_futex_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_futex_shared_mutex_try_lock_shared_until,
+                                   libtle_htm_futex_shared_mutex_try_lock_shared,
+                                   libtle_htm_futex_shared_mutex_t,
+                                   libtle_htm_futex_shared_mutex_handle_t,
+                                   libtle_htm_mutex_profile_t)
+
+
+static inline void
+libtle_htm_futex_shared_mutex_unlock(libtle_htm_futex_shared_mutex_t *mtx,
+                                     libtle_htm_futex_shared_mutex_handle_t *st,
+                                     libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        libtle_futexlock_unlock(&mtx->wflag);
+        libtle_futex_rwlock_write_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+
+static inline void
+libtle_htm_futex_shared_mutex_unlock_shared(libtle_htm_futex_shared_mutex_t *mtx,
+                                            libtle_htm_futex_shared_mutex_handle_t *st,
+                                            libtle_htm_mutex_profile_t *p)
+{
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(p);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_SHARED:
+        libtle_futex_rwlock_read_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(p);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+}
+
+#endif /* __linux__ */
+
+
+/* -------------------------------------------------------------------------- */
+/* HTM-based sequence lock with a spinlock as fallback for the writers        */
+/* -------------------------------------------------------------------------- */
+
+
+/*
+ * The readers never write to the lock, nor run transactions: they read the
+ * data between libtle_htm_seqlock_read_begin() and
+ * libtle_htm_seqlock_read_retry(), and start again if a writer changed it
+ * meanwhile. So a read may see torn data, and must only copy it out (with
+ * relaxed atomic loads, for a well defined C/C++ program) until it is
+ * validated.
+ *
+ * The writers elide the spinlock, and each commit bumps the sequence number
+ * at its very end. The sequence number has its own cache line, away from the
+ * lock word that the elided writers read at their start, so two elided
+ * writers only conflict on it for a short window. A writer that falls back
+ * makes the sequence number odd while it holds the lock, which the readers
+ * wait for; the elided writers subscribe to the spinlock instead, and wait
+ * for it to be free.
+ */
+typedef struct {
+    alignas(64) libtle_spinlock_t state;
+    alignas(64) atomic_uint seq;
+} libtle_htm_seqlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_HTM_SEQLOCK_INIT  { LIBTLE_SPINLOCK_INIT, ATOMIC_VAR_INIT(0) }
+#endif
+
+
+typedef struct {
+#ifndef NDEBUG
+    enum libtle_mutex_status_t status;
+#endif
+} libtle_htm_seqlock_handle_t;
+
+
+static inline void
+libtle_htm_seqlock_handle_init(libtle_htm_seqlock_handle_t *st)
+{
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_UNKNOWN;
+#endif
+}
+
+
+static inline void
+libtle_htm_seqlock_init(libtle_htm_seqlock_t *mtx)
+{
+    libtle_spinlock_init(&mtx->state);
+    atomic_init(&mtx->seq, 0u);
+}
+
+
+/* the fallback lock is held: make the sequence number odd */
+static inline void
+libtle_htm_seqlock_write_begin(libtle_htm_seqlock_t *mtx)
+{
+    unsigned s = atomic_load_explicit(&mtx->seq, memory_order_relaxed);
+    atomic_store_explicit(&mtx->seq, s + 1, memory_order_relaxed);
+    /* order the data updates after the odd sequence number */
+    atomic_thread_fence(memory_order_release);
+}
+
+
+static inline void
+libtle_htm_seqlock_lock(libtle_htm_seqlock_t *mtx,
+                        libtle_htm_seqlock_handle_t *st,
+                        libtle_htm_seqlock_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        do {
+            libtle_spinlock_unlock_wait(&mtx->state);
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(&p->write, xstatus);
+            }
+        }
+        while (_XBEGIN_RESTART(xstatus) &&
+               num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+    }
+
+    /* we failed too many times; grab the lock! */
+    libtle_spinlock_lock(&mtx->state);
+    libtle_htm_seqlock_write_begin(mtx);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+}
+
+
+static inline int
+libtle_htm_seqlock_try_lock(libtle_htm_seqlock_t *mtx,
+                            libtle_htm_seqlock_handle_t *st,
+                            libtle_htm_seqlock_profile_t *p)
+{
+    int num_retries = 0;
+    unsigned xstatus;
+    assert(st->status <= LIBTLE_MUTEX_STATUS_UNLOCKED);
+    if (libtle_htm_supported()) {
+        /* never wait for the lock: elide only while it looks free */
+        while (!libtle_spinlock_is_locked(&mtx->state)) {
+            xstatus = _xbegin();
+            if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                /* add the lock to our read-set */
+                if (libtle_spinlock_is_locked(&mtx->state)) {
+                    _xabort(LIBTLE_LOCK_IS_LOCKED);
+                    __builtin_unreachable();
+                }
+#ifndef NDEBUG
+                st->status = LIBTLE_MUTEX_STATUS_ELIDED;
+#endif
+                return 1;
+            }
+            ++num_retries;
+            if (p) {
+                libtle_htm_mutex_profile_update_abort(&p->write, xstatus);
+            }
+            if (!_XBEGIN_RESTART(xstatus) ||
+                num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                break;
+            }
+        }
+    }
+
+    /* a single attempt to grab the lock */
+    if (!libtle_spinlock_try_lock(&mtx->state)) {
+        return 0;
+    }
+    libtle_htm_seqlock_write_begin(mtx);
+#ifndef NDEBUG
+    st->status = LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE;
+#endif
+    return 1;
+}
+
+
+LIBTLE_MUTEX_DEFINE_TRY_LOCK_UNTIL(libtle_htm_seqlock_try_lock_until,
+                                   libtle_htm_seqlock_try_lock,
+                                   libtle_htm_seqlock_t,
+                                   libtle_htm_seqlock_handle_t,
+                                   libtle_htm_seqlock_profile_t)
+
+
+static inline void
+libtle_htm_seqlock_unlock(libtle_htm_seqlock_t *mtx,
+                          libtle_htm_seqlock_handle_t *st,
+                          libtle_htm_seqlock_profile_t *p)
+{
+    unsigned s = atomic_load_explicit(&mtx->seq, memory_order_relaxed);
+#ifndef NDEBUG
+    switch (st->status) {
+    case LIBTLE_MUTEX_STATUS_ELIDED:
+        /* the readers see the new sequence number with the data, at commit */
+        atomic_store_explicit(&mtx->seq, s + 2, memory_order_relaxed);
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(&p->write);
+        }
+        break;
+    case LIBTLE_MUTEX_STATUS_LOCKED_UNIQUE:
+        atomic_store_explicit(&mtx->seq, s + 1, memory_order_release);
+        libtle_spinlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(&p->write);
+        }
+        break;
+    default:
+        assert(0);
+    }
+    st->status = LIBTLE_MUTEX_STATUS_UNLOCKED;
+#else
+    if (libtle_spinlock_is_locked(&mtx->state)) {
+        atomic_store_explicit(&mtx->seq, s + 1, memory_order_release);
+        libtle_spinlock_unlock(&mtx->state);
+        if (p) {
+            libtle_htm_mutex_profile_update_unlock(&p->write);
+        }
+    } else {
+        atomic_store_explicit(&mtx->seq, s + 2, memory_order_relaxed);
+        _xend();
+        if (p && !_xtest()) {
+            libtle_htm_mutex_profile_update_commit(&p->write);
+        }
+    }
+#endif
+}
+
+
+/*
+ * Start a read: wait for the writer that holds the fallback lock, if any,
+ * and return the sequence number to validate the read with
+ */
+static inline unsigned
+libtle_htm_seqlock_read_begin(libtle_htm_seqlock_t *mtx,
+                              libtle_htm_seqlock_handle_t *st,
+                              libtle_htm_seqlock_profile_t *p)
+{
+    unsigned s;
+    (void) st;
+    (void) p;
+    while ((s = atomic_load_explicit(&mtx->seq, memory_order_acquire)) & 1) {
+        libtle_lock_pause();
+    }
+    return s;
+}
+
+
+/*
+ * Validate the read started by libtle_htm_seqlock_read_begin(), which
+ * returned seq. Returns nonzero if a writer changed the data meanwhile, so
+ * the read must start again.
+ */
+static inline int
+libtle_htm_seqlock_read_retry(libtle_htm_seqlock_t *mtx,
+                              libtle_htm_seqlock_handle_t *st,
+                              libtle_htm_seqlock_profile_t *p,
+                              unsigned seq)
+{
+    int retry;
+    (void) st;
+    /* order the data reads before the validation */
+    atomic_thread_fence(memory_order_acquire);
+    retry = atomic_load_explicit(&mtx->seq, memory_order_relaxed) != seq;
+    if (p) {
+        libtle_htm_seqlock_profile_update_read(p, retry);
+    }
+    return retry;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Generics                                                                   */
+/* -------------------------------------------------------------------------- */
+
+#ifndef __cplusplus
+
+#ifdef __linux__
+#define __LIBTLE_HTM_FUTEX_GENERICS(T,F) \
+                   libtle_htm_futex_mutex##T*: libtle_htm_futex_mutex_##F, \
+            libtle_htm_futex_shared_mutex##T*: libtle_htm_futex_shared_mutex_##F,
+#define __LIBTLE_HTM_FUTEX_SHARED_GENERICS(T,F) \
+            libtle_htm_futex_shared_mutex##T*: libtle_htm_futex_shared_mutex_##F,
+#else
+#define __LIBTLE_HTM_FUTEX_GENERICS(T,F)
+#define __LIBTLE_HTM_FUTEX_SHARED_GENERICS(T,F)
+#endif
+
+#define libtle_mutex_handle_init(M) _Generic((M), \
+                        libtle_null_mutex_handle_t*: libtle_null_mutex_handle_init, \
+                        libtle_spin_mutex_handle_t*: libtle_spin_mutex_handle_init, \
+                    libtle_htm_spin_mutex_handle_t*: libtle_htm_spin_mutex_handle_init, \
+                 libtle_null_shared_mutex_handle_t*: libtle_null_shared_mutex_handle_init, \
+                 libtle_spin_shared_mutex_handle_t*: libtle_spin_shared_mutex_handle_init, \
+             libtle_htm_spin_shared_mutex_handle_t*: libtle_htm_spin_shared_mutex_handle_init, \
+           libtle_htm_adaptive_spin_mutex_handle_t*: libtle_htm_adaptive_spin_mutex_handle_init, \
+    libtle_htm_adaptive_spin_shared_mutex_handle_t*: libtle_htm_adaptive_spin_shared_mutex_handle_init, \
+                         libtle_mcs_mutex_handle_t*: libtle_mcs_mutex_handle_init, \
+                     libtle_htm_mcs_mutex_handle_t*: libtle_htm_mcs_mutex_handle_init, \
+                  libtle_htm_cohort_mutex_handle_t*: libtle_htm_cohort_mutex_handle_init, \
+                 libtle_dist_shared_mutex_handle_t*: libtle_dist_shared_mutex_handle_init, \
+             libtle_htm_dist_shared_mutex_handle_t*: libtle_htm_dist_shared_mutex_handle_init, \
+           libtle_htm_cohort_shared_mutex_handle_t*: libtle_htm_cohort_shared_mutex_handle_init, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_handle_t, handle_init) \
+                       libtle_htm_seqlock_handle_t*: libtle_htm_seqlock_handle_init \
+)(M)
+
+
+#define libtle_mutex_init(M) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_init, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_init, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_init, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_init, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_init, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_init, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_init, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_init, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_init, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_init, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_init, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_init, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_init, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_init, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_init, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_init, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_init, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_init, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, init) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_init \
+)(M)
+
+
+#define libtle_mutex_lock(M,S) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_lock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_lock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_lock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_lock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_lock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_lock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_lock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_lock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_lock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_lock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_lock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_lock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, lock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_lock \
+)(M,S,NULL)
+
+
+#define libtle_mutex_lock_profiled(M,S,P) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_lock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_lock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_lock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_lock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_lock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_lock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_lock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_lock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_lock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_lock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_lock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_lock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, lock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_lock \
+)(M,S,P)
+
+
+#define libtle_mutex_lock_shared(M,S) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, lock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_lock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_lock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_lock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_lock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_lock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_lock_shared \
+)(M,S,NULL)
+
+
+#define libtle_mutex_lock_shared_profiled(M,S,P) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, lock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_lock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_lock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_lock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_lock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_lock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_lock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_lock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_lock_shared \
+)(M,S,P)
+
+
+#define libtle_mutex_try_lock(M,S) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_try_lock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_try_lock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_try_lock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_try_lock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_try_lock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_try_lock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, try_lock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_try_lock \
+)(M,S,NULL)
+
+
+#define libtle_mutex_try_lock_profiled(M,S,P) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_try_lock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_try_lock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_try_lock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_try_lock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_try_lock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_try_lock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, try_lock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_try_lock \
+)(M,S,P)
+
+
+#define libtle_mutex_try_lock_shared(M,S) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, try_lock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_shared \
+)(M,S,NULL)
+
+
+#define libtle_mutex_try_lock_shared_profiled(M,S,P) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, try_lock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_shared \
+)(M,S,P)
+
+
+#define libtle_mutex_try_lock_until(M,S,D) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_try_lock_until, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_try_lock_until, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock_until, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_until, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_until, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_until, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_until, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_until, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_until, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_until, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_try_lock_until, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_until, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_try_lock_until, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_try_lock_until, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_try_lock_until, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_until, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_until, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_until, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, try_lock_until) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_try_lock_until \
+)(M,S,NULL,D)
+
+
+#define libtle_mutex_try_lock_until_profiled(M,S,P,D) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_try_lock_until, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_try_lock_until, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock_until, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_until, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_until, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_until, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_until, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_until, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_until, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_until, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_try_lock_until, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_until, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_try_lock_until, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_try_lock_until, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_try_lock_until, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_until, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_until, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_until, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, try_lock_until) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_try_lock_until \
+)(M,S,P,D)
+
+
+#define libtle_mutex_try_lock_shared_until(M,S,D) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, try_lock_shared_until) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_shared_until, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_shared_until, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_shared_until, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_shared_until, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared_until, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared_until, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared_until, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_shared_until, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_shared_until, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_shared_until, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_shared_until \
+)(M,S,NULL,D)
+
+
+#define libtle_mutex_try_lock_shared_until_profiled(M,S,P,D) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, try_lock_shared_until) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_try_lock_shared_until, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_try_lock_shared_until, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_try_lock_shared_until, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_try_lock_shared_until, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared_until, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared_until, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared_until, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_try_lock_shared_until, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_try_lock_shared_until, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_try_lock_shared_until, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_try_lock_shared_until \
+)(M,S,P,D)
+
+
+#define libtle_mutex_try_lock_site(M,S,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_try_lock_site_profiled(M,S,P,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_try_lock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_site \
+)(M,S,P,T)
+
+
+#define libtle_mutex_try_lock_shared_site(M,S,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_try_lock_shared_site_profiled(M,S,P,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_try_lock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_try_lock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_try_lock_shared_site \
+)(M,S,P,T)
 
 
 #define libtle_mutex_unlock(M,S) _Generic((M), \
-               libtle_null_mutex_t*: libtle_null_mutex_unlock, \
-               libtle_spin_mutex_t*: libtle_spin_mutex_unlock, \
-           libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock, \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock \
+                        libtle_null_mutex_t*: libtle_null_mutex_unlock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_unlock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_unlock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_unlock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_unlock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_unlock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_unlock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_unlock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_unlock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_unlock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_unlock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_unlock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, unlock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_unlock \
+)(M,S,NULL)
+
+
+#define libtle_mutex_unlock_profiled(M,S,P) _Generic((M), \
+                        libtle_null_mutex_t*: libtle_null_mutex_unlock, \
+                        libtle_spin_mutex_t*: libtle_spin_mutex_unlock, \
+                    libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock, \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_unlock, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_unlock, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock, \
+           libtle_htm_adaptive_spin_mutex_t*: libtle_htm_adaptive_spin_mutex_unlock, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_unlock, \
+                         libtle_mcs_mutex_t*: libtle_mcs_mutex_unlock, \
+                     libtle_htm_mcs_mutex_t*: libtle_htm_mcs_mutex_unlock, \
+                  libtle_htm_cohort_mutex_t*: libtle_htm_cohort_mutex_unlock, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_unlock, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_unlock, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_unlock, \
+    __LIBTLE_HTM_FUTEX_GENERICS(_t, unlock) \
+                       libtle_htm_seqlock_t*: libtle_htm_seqlock_unlock \
+)(M,S,P)
+
+
+#define libtle_mutex_unlock_shared(M,S) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, unlock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_unlock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_unlock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_unlock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_unlock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_unlock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_unlock_shared \
 )(M,S,NULL)
 
 
-#define libtle_mutex_unlock_profiled(M,S,P) _Generic((M), \
-               libtle_null_mutex_t*: libtle_null_mutex_unlock, \
-               libtle_spin_mutex_t*: libtle_spin_mutex_unlock, \
-           libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock, \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock \
-)(M,S,P)
+#define libtle_mutex_unlock_shared_profiled(M,S,P) _Generic((M), \
+    __LIBTLE_HTM_FUTEX_SHARED_GENERICS(_t, unlock_shared) \
+                 libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock_shared, \
+                 libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock_shared, \
+              libtle_rp_spin_shared_mutex_t*: libtle_rp_spin_shared_mutex_unlock_shared, \
+              libtle_pf_spin_shared_mutex_t*: libtle_pf_spin_shared_mutex_unlock_shared, \
+             libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared, \
+          libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_shared, \
+          libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_shared, \
+    libtle_htm_adaptive_spin_shared_mutex_t*: libtle_htm_adaptive_spin_shared_mutex_unlock_shared, \
+                 libtle_dist_shared_mutex_t*: libtle_dist_shared_mutex_unlock_shared, \
+             libtle_htm_dist_shared_mutex_t*: libtle_htm_dist_shared_mutex_unlock_shared, \
+           libtle_htm_cohort_shared_mutex_t*: libtle_htm_cohort_shared_mutex_unlock_shared \
+)(M,S,P)
+
+
+#define libtle_mutex_lock_site(M,S,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_lock_site_profiled(M,S,P,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_lock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_site \
+)(M,S,P,T)
+
+
+#define libtle_mutex_lock_shared_site(M,S,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_shared_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_lock_shared_site_profiled(M,S,P,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_lock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_lock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_lock_shared_site \
+)(M,S,P,T)
+
+
+#define libtle_mutex_unlock_site(M,S,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_unlock_site_profiled(M,S,P,T) _Generic((M), \
+              libtle_htm_spin_mutex_t*: libtle_htm_spin_mutex_unlock_site, \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_site \
+)(M,S,P,T)
+
+
+#define libtle_mutex_unlock_shared_site(M,S,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_shared_site \
+)(M,S,NULL,T)
+
+
+#define libtle_mutex_unlock_shared_site_profiled(M,S,P,T) _Generic((M), \
+       libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared_site, \
+    libtle_htm_rp_spin_shared_mutex_t*: libtle_htm_rp_spin_shared_mutex_unlock_shared_site, \
+    libtle_htm_pf_spin_shared_mutex_t*: libtle_htm_pf_spin_shared_mutex_unlock_shared_site \
+)(M,S,P,T)
+
+#else
+
+// libtle_mutex_handle_init()
+
+static inline void
+libtle_mutex_handle_init(libtle_null_mutex_handle_t *h)
+{
+    libtle_null_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_spin_mutex_handle_t *h)
+{
+    libtle_spin_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_spin_mutex_handle_t *h)
+{
+    libtle_htm_spin_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_null_shared_mutex_handle_t *h)
+{
+    libtle_null_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_spin_shared_mutex_handle_t *h)
+{
+    libtle_spin_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_spin_shared_mutex_handle_t *h)
+{
+    libtle_htm_spin_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_adaptive_spin_mutex_handle_t *h)
+{
+    libtle_htm_adaptive_spin_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_adaptive_spin_shared_mutex_handle_t *h)
+{
+    libtle_htm_adaptive_spin_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_mcs_mutex_handle_t *h)
+{
+    libtle_mcs_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_mcs_mutex_handle_t *h)
+{
+    libtle_htm_mcs_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_cohort_mutex_handle_t *h)
+{
+    libtle_htm_cohort_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_dist_shared_mutex_handle_t *h)
+{
+    libtle_dist_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_dist_shared_mutex_handle_t *h)
+{
+    libtle_htm_dist_shared_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_cohort_shared_mutex_handle_t *h)
+{
+    libtle_htm_cohort_shared_mutex_handle_init(h);
+}
+
+#ifdef __linux__
+static inline void
+libtle_mutex_handle_init(libtle_htm_futex_mutex_handle_t *h)
+{
+    libtle_htm_futex_mutex_handle_init(h);
+}
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_futex_shared_mutex_handle_t *h)
+{
+    libtle_htm_futex_shared_mutex_handle_init(h);
+}
+#endif
+
+static inline void
+libtle_mutex_handle_init(libtle_htm_seqlock_handle_t *h)
+{
+    libtle_htm_seqlock_handle_init(h);
+}
+
+// libtle_mutex_init()
+
+static inline void
+libtle_mutex_init(libtle_null_mutex_t *m)
+{
+    libtle_null_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_spin_mutex_t *m)
+{
+    libtle_spin_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_spin_mutex_t *m)
+{
+    libtle_htm_spin_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_null_shared_mutex_t *m)
+{
+    libtle_null_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_spin_shared_mutex_t *m)
+{
+    libtle_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_rp_spin_shared_mutex_t *m)
+{
+    libtle_rp_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_pf_spin_shared_mutex_t *m)
+{
+    libtle_pf_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_spin_shared_mutex_t *m)
+{
+    libtle_htm_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_rp_spin_shared_mutex_t *m)
+{
+    libtle_htm_rp_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_pf_spin_shared_mutex_t *m)
+{
+    libtle_htm_pf_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_adaptive_spin_mutex_t *m)
+{
+    libtle_htm_adaptive_spin_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_adaptive_spin_shared_mutex_t *m)
+{
+    libtle_htm_adaptive_spin_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_mcs_mutex_t *m)
+{
+    libtle_mcs_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_mcs_mutex_t *m)
+{
+    libtle_htm_mcs_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_cohort_mutex_t *m)
+{
+    libtle_htm_cohort_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_dist_shared_mutex_t *m)
+{
+    libtle_dist_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_dist_shared_mutex_t *m)
+{
+    libtle_htm_dist_shared_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_cohort_shared_mutex_t *m)
+{
+    libtle_htm_cohort_shared_mutex_init(m);
+}
+
+#ifdef __linux__
+static inline void
+libtle_mutex_init(libtle_htm_futex_mutex_t *m)
+{
+    libtle_htm_futex_mutex_init(m);
+}
+
+static inline void
+libtle_mutex_init(libtle_htm_futex_shared_mutex_t *m)
+{
+    libtle_htm_futex_shared_mutex_init(m);
+}
+#endif
+
+static inline void
+libtle_mutex_init(libtle_htm_seqlock_t *m)
+{
+    libtle_htm_seqlock_init(m);
+}
+
+// libtle_mutex_lock()
+
+static inline void
+libtle_mutex_lock(libtle_null_mutex_t *m,
+                  libtle_null_mutex_handle_t *h,
+                  libtle_null_mutex_profile_t *p = nullptr)
+{
+    libtle_null_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_spin_mutex_t *m,
+                  libtle_spin_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_spin_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_spin_mutex_t *m,
+                  libtle_htm_spin_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_spin_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_null_shared_mutex_t *m,
+                  libtle_null_shared_mutex_handle_t *h,
+                  libtle_null_mutex_profile_t *p = nullptr)
+{
+    libtle_null_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_spin_shared_mutex_t *m,
+                  libtle_spin_shared_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_rp_spin_shared_mutex_t *m,
+                  libtle_spin_shared_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_rp_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_pf_spin_shared_mutex_t *m,
+                  libtle_spin_shared_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_pf_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_spin_shared_mutex_t *m,
+                  libtle_htm_spin_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_rp_spin_shared_mutex_t *m,
+                  libtle_htm_spin_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_rp_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_pf_spin_shared_mutex_t *m,
+                  libtle_htm_spin_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_pf_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_adaptive_spin_mutex_t *m,
+                  libtle_htm_adaptive_spin_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_adaptive_spin_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                  libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_adaptive_spin_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_mcs_mutex_t *m,
+                  libtle_mcs_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_mcs_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_mcs_mutex_t *m,
+                  libtle_htm_mcs_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_mcs_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_cohort_mutex_t *m,
+                  libtle_htm_cohort_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_cohort_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_dist_shared_mutex_t *m,
+                  libtle_dist_shared_mutex_handle_t *h,
+                  libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_dist_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_dist_shared_mutex_t *m,
+                  libtle_htm_dist_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_dist_shared_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_cohort_shared_mutex_t *m,
+                  libtle_htm_cohort_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_cohort_shared_mutex_lock(m, h, p);
+}
+
+#ifdef __linux__
+static inline void
+libtle_mutex_lock(libtle_htm_futex_mutex_t *m,
+                  libtle_htm_futex_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_futex_mutex_lock(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock(libtle_htm_futex_shared_mutex_t *m,
+                  libtle_htm_futex_shared_mutex_handle_t *h,
+                  libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_futex_shared_mutex_lock(m, h, p);
+}
+#endif
+
+static inline void
+libtle_mutex_lock(libtle_htm_seqlock_t *m,
+                  libtle_htm_seqlock_handle_t *h,
+                  libtle_htm_seqlock_profile_t *p = nullptr)
+{
+    libtle_htm_seqlock_lock(m, h, p);
+}
+
+// libtle_mutex_lock_shared()
+
+static inline void
+libtle_mutex_lock_shared(libtle_null_shared_mutex_t *m,
+                         libtle_null_shared_mutex_handle_t *h,
+                         libtle_null_mutex_profile_t *p = nullptr)
+{
+    libtle_null_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_spin_shared_mutex_t *m,
+                         libtle_spin_shared_mutex_handle_t *h,
+                         libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_rp_spin_shared_mutex_t *m,
+                         libtle_spin_shared_mutex_handle_t *h,
+                         libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_rp_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_pf_spin_shared_mutex_t *m,
+                         libtle_spin_shared_mutex_handle_t *h,
+                         libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_pf_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_rp_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_rp_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_pf_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_pf_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                         libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_adaptive_spin_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_dist_shared_mutex_t *m,
+                         libtle_dist_shared_mutex_handle_t *h,
+                         libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_dist_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_dist_shared_mutex_t *m,
+                         libtle_htm_dist_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_dist_shared_mutex_lock_shared(m, h, p);
+}
+
+static inline void
+libtle_mutex_lock_shared(libtle_htm_cohort_shared_mutex_t *m,
+                         libtle_htm_cohort_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_cohort_shared_mutex_lock_shared(m, h, p);
+}
+
+#ifdef __linux__
+static inline void
+libtle_mutex_lock_shared(libtle_htm_futex_shared_mutex_t *m,
+                         libtle_htm_futex_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_futex_shared_mutex_lock_shared(m, h, p);
+}
+#endif
+
+// libtle_mutex_try_lock()
+
+static inline int
+libtle_mutex_try_lock(libtle_null_mutex_t *m,
+                      libtle_null_mutex_handle_t *h,
+                      libtle_null_mutex_profile_t *p = nullptr)
+{
+    return libtle_null_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_spin_mutex_t *m,
+                      libtle_spin_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_spin_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_spin_mutex_t *m,
+                      libtle_htm_spin_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_spin_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_null_shared_mutex_t *m,
+                      libtle_null_shared_mutex_handle_t *h,
+                      libtle_null_mutex_profile_t *p = nullptr)
+{
+    return libtle_null_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_spin_shared_mutex_t *m,
+                      libtle_spin_shared_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_rp_spin_shared_mutex_t *m,
+                      libtle_spin_shared_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_rp_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_pf_spin_shared_mutex_t *m,
+                      libtle_spin_shared_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_pf_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_spin_shared_mutex_t *m,
+                      libtle_htm_spin_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_rp_spin_shared_mutex_t *m,
+                      libtle_htm_spin_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_pf_spin_shared_mutex_t *m,
+                      libtle_htm_spin_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_adaptive_spin_mutex_t *m,
+                      libtle_htm_adaptive_spin_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_adaptive_spin_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                      libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_adaptive_spin_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_mcs_mutex_t *m,
+                      libtle_mcs_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_mcs_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_mcs_mutex_t *m,
+                      libtle_htm_mcs_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_mcs_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_cohort_mutex_t *m,
+                      libtle_htm_cohort_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_cohort_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_dist_shared_mutex_t *m,
+                      libtle_dist_shared_mutex_handle_t *h,
+                      libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_dist_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_dist_shared_mutex_t *m,
+                      libtle_htm_dist_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_dist_shared_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_cohort_shared_mutex_t *m,
+                      libtle_htm_cohort_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_cohort_shared_mutex_try_lock(m, h, p);
+}
+
+#ifdef __linux__
+static inline int
+libtle_mutex_try_lock(libtle_htm_futex_mutex_t *m,
+                      libtle_htm_futex_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_futex_mutex_try_lock(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_futex_shared_mutex_t *m,
+                      libtle_htm_futex_shared_mutex_handle_t *h,
+                      libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_futex_shared_mutex_try_lock(m, h, p);
+}
+#endif
+
+static inline int
+libtle_mutex_try_lock(libtle_htm_seqlock_t *m,
+                      libtle_htm_seqlock_handle_t *h,
+                      libtle_htm_seqlock_profile_t *p = nullptr)
+{
+    return libtle_htm_seqlock_try_lock(m, h, p);
+}
+
+// libtle_mutex_try_lock_shared()
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_null_shared_mutex_t *m,
+                             libtle_null_shared_mutex_handle_t *h,
+                             libtle_null_mutex_profile_t *p = nullptr)
+{
+    return libtle_null_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_spin_shared_mutex_t *m,
+                             libtle_spin_shared_mutex_handle_t *h,
+                             libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_rp_spin_shared_mutex_t *m,
+                             libtle_spin_shared_mutex_handle_t *h,
+                             libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_rp_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_pf_spin_shared_mutex_t *m,
+                             libtle_spin_shared_mutex_handle_t *h,
+                             libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_pf_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_spin_shared_mutex_t *m,
+                             libtle_htm_spin_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_rp_spin_shared_mutex_t *m,
+                             libtle_htm_spin_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_pf_spin_shared_mutex_t *m,
+                             libtle_htm_spin_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                             libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_adaptive_spin_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_dist_shared_mutex_t *m,
+                             libtle_dist_shared_mutex_handle_t *h,
+                             libtle_mutex_profile_t *p = nullptr)
+{
+    return libtle_dist_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_dist_shared_mutex_t *m,
+                             libtle_htm_dist_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_dist_shared_mutex_try_lock_shared(m, h, p);
+}
+
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_cohort_shared_mutex_t *m,
+                             libtle_htm_cohort_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_cohort_shared_mutex_try_lock_shared(m, h, p);
+}
+
+#ifdef __linux__
+static inline int
+libtle_mutex_try_lock_shared(libtle_htm_futex_shared_mutex_t *m,
+                             libtle_htm_futex_shared_mutex_handle_t *h,
+                             libtle_htm_mutex_profile_t *p = nullptr)
+{
+    return libtle_htm_futex_shared_mutex_try_lock_shared(m, h, p);
+}
+#endif
+
+// libtle_mutex_try_lock_until()
+
+static inline int
+libtle_mutex_try_lock_until(libtle_null_mutex_t *m,
+                            libtle_null_mutex_handle_t *h,
+                            libtle_null_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_null_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_spin_mutex_t *m,
+                            libtle_spin_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_spin_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_spin_mutex_t *m,
+                            libtle_htm_spin_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_spin_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_null_shared_mutex_t *m,
+                            libtle_null_shared_mutex_handle_t *h,
+                            libtle_null_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_null_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_spin_shared_mutex_t *m,
+                            libtle_spin_shared_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_rp_spin_shared_mutex_t *m,
+                            libtle_spin_shared_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_rp_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_pf_spin_shared_mutex_t *m,
+                            libtle_spin_shared_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_pf_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_spin_shared_mutex_t *m,
+                            libtle_htm_spin_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_rp_spin_shared_mutex_t *m,
+                            libtle_htm_spin_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_pf_spin_shared_mutex_t *m,
+                            libtle_htm_spin_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_adaptive_spin_mutex_t *m,
+                            libtle_htm_adaptive_spin_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_adaptive_spin_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                            libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_adaptive_spin_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_mcs_mutex_t *m,
+                            libtle_mcs_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_mcs_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_mcs_mutex_t *m,
+                            libtle_htm_mcs_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_mcs_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_cohort_mutex_t *m,
+                            libtle_htm_cohort_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_cohort_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_dist_shared_mutex_t *m,
+                            libtle_dist_shared_mutex_handle_t *h,
+                            libtle_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_dist_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_dist_shared_mutex_t *m,
+                            libtle_htm_dist_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_dist_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_cohort_shared_mutex_t *m,
+                            libtle_htm_cohort_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_cohort_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+
+#ifdef __linux__
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_futex_mutex_t *m,
+                            libtle_htm_futex_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_futex_mutex_try_lock_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_futex_shared_mutex_t *m,
+                            libtle_htm_futex_shared_mutex_handle_t *h,
+                            libtle_htm_mutex_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_futex_shared_mutex_try_lock_until(m, h, p, deadline);
+}
+#endif
+
+static inline int
+libtle_mutex_try_lock_until(libtle_htm_seqlock_t *m,
+                            libtle_htm_seqlock_handle_t *h,
+                            libtle_htm_seqlock_profile_t *p,
+                            uint64_t deadline)
+{
+    return libtle_htm_seqlock_try_lock_until(m, h, p, deadline);
+}
+
+// libtle_mutex_try_lock_shared_until()
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_null_shared_mutex_t *m,
+                                   libtle_null_shared_mutex_handle_t *h,
+                                   libtle_null_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_null_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_spin_shared_mutex_t *m,
+                                   libtle_spin_shared_mutex_handle_t *h,
+                                   libtle_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_rp_spin_shared_mutex_t *m,
+                                   libtle_spin_shared_mutex_handle_t *h,
+                                   libtle_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_rp_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_pf_spin_shared_mutex_t *m,
+                                   libtle_spin_shared_mutex_handle_t *h,
+                                   libtle_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_pf_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_spin_shared_mutex_t *m,
+                                   libtle_htm_spin_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_rp_spin_shared_mutex_t *m,
+                                   libtle_htm_spin_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_pf_spin_shared_mutex_t *m,
+                                   libtle_htm_spin_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                                   libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_adaptive_spin_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_dist_shared_mutex_t *m,
+                                   libtle_dist_shared_mutex_handle_t *h,
+                                   libtle_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_dist_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_dist_shared_mutex_t *m,
+                                   libtle_htm_dist_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_dist_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_cohort_shared_mutex_t *m,
+                                   libtle_htm_cohort_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_cohort_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+
+#ifdef __linux__
+static inline int
+libtle_mutex_try_lock_shared_until(libtle_htm_futex_shared_mutex_t *m,
+                                   libtle_htm_futex_shared_mutex_handle_t *h,
+                                   libtle_htm_mutex_profile_t *p,
+                                   uint64_t deadline)
+{
+    return libtle_htm_futex_shared_mutex_try_lock_shared_until(m, h, p, deadline);
+}
+#endif
+
+// libtle_mutex_unlock()
+
+static inline void
+libtle_mutex_unlock(libtle_null_mutex_t *m,
+                    libtle_null_mutex_handle_t *h,
+                    libtle_null_mutex_profile_t *p = nullptr)
+{
+    libtle_null_mutex_unlock(m, h, p);
+}
+
+static inline void
+libtle_mutex_unlock(libtle_spin_mutex_t *m,
+                    libtle_spin_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_spin_mutex_unlock(m, h, p);
+}
+
+static inline void
+libtle_mutex_unlock(libtle_htm_spin_mutex_t *m,
+                    libtle_htm_spin_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_spin_mutex_unlock(m, h, p);
+}
+
+static inline void
+libtle_mutex_unlock(libtle_null_shared_mutex_t *m,
+                    libtle_null_shared_mutex_handle_t *h,
+                    libtle_null_mutex_profile_t *p = nullptr)
+{
+    libtle_null_shared_mutex_unlock(m, h, p);
+}
 
+static inline void
+libtle_mutex_unlock(libtle_spin_shared_mutex_t *m,
+                    libtle_spin_shared_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_spin_shared_mutex_unlock(m, h, p);
+}
 
-#define libtle_mutex_unlock_shared(M,S) _Generic((M), \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock_shared, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock_shared, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared \
-)(M,S,NULL)
+static inline void
+libtle_mutex_unlock(libtle_rp_spin_shared_mutex_t *m,
+                    libtle_spin_shared_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_rp_spin_shared_mutex_unlock(m, h, p);
+}
 
+static inline void
+libtle_mutex_unlock(libtle_pf_spin_shared_mutex_t *m,
+                    libtle_spin_shared_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_pf_spin_shared_mutex_unlock(m, h, p);
+}
 
-#define libtle_mutex_unlock_shared_profiled(M,S,P) _Generic((M), \
-        libtle_null_shared_mutex_t*: libtle_null_shared_mutex_unlock_shared, \
-        libtle_spin_shared_mutex_t*: libtle_spin_shared_mutex_unlock_shared, \
-    libtle_htm_spin_shared_mutex_t*: libtle_htm_spin_shared_mutex_unlock_shared \
-)(M,S,P)
+static inline void
+libtle_mutex_unlock(libtle_htm_spin_shared_mutex_t *m,
+                    libtle_htm_spin_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_spin_shared_mutex_unlock(m, h, p);
+}
 
-#else
+static inline void
+libtle_mutex_unlock(libtle_htm_rp_spin_shared_mutex_t *m,
+                    libtle_htm_spin_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_rp_spin_shared_mutex_unlock(m, h, p);
+}
 
-// libtle_mutex_handle_init()
+static inline void
+libtle_mutex_unlock(libtle_htm_pf_spin_shared_mutex_t *m,
+                    libtle_htm_spin_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_pf_spin_shared_mutex_unlock(m, h, p);
+}
 
 static inline void
-libtle_mutex_handle_init(libtle_null_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_htm_adaptive_spin_mutex_t *m,
+                    libtle_htm_adaptive_spin_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_null_mutex_handle_init(h);
+    libtle_htm_adaptive_spin_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_handle_init(libtle_spin_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                    libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_mutex_handle_init(h);
+    libtle_htm_adaptive_spin_shared_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_handle_init(libtle_htm_spin_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_mcs_mutex_t *m,
+                    libtle_mcs_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_mutex_handle_init(h);
+    libtle_mcs_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_handle_init(libtle_null_shared_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_htm_mcs_mutex_t *m,
+                    libtle_htm_mcs_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_null_shared_mutex_handle_init(h);
+    libtle_htm_mcs_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_handle_init(libtle_spin_shared_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_htm_cohort_mutex_t *m,
+                    libtle_htm_cohort_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_shared_mutex_handle_init(h);
+    libtle_htm_cohort_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_handle_init(libtle_htm_spin_shared_mutex_handle_t *h)
+libtle_mutex_unlock(libtle_dist_shared_mutex_t *m,
+                    libtle_dist_shared_mutex_handle_t *h,
+                    libtle_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_shared_mutex_handle_init(h);
+    libtle_dist_shared_mutex_unlock(m, h, p);
 }
 
-// libtle_mutex_init()
+static inline void
+libtle_mutex_unlock(libtle_htm_dist_shared_mutex_t *m,
+                    libtle_htm_dist_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_dist_shared_mutex_unlock(m, h, p);
+}
 
 static inline void
-libtle_mutex_init(libtle_null_mutex_t *m)
+libtle_mutex_unlock(libtle_htm_cohort_shared_mutex_t *m,
+                    libtle_htm_cohort_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_null_mutex_init(m);
+    libtle_htm_cohort_shared_mutex_unlock(m, h, p);
 }
 
+#ifdef __linux__
 static inline void
-libtle_mutex_init(libtle_spin_mutex_t *m)
+libtle_mutex_unlock(libtle_htm_futex_mutex_t *m,
+                    libtle_htm_futex_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_mutex_init(m);
+    libtle_htm_futex_mutex_unlock(m, h, p);
 }
 
 static inline void
-libtle_mutex_init(libtle_htm_spin_mutex_t *m)
+libtle_mutex_unlock(libtle_htm_futex_shared_mutex_t *m,
+                    libtle_htm_futex_shared_mutex_handle_t *h,
+                    libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_mutex_init(m);
+    libtle_htm_futex_shared_mutex_unlock(m, h, p);
 }
+#endif
 
 static inline void
-libtle_mutex_init(libtle_null_shared_mutex_t *m)
+libtle_mutex_unlock(libtle_htm_seqlock_t *m,
+                    libtle_htm_seqlock_handle_t *h,
+                    libtle_htm_seqlock_profile_t *p = nullptr)
 {
-    libtle_null_shared_mutex_init(m);
+    libtle_htm_seqlock_unlock(m, h, p);
 }
 
+// libtle_mutex_unlock_shared()
+
 static inline void
-libtle_mutex_init(libtle_spin_shared_mutex_t *m)
+libtle_mutex_unlock_shared(libtle_null_shared_mutex_t *m,
+                           libtle_null_shared_mutex_handle_t *h,
+                           libtle_null_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_shared_mutex_init(m);
+    libtle_null_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_init(libtle_htm_spin_shared_mutex_t *m)
+libtle_mutex_unlock_shared(libtle_spin_shared_mutex_t *m,
+                           libtle_spin_shared_mutex_handle_t *h,
+                           libtle_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_shared_mutex_init(m);
+    libtle_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
-// libtle_mutex_lock()
+static inline void
+libtle_mutex_unlock_shared(libtle_rp_spin_shared_mutex_t *m,
+                           libtle_spin_shared_mutex_handle_t *h,
+                           libtle_mutex_profile_t *p = nullptr)
+{
+    libtle_rp_spin_shared_mutex_unlock_shared(m, h, p);
+}
 
 static inline void
-libtle_mutex_lock(libtle_null_mutex_t *m,
-                  libtle_null_mutex_handle_t *h,
-                  libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_pf_spin_shared_mutex_t *m,
+                           libtle_spin_shared_mutex_handle_t *h,
+                           libtle_mutex_profile_t *p = nullptr)
 {
-    libtle_null_mutex_lock(m, h, p);
+    libtle_pf_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_lock(libtle_spin_mutex_t *m,
-                  libtle_spin_mutex_handle_t *h,
-                  libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_mutex_lock(m, h, p);
+    libtle_htm_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_lock(libtle_htm_spin_mutex_t *m,
-                  libtle_htm_spin_mutex_handle_t *h,
-                  libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_rp_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_mutex_lock(m, h, p);
+    libtle_htm_rp_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_lock(libtle_null_shared_mutex_t *m,
-                  libtle_null_shared_mutex_handle_t *h,
-                  libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_pf_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_null_shared_mutex_lock(m, h, p);
+    libtle_htm_pf_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_lock(libtle_spin_shared_mutex_t *m,
-                  libtle_spin_shared_mutex_handle_t *h,
-                  libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_adaptive_spin_shared_mutex_t *m,
+                           libtle_htm_adaptive_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_shared_mutex_lock(m, h, p);
+    libtle_htm_adaptive_spin_shared_mutex_unlock_shared(m, h, p);
 }
 
 static inline void
-libtle_mutex_lock(libtle_htm_spin_shared_mutex_t *m,
-                  libtle_htm_spin_shared_mutex_handle_t *h,
-                  libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_dist_shared_mutex_t *m,
+                           libtle_dist_shared_mutex_handle_t *h,
+                           libtle_mutex_profile_t *p = nullptr)
 {
-    libtle_htm_spin_shared_mutex_lock(m, h, p);
+    libtle_dist_shared_mutex_unlock_shared(m, h, p);
 }
 
-// libtle_mutex_lock_shared()
+static inline void
+libtle_mutex_unlock_shared(libtle_htm_dist_shared_mutex_t *m,
+                           libtle_htm_dist_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
+{
+    libtle_htm_dist_shared_mutex_unlock_shared(m, h, p);
+}
 
 static inline void
-libtle_mutex_lock_shared(libtle_null_shared_mutex_t *m,
-                         libtle_null_shared_mutex_handle_t *h,
-                         libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_cohort_shared_mutex_t *m,
+                           libtle_htm_cohort_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_null_shared_mutex_lock_shared(m, h, p);
+    libtle_htm_cohort_shared_mutex_unlock_shared(m, h, p);
 }
 
+#ifdef __linux__
 static inline void
-libtle_mutex_lock_shared(libtle_spin_shared_mutex_t *m,
-                         libtle_spin_shared_mutex_handle_t *h,
-                         libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared(libtle_htm_futex_shared_mutex_t *m,
+                           libtle_htm_futex_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p = nullptr)
 {
-    libtle_spin_shared_mutex_lock_shared(m, h, p);
+    libtle_htm_futex_shared_mutex_unlock_shared(m, h, p);
 }
+#endif
+
+// libtle_mutex_lock_site()
 
 static inline void
-libtle_mutex_lock_shared(libtle_htm_spin_shared_mutex_t *m,
-                         libtle_htm_spin_shared_mutex_handle_t *h,
-                         libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_site(libtle_htm_spin_mutex_t *m,
+                       libtle_htm_spin_mutex_handle_t *h,
+                       libtle_htm_mutex_profile_t *p,
+                       libtle_htm_site_t *site)
 {
-    libtle_htm_spin_shared_mutex_lock_shared(m, h, p);
+    libtle_htm_spin_mutex_lock_site(m, h, p, site);
 }
 
-// libtle_mutex_unlock()
+static inline void
+libtle_mutex_lock_site(libtle_htm_spin_shared_mutex_t *m,
+                       libtle_htm_spin_shared_mutex_handle_t *h,
+                       libtle_htm_mutex_profile_t *p,
+                       libtle_htm_site_t *site)
+{
+    libtle_htm_spin_shared_mutex_lock_site(m, h, p, site);
+}
 
 static inline void
-libtle_mutex_unlock(libtle_null_mutex_t *m,
-                    libtle_null_mutex_handle_t *h,
-                    libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                       libtle_htm_spin_shared_mutex_handle_t *h,
+                       libtle_htm_mutex_profile_t *p,
+                       libtle_htm_site_t *site)
 {
-    libtle_null_mutex_unlock(m, h, p);
+    libtle_htm_rp_spin_shared_mutex_lock_site(m, h, p, site);
 }
 
 static inline void
-libtle_mutex_unlock(libtle_spin_mutex_t *m,
-                    libtle_spin_mutex_handle_t *h,
-                    libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                       libtle_htm_spin_shared_mutex_handle_t *h,
+                       libtle_htm_mutex_profile_t *p,
+                       libtle_htm_site_t *site)
 {
-    libtle_spin_mutex_unlock(m, h, p);
+    libtle_htm_pf_spin_shared_mutex_lock_site(m, h, p, site);
 }
 
+// libtle_mutex_lock_shared_site()
+
 static inline void
-libtle_mutex_unlock(libtle_htm_spin_mutex_t *m,
-                    libtle_htm_spin_mutex_handle_t *h,
-                    libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_shared_site(libtle_htm_spin_shared_mutex_t *m,
+                              libtle_htm_spin_shared_mutex_handle_t *h,
+                              libtle_htm_mutex_profile_t *p,
+                              libtle_htm_site_t *site)
 {
-    libtle_htm_spin_mutex_unlock(m, h, p);
+    libtle_htm_spin_shared_mutex_lock_shared_site(m, h, p, site);
 }
 
 static inline void
-libtle_mutex_unlock(libtle_null_shared_mutex_t *m,
-                    libtle_null_shared_mutex_handle_t *h,
-                    libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_shared_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                              libtle_htm_spin_shared_mutex_handle_t *h,
+                              libtle_htm_mutex_profile_t *p,
+                              libtle_htm_site_t *site)
 {
-    libtle_null_shared_mutex_unlock(m, h, p);
+    libtle_htm_rp_spin_shared_mutex_lock_shared_site(m, h, p, site);
 }
 
 static inline void
-libtle_mutex_unlock(libtle_spin_shared_mutex_t *m,
-                    libtle_spin_shared_mutex_handle_t *h,
-                    libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_lock_shared_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                              libtle_htm_spin_shared_mutex_handle_t *h,
+                              libtle_htm_mutex_profile_t *p,
+                              libtle_htm_site_t *site)
 {
-    libtle_spin_shared_mutex_unlock(m, h, p);
+    libtle_htm_pf_spin_shared_mutex_lock_shared_site(m, h, p, site);
+}
+
+// libtle_mutex_try_lock_site()
+
+static inline int
+libtle_mutex_try_lock_site(libtle_htm_spin_mutex_t *m,
+                           libtle_htm_spin_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p,
+                           libtle_htm_site_t *site)
+{
+    return libtle_htm_spin_mutex_try_lock_site(m, h, p, site);
+}
+
+static inline int
+libtle_mutex_try_lock_site(libtle_htm_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p,
+                           libtle_htm_site_t *site)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_site(m, h, p, site);
+}
+
+static inline int
+libtle_mutex_try_lock_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p,
+                           libtle_htm_site_t *site)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_site(m, h, p, site);
+}
+
+static inline int
+libtle_mutex_try_lock_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                           libtle_htm_spin_shared_mutex_handle_t *h,
+                           libtle_htm_mutex_profile_t *p,
+                           libtle_htm_site_t *site)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_site(m, h, p, site);
+}
+
+// libtle_mutex_try_lock_shared_site()
+
+static inline int
+libtle_mutex_try_lock_shared_site(libtle_htm_spin_shared_mutex_t *m,
+                                  libtle_htm_spin_shared_mutex_handle_t *h,
+                                  libtle_htm_mutex_profile_t *p,
+                                  libtle_htm_site_t *site)
+{
+    return libtle_htm_spin_shared_mutex_try_lock_shared_site(m, h, p, site);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                                  libtle_htm_spin_shared_mutex_handle_t *h,
+                                  libtle_htm_mutex_profile_t *p,
+                                  libtle_htm_site_t *site)
+{
+    return libtle_htm_rp_spin_shared_mutex_try_lock_shared_site(m, h, p, site);
+}
+
+static inline int
+libtle_mutex_try_lock_shared_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                                  libtle_htm_spin_shared_mutex_handle_t *h,
+                                  libtle_htm_mutex_profile_t *p,
+                                  libtle_htm_site_t *site)
+{
+    return libtle_htm_pf_spin_shared_mutex_try_lock_shared_site(m, h, p, site);
+}
+
+// libtle_mutex_unlock_site()
+
+static inline void
+libtle_mutex_unlock_site(libtle_htm_spin_mutex_t *m,
+                         libtle_htm_spin_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p,
+                         libtle_htm_site_t *site)
+{
+    libtle_htm_spin_mutex_unlock_site(m, h, p, site);
 }
 
 static inline void
-libtle_mutex_unlock(libtle_htm_spin_shared_mutex_t *m,
-                    libtle_htm_spin_shared_mutex_handle_t *h,
-                    libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_site(libtle_htm_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p,
+                         libtle_htm_site_t *site)
 {
-    libtle_htm_spin_shared_mutex_unlock(m, h, p);
+    libtle_htm_spin_shared_mutex_unlock_site(m, h, p, site);
 }
 
-// libtle_mutex_unlock_shared()
+static inline void
+libtle_mutex_unlock_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p,
+                         libtle_htm_site_t *site)
+{
+    libtle_htm_rp_spin_shared_mutex_unlock_site(m, h, p, site);
+}
 
 static inline void
-libtle_mutex_unlock_shared(libtle_null_shared_mutex_t *m,
-                           libtle_null_shared_mutex_handle_t *h,
-                           libtle_null_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                         libtle_htm_spin_shared_mutex_handle_t *h,
+                         libtle_htm_mutex_profile_t *p,
+                         libtle_htm_site_t *site)
 {
-    libtle_null_shared_mutex_unlock_shared(m, h, p);
+    libtle_htm_pf_spin_shared_mutex_unlock_site(m, h, p, site);
 }
 
+// libtle_mutex_unlock_shared_site()
+
 static inline void
-libtle_mutex_unlock_shared(libtle_spin_shared_mutex_t *m,
-                           libtle_spin_shared_mutex_handle_t *h,
-                           libtle_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared_site(libtle_htm_spin_shared_mutex_t *m,
+                                libtle_htm_spin_shared_mutex_handle_t *h,
+                                libtle_htm_mutex_profile_t *p,
+                                libtle_htm_site_t *site)
 {
-    libtle_spin_shared_mutex_unlock_shared(m, h, p);
+    libtle_htm_spin_shared_mutex_unlock_shared_site(m, h, p, site);
 }
 
 static inline void
-libtle_mutex_unlock_shared(libtle_htm_spin_shared_mutex_t *m,
-                           libtle_htm_spin_shared_mutex_handle_t *h,
-                           libtle_htm_mutex_profile_t *p = nullptr)
+libtle_mutex_unlock_shared_site(libtle_htm_rp_spin_shared_mutex_t *m,
+                                libtle_htm_spin_shared_mutex_handle_t *h,
+                                libtle_htm_mutex_profile_t *p,
+                                libtle_htm_site_t *site)
 {
-    libtle_htm_spin_shared_mutex_unlock_shared(m, h, p);
+    libtle_htm_rp_spin_shared_mutex_unlock_shared_site(m, h, p, site);
+}
+
+static inline void
+libtle_mutex_unlock_shared_site(libtle_htm_pf_spin_shared_mutex_t *m,
+                                libtle_htm_spin_shared_mutex_handle_t *h,
+                                libtle_htm_mutex_profile_t *p,
+                                libtle_htm_site_t *site)
+{
+    libtle_htm_pf_spin_shared_mutex_unlock_shared_site(m, h, p, site);
 }
 
 #endif
@@ -8,15 +8,141 @@
 
 #include <cassert>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <system_error>
 
 #include "mutex.h"
+#include "cycle_clock.hpp"
+#include "elision_policy.hpp"
 #include "lock.hpp"
 #include "profile.hpp"
 
 
+/* Mutexes that a thread can hold at once through their lock() methods */
+#ifndef LIBTLE_HANDLE_CACHE_SIZE
+#define LIBTLE_HANDLE_CACHE_SIZE (16)
+#endif
+
+
 namespace tle{ namespace detail{
 
+    typedef libtle_htm_site_t htm_site_type;
+
+    //
+    // Deadline of the timed lock operations, as a value of the CPU counter
+    // (see libtle_cycles()), so that the waits do not read a slower clock. A
+    // timeout that is not positive gives one attempt, and long timeouts are
+    // capped to 2^62 ticks. The first call calibrates the counter (see
+    // cycle_clock::calibrate()).
+    //
+    template<typename _Rep, typename _Period>
+    inline uint64_t
+    cycles_deadline(const std::chrono::duration<_Rep,_Period>& __d) noexcept {
+        uint64_t now = libtle_cycles();
+        double ticks = std::chrono::duration<double>(__d).count() *
+            static_cast<double>(cycle_clock_calibration::get().frequency);
+        if (!(ticks > 0.0)) {
+            return now;
+        }
+        const double cap = static_cast<double>(uint64_t(1) << 62);
+        return now + static_cast<uint64_t>(ticks < cap ? ticks : cap);
+    }
+
+    template<typename _Clock, typename _Duration>
+    inline uint64_t
+    cycles_deadline(const std::chrono::time_point<_Clock,_Duration>& __t) {
+        return cycles_deadline(__t - _Clock::now());
+    }
+
+    //
+    // Per-thread cache of the C handles of the mutexes that are locked
+    // through their own lock() methods rather than a handle object, keyed by
+    // the address of the mutex. A locking thread takes an entry, and gives it
+    // back when it unlocks, so the cache only holds the mutexes that the
+    // thread holds at once. The cache is static thread-local storage, so
+    // the lock path never allocates. A handle is initialized again
+    // whenever its entry is taken for another mutex than the last one, so
+    // the state that some handles learn (e.g., the adaptive retry budgets)
+    // does not carry over between mutexes.
+    //
+    template<typename Mutex, typename Handle>
+    class handle_cache {
+        struct _Entry {
+            Mutex*  key;
+            Mutex*  last;
+            Handle  handle;
+        };
+
+        static _Entry* _S_entries() noexcept {
+            static thread_local _Entry entries[LIBTLE_HANDLE_CACHE_SIZE];
+            return entries;
+        }
+
+        static std::size_t _S_slot(const Mutex* __m) noexcept {
+            return (reinterpret_cast<std::uintptr_t>(__m) >> 6) %
+                LIBTLE_HANDLE_CACHE_SIZE;
+        }
+
+    public:
+        //
+        // Take an entry for __m; throws std::system_error when the thread
+        // already holds LIBTLE_HANDLE_CACHE_SIZE mutexes of this type
+        //
+        static Handle* acquire(Mutex* __m) {
+            _Entry* entries = _S_entries();
+            std::size_t slot = _S_slot(__m);
+            for (std::size_t i = 0; i < LIBTLE_HANDLE_CACHE_SIZE; ++i) {
+                _Entry& e = entries[(slot + i) % LIBTLE_HANDLE_CACHE_SIZE];
+                if (!e.key) {
+                    if (e.last != __m) {
+                        libtle_mutex_handle_init(&e.handle);
+                        e.last = __m;
+                    }
+                    e.key = __m;
+                    return &e.handle;
+                }
+            }
+            throw std::system_error(
+                std::make_error_code(std::errc::resource_unavailable_try_again),
+                "LIBTLE_HANDLE_CACHE_SIZE mutexes held");
+        }
+
+        //
+        // The handle of the entry taken for __m, which the thread must hold;
+        // nullptr (after an assertion failure) when it does not
+        //
+        static Handle* find(const Mutex* __m) noexcept {
+            _Entry* entries = _S_entries();
+            std::size_t slot = _S_slot(__m);
+            for (std::size_t i = 0; i < LIBTLE_HANDLE_CACHE_SIZE; ++i) {
+                _Entry& e = entries[(slot + i) % LIBTLE_HANDLE_CACHE_SIZE];
+                if (e.key == __m) {
+                    return &e.handle;
+                }
+            }
+            assert(!"unlock of a mutex that the thread does not hold");
+            return nullptr;
+        }
+
+        //
+        // Give back the entry of __h, after the unlock or a failed attempt;
+        // returns __locked
+        //
+        static bool release(Handle* __h, bool __locked = false) noexcept {
+            if (!__locked) {
+                reinterpret_cast<_Entry*>(reinterpret_cast<char*>(__h) -
+                    offsetof(_Entry, handle))->key = nullptr;
+            }
+            return __locked;
+        }
+    };
+
+    // see scoped_elision.hpp
+    struct lock_all_access;
+
     //
     // Generic wrapper of a C mutex type into a C++ mutex class
     //
@@ -56,10 +182,61 @@ namespace tle{ namespace detail{
                                             _M_stats->_M_recast());
             }
 
+            //
+            // Variants for the critical section identified by a call site
+            // token (see LIBTLE_HTM_SITE_DEFINE), which must be the same for
+            // the lock and the unlock.
+            //
+            void lock(htm_site_type* __site) {
+                detail::libtle_mutex_lock_site(_M_mutex, &_M_handle,
+                                               _M_stats->_M_recast(), __site);
+            }
+
+            void unlock(htm_site_type* __site) {
+                detail::libtle_mutex_unlock_site(_M_mutex, &_M_handle,
+                                                 _M_stats->_M_recast(), __site);
+            }
+
+
+            //
+            // Same as lock(), but returns false instead of waiting for a busy
+            // mutex; an elided try_lock() never waits for the fallback lock.
+            // The timed variants retry until the deadline, which is checked
+            // against the CPU counter (see tle::cycle_clock).
+            //
+            bool try_lock() {
+                return detail::libtle_mutex_try_lock(_M_mutex, &_M_handle,
+                                                     _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            bool try_lock(htm_site_type* __site) {
+                return detail::libtle_mutex_try_lock_site(_M_mutex, &_M_handle,
+                                                          _M_stats->_M_recast(),
+                                                          __site);
+            }
+
         private:
+            Handle* _M_c_handle() noexcept {
+                return &_M_handle;
+            }
+
             Mutex*          _M_mutex;
             profile_type*   _M_stats;
             Handle          _M_handle;
+
+            friend lock_all_access;
         };
 
     public:
@@ -74,7 +251,46 @@ namespace tle{ namespace detail{
             detail::libtle_mutex_init(&_M_impl);
         }
 
+        // expose the lock/unlock interface to use the mutex without a handle;
+        // the handles come from a per-thread cache (see handle_cache), so the
+        // mutex works with std::lock_guard, std::unique_lock and std::lock()
+
+        void lock(profile_type* __s = nullptr) {
+            detail::libtle_mutex_lock(&_M_impl, _Cache::acquire(&_M_impl),
+                                      __s->_M_recast());
+        }
+
+        void unlock(profile_type* __s = nullptr) {
+            Handle* h = _Cache::find(&_M_impl);
+            detail::libtle_mutex_unlock(&_M_impl, h, __s->_M_recast());
+            _Cache::release(h);
+        }
+
+        bool try_lock(profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h,
+                detail::libtle_mutex_try_lock(&_M_impl, h, __s->_M_recast()));
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d,
+                          profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_until(&_M_impl,
+                h, __s->_M_recast(), detail::cycles_deadline(__d)));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                            profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_until(&_M_impl,
+                h, __s->_M_recast(), detail::cycles_deadline(__t)));
+        }
+
     private:
+        typedef handle_cache<Mutex,Handle> _Cache;
+
         Mutex _M_impl;
         friend handle_type;
     };
@@ -118,9 +334,56 @@ namespace tle{ namespace detail{
                                             _M_stats->_M_recast());
             }
 
+            // call site variants
+            void lock(htm_site_type* __site) {
+                detail::libtle_mutex_lock_site(_M_mutex, nullptr,
+                                               _M_stats->_M_recast(), __site);
+            }
+
+            void unlock(htm_site_type* __site) {
+                detail::libtle_mutex_unlock_site(_M_mutex, nullptr,
+                                                 _M_stats->_M_recast(), __site);
+            }
+
+
+            //
+            // Same as lock(), but returns false instead of waiting for a busy
+            // mutex; an elided try_lock() never waits for the fallback lock.
+            // The timed variants retry until the deadline, which is checked
+            // against the CPU counter (see tle::cycle_clock).
+            //
+            bool try_lock() {
+                return detail::libtle_mutex_try_lock(_M_mutex, nullptr,
+                                                     _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            bool try_lock(htm_site_type* __site) {
+                return detail::libtle_mutex_try_lock_site(_M_mutex, nullptr,
+                                                          _M_stats->_M_recast(),
+                                                          __site);
+            }
+
         private:
+            void* _M_c_handle() noexcept {
+                return nullptr;
+            }
+
             Mutex*          _M_mutex;
             profile_type*   _M_stats;
+
+            friend lock_all_access;
         };
 
     public:
@@ -145,6 +408,25 @@ namespace tle{ namespace detail{
             detail::libtle_mutex_unlock(&_M_impl, nullptr, __s->_M_recast());
         }
 
+        bool try_lock(profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock(&_M_impl, nullptr,
+                                                 __s->_M_recast());
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d,
+                          profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__d));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                            profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__t));
+        }
+
     private:
         Mutex _M_impl;
         friend handle_type;
@@ -201,6 +483,82 @@ namespace tle{ namespace detail{
                                                    _M_stats->_M_recast());
             }
 
+            // call site variants
+            void lock(htm_site_type* __site) {
+                detail::libtle_mutex_lock_site(_M_mutex, &_M_handle,
+                                               _M_stats->_M_recast(), __site);
+            }
+
+            void unlock(htm_site_type* __site) {
+                detail::libtle_mutex_unlock_site(_M_mutex, &_M_handle,
+                                                 _M_stats->_M_recast(), __site);
+            }
+
+            void lock_shared(htm_site_type* __site) {
+                detail::libtle_mutex_lock_shared_site(_M_mutex, &_M_handle,
+                                                      _M_stats->_M_recast(),
+                                                      __site);
+            }
+
+            void unlock_shared(htm_site_type* __site) {
+                detail::libtle_mutex_unlock_shared_site(_M_mutex, &_M_handle,
+                                                        _M_stats->_M_recast(),
+                                                        __site);
+            }
+
+
+            //
+            // Same as lock(), but returns false instead of waiting for a busy
+            // mutex; an elided try_lock() never waits for the fallback lock.
+            // The timed variants retry until the deadline, which is checked
+            // against the CPU counter (see tle::cycle_clock).
+            //
+            bool try_lock() {
+                return detail::libtle_mutex_try_lock(_M_mutex, &_M_handle,
+                                                     _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            bool try_lock_shared() {
+                return detail::libtle_mutex_try_lock_shared(_M_mutex, &_M_handle,
+                                                            _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_shared_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_shared_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_shared_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_shared_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            bool try_lock(htm_site_type* __site) {
+                return detail::libtle_mutex_try_lock_site(_M_mutex, &_M_handle,
+                                                          _M_stats->_M_recast(),
+                                                          __site);
+            }
+
+            bool try_lock_shared(htm_site_type* __site) {
+                return detail::libtle_mutex_try_lock_shared_site(_M_mutex, &_M_handle,
+                                                                 _M_stats->_M_recast(),
+                                                                 __site);
+            }
+
         private:
             Mutex*          _M_mutex;
             profile_type*   _M_stats;
@@ -219,7 +577,80 @@ namespace tle{ namespace detail{
             detail::libtle_mutex_init(&_M_impl);
         }
 
+        // expose the lock/unlock interface to use the mutex without a handle;
+        // the handles come from a per-thread cache (see handle_cache), so the
+        // mutex works with std::lock_guard, std::unique_lock, std::shared_lock
+        // and std::lock()
+
+        void lock(profile_type* __s = nullptr) {
+            detail::libtle_mutex_lock(&_M_impl, _Cache::acquire(&_M_impl),
+                                      __s->_M_recast());
+        }
+
+        void unlock(profile_type* __s = nullptr) {
+            Handle* h = _Cache::find(&_M_impl);
+            detail::libtle_mutex_unlock(&_M_impl, h, __s->_M_recast());
+            _Cache::release(h);
+        }
+
+        bool try_lock(profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h,
+                detail::libtle_mutex_try_lock(&_M_impl, h, __s->_M_recast()));
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d,
+                          profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_until(&_M_impl,
+                h, __s->_M_recast(), detail::cycles_deadline(__d)));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                            profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_until(&_M_impl,
+                h, __s->_M_recast(), detail::cycles_deadline(__t)));
+        }
+
+        void lock_shared(profile_type* __s = nullptr) {
+            detail::libtle_mutex_lock_shared(&_M_impl, _Cache::acquire(&_M_impl),
+                                             __s->_M_recast());
+        }
+
+        void unlock_shared(profile_type* __s = nullptr) {
+            Handle* h = _Cache::find(&_M_impl);
+            detail::libtle_mutex_unlock_shared(&_M_impl, h, __s->_M_recast());
+            _Cache::release(h);
+        }
+
+        bool try_lock_shared(profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_shared(&_M_impl,
+                h, __s->_M_recast()));
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_shared_for(const std::chrono::duration<_Rep,_Period>& __d,
+                                 profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_shared_until(
+                &_M_impl, h, __s->_M_recast(), detail::cycles_deadline(__d)));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                                   profile_type* __s = nullptr) {
+            Handle* h = _Cache::acquire(&_M_impl);
+            return _Cache::release(h, detail::libtle_mutex_try_lock_shared_until(
+                &_M_impl, h, __s->_M_recast(), detail::cycles_deadline(__t)));
+        }
+
     private:
+        typedef handle_cache<Mutex,Handle> _Cache;
+
         Mutex _M_impl;
         friend handle_type;
     };
@@ -274,6 +705,47 @@ namespace tle{ namespace detail{
                                                    _M_stats->_M_recast());
             }
 
+
+            //
+            // Same as lock(), but returns false instead of waiting for a busy
+            // mutex; an elided try_lock() never waits for the fallback lock.
+            // The timed variants retry until the deadline, which is checked
+            // against the CPU counter (see tle::cycle_clock).
+            //
+            bool try_lock() {
+                return detail::libtle_mutex_try_lock(_M_mutex, nullptr,
+                                                     _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            bool try_lock_shared() {
+                return detail::libtle_mutex_try_lock_shared(_M_mutex, nullptr,
+                                                            _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_shared_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_shared_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_shared_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_shared_until(_M_mutex, nullptr,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
         private:
             Mutex*          _M_mutex;
             profile_type*   _M_stats;
@@ -311,6 +783,155 @@ namespace tle{ namespace detail{
                                                __s->_M_recast());
         }
 
+        bool try_lock(profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock(&_M_impl, nullptr,
+                                                 __s->_M_recast());
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d,
+                          profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__d));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                            profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__t));
+        }
+
+        bool try_lock_shared(profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_shared(&_M_impl, nullptr,
+                                                        __s->_M_recast());
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_shared_for(const std::chrono::duration<_Rep,_Period>& __d,
+                                 profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_shared_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__d));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<_Clock,_Duration>& __t,
+                                   profile_type* __s = nullptr) {
+            return detail::libtle_mutex_try_lock_shared_until(&_M_impl, nullptr,
+                __s->_M_recast(), detail::cycles_deadline(__t));
+        }
+
+    private:
+        Mutex _M_impl;
+        friend handle_type;
+    };
+
+
+    //
+    // Wrapper of a C sequence lock: the writers lock and unlock it like a
+    // mutex, and the readers validate their reads through the handle
+    //
+    template<typename Mutex, typename Handle, typename Profile>
+    class seqlock_wrapper {
+    public:
+        typedef Profile profile_type;
+
+        //
+        // This is a local handle for a sequence lock; it provides lock() and
+        // unlock() for the writers, and read_begin(), read_retry() and read()
+        // for the readers.
+        //
+        class handle_type {
+        public:
+            typedef seqlock_wrapper<Mutex,Handle,Profile> mutex_type;
+            typedef typename mutex_type::profile_type     profile_type;
+
+            handle_type(const handle_type&) = delete;
+            handle_type& operator=(const handle_type&) = delete;
+
+            handle_type(handle_type&&) = delete;
+            handle_type& operator=(handle_type&&) = delete;
+
+            handle_type(mutex_type& __m, profile_type* __s = nullptr) noexcept
+            : _M_mutex(std::addressof(__m._M_impl)), _M_stats(__s), _M_handle()
+            {
+                libtle_mutex_handle_init(&_M_handle);
+            }
+
+            void lock() {
+                detail::libtle_mutex_lock(_M_mutex, &_M_handle,
+                                          _M_stats->_M_recast());
+            }
+
+            void unlock() {
+                detail::libtle_mutex_unlock(_M_mutex, &_M_handle,
+                                            _M_stats->_M_recast());
+            }
+
+            bool try_lock() {
+                return detail::libtle_mutex_try_lock(_M_mutex, &_M_handle,
+                                                     _M_stats->_M_recast());
+            }
+
+            template<typename _Rep, typename _Period>
+            bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__d));
+            }
+
+            template<typename _Clock, typename _Duration>
+            bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+                return detail::libtle_mutex_try_lock_until(_M_mutex, &_M_handle,
+                    _M_stats->_M_recast(), detail::cycles_deadline(__t));
+            }
+
+            //
+            // Start a read, and validate it with the returned sequence
+            // number; read_retry() is true when the read must start again.
+            //
+            unsigned read_begin() {
+                return detail::libtle_htm_seqlock_read_begin(_M_mutex, &_M_handle,
+                                                             _M_stats->_M_recast());
+            }
+
+            bool read_retry(unsigned __seq) {
+                return detail::libtle_htm_seqlock_read_retry(_M_mutex, &_M_handle,
+                                                             _M_stats->_M_recast(),
+                                                             __seq);
+            }
+
+            //
+            // Call __f() until it runs without a concurrent write; __f() may
+            // see torn data, so it should only copy it out.
+            //
+            template<typename Function>
+            void read(Function __f) {
+                unsigned seq;
+                do {
+                    seq = read_begin();
+                    __f();
+                }
+                while (read_retry(seq));
+            }
+
+        private:
+            Mutex*          _M_mutex;
+            profile_type*   _M_stats;
+            Handle          _M_handle;
+        };
+
+    public:
+        seqlock_wrapper(const seqlock_wrapper&) = delete;
+        seqlock_wrapper& operator=(const seqlock_wrapper&) = delete;
+
+        seqlock_wrapper(seqlock_wrapper&&) = delete;
+        seqlock_wrapper& operator=(seqlock_wrapper&&) = delete;
+
+        seqlock_wrapper() noexcept
+        {
+            detail::libtle_mutex_init(&_M_impl);
+        }
+
     private:
         Mutex _M_impl;
         friend handle_type;
@@ -321,6 +942,11 @@ namespace tle{ namespace detail{
 
 namespace tle {
 
+    //
+    // Call site token for the per critical section elision predictor
+    //
+    using htm_site = detail::htm_site_type;
+
     //
     // Null mutex
     //
@@ -360,6 +986,22 @@ namespace tle {
         void, htm_mutex_profile>;
 #endif
 
+    //
+    // HTM-based mutex with a spinlock as fallback, whose elision attempts
+    // follow a compile-time policy (see tle::elision_policy)
+    //
+#ifndef NDEBUG
+    template<typename Policy = default_elision_policy>
+    using basic_htm_spin_mutex =
+        detail::mutex_wrapper<detail::htm_spin_mutex_policy_t<Policy>,
+        detail::libtle_htm_spin_mutex_handle_t, htm_mutex_profile>;
+#else
+    template<typename Policy = default_elision_policy>
+    using basic_htm_spin_mutex =
+        detail::mutex_wrapper<detail::htm_spin_mutex_policy_t<Policy>,
+        void, htm_mutex_profile>;
+#endif
+
     //
     // Null reader/writer mutex
     //
@@ -393,15 +1035,262 @@ namespace tle {
         detail::shared_mutex_wrapper<detail::libtle_htm_spin_shared_mutex_t,
         detail::libtle_htm_spin_shared_mutex_handle_t, htm_mutex_profile>;
 
+    //
+    // HTM-based mutex with a reader/writer spinlock as fallback, whose
+    // writers and readers follow compile-time elision policies
+    //
+    template<typename WritePolicy = default_elision_policy,
+             typename ReadPolicy = WritePolicy>
+    using basic_htm_spin_shared_mutex =
+        detail::shared_mutex_wrapper<
+        detail::htm_spin_shared_mutex_policy_t<WritePolicy,ReadPolicy>,
+        detail::libtle_htm_spin_shared_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // Reader/writer spinlocks with other fairness policies: the
+    // reader-preferring one lets the readers in while a writer waits (which
+    // may starve the writers), the phase-fair one alternates between the
+    // writers and the batches of readers that arrived meanwhile
+    //
+#ifndef NDEBUG
+    using rp_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_rp_spin_shared_mutex_t,
+        detail::libtle_spin_shared_mutex_handle_t, mutex_profile>;
+    using pf_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_pf_spin_shared_mutex_t,
+        detail::libtle_spin_shared_mutex_handle_t, mutex_profile>;
+#else
+    using rp_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_rp_spin_shared_mutex_t,
+        void, mutex_profile>;
+    using pf_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_pf_spin_shared_mutex_t,
+        void, mutex_profile>;
+#endif
+
+    //
+    // HTM-based mutexes with the above reader/writer spinlocks as fallback
+    //
+    using htm_rp_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_rp_spin_shared_mutex_t,
+        detail::libtle_htm_spin_shared_mutex_handle_t, htm_mutex_profile>;
+    using htm_pf_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_pf_spin_shared_mutex_t,
+        detail::libtle_htm_spin_shared_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // HTM-based mutex with a spinlock as fallback, that adapts its retry
+    // budget and skips elision when it does not pay off
+    //
+    using htm_adaptive_spin_mutex =
+        detail::mutex_wrapper<detail::libtle_htm_adaptive_spin_mutex_t,
+        detail::libtle_htm_adaptive_spin_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // HTM-based adaptive mutex with a reader/writer spinlock as fallback
+    //
+    using htm_adaptive_spin_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_adaptive_spin_shared_mutex_t,
+        detail::libtle_htm_adaptive_spin_shared_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // MCS queue lock; each waiter spins on its own handle, and the lock is
+    // handed over in FIFO order
+    //
+    using mcs_mutex =
+        detail::mutex_wrapper<detail::libtle_mcs_mutex_t,
+        detail::libtle_mcs_mutex_handle_t, mutex_profile>;
+
+    //
+    // HTM-based mutex with an MCS queue lock as fallback
+    //
+    using htm_mcs_mutex =
+        detail::mutex_wrapper<detail::libtle_htm_mcs_mutex_t,
+        detail::libtle_htm_mcs_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // HTM-based mutex with a NUMA-aware cohort lock as fallback; the handle
+    // caches the node of the thread that constructs it
+    //
+    using htm_cohort_mutex =
+        detail::mutex_wrapper<detail::libtle_htm_cohort_mutex_t,
+        detail::libtle_htm_cohort_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // Reader/writer mutex with per-slot reader counters, so readers do not
+    // share a cache line; writers scan all the slots
+    //
+    using dist_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_dist_shared_mutex_t,
+        detail::libtle_dist_shared_mutex_handle_t, mutex_profile>;
+
+    //
+    // HTM-based mutex with a distributed reader/writer lock as fallback
+    //
+    using htm_dist_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_dist_shared_mutex_t,
+        detail::libtle_htm_dist_shared_mutex_handle_t, htm_mutex_profile>;
+
+    //
+    // HTM-based mutex with a reader/writer lock as fallback, whose writers
+    // queue up on a NUMA-aware cohort lock; the handle caches the node of the
+    // thread that constructs it
+    //
+    using htm_cohort_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_cohort_shared_mutex_t,
+        detail::libtle_htm_cohort_shared_mutex_handle_t, htm_mutex_profile>;
+
+#ifdef __linux__
+    //
+    // HTM-based mutex with a futex lock as fallback; waiters spin for a while,
+    // then sleep in the kernel until the lock is released
+    //
+#ifndef NDEBUG
+    using htm_futex_mutex =
+        detail::mutex_wrapper<detail::libtle_htm_futex_mutex_t,
+        detail::libtle_htm_futex_mutex_handle_t, htm_mutex_profile>;
+#else
+    using htm_futex_mutex =
+        detail::mutex_wrapper<detail::libtle_htm_futex_mutex_t,
+        void, htm_mutex_profile>;
+#endif
+
+    //
+    // HTM-based mutex with a futex reader/writer lock as fallback
+    //
+    using htm_futex_shared_mutex =
+        detail::shared_mutex_wrapper<detail::libtle_htm_futex_shared_mutex_t,
+        detail::libtle_htm_futex_shared_mutex_handle_t, htm_mutex_profile>;
+#endif
+
+    //
+    // Sequence lock: readers validate a sequence number and never write to
+    // the lock; writers elide a spinlock
+    //
+    using htm_seqlock =
+        detail::seqlock_wrapper<detail::libtle_htm_seqlock_t,
+        detail::libtle_htm_seqlock_handle_t, htm_seqlock_profile>;
+
     //
     // Aliases for the mutex handles
     //
-    using null_mutex_handle            = null_mutex::handle_type;
-    using spin_mutex_handle            = spin_mutex::handle_type;
-    using htm_spin_mutex_handle        = htm_spin_mutex::handle_type;
-    using null_shared_mutex_handle     = null_shared_mutex::handle_type;
-    using spin_shared_mutex_handle     = spin_shared_mutex::handle_type;
-    using htm_spin_shared_mutex_handle = htm_spin_shared_mutex::handle_type;
+    using null_mutex_handle                     = null_mutex::handle_type;
+    using spin_mutex_handle                     = spin_mutex::handle_type;
+    using htm_spin_mutex_handle                 = htm_spin_mutex::handle_type;
+    using null_shared_mutex_handle              = null_shared_mutex::handle_type;
+    using spin_shared_mutex_handle              = spin_shared_mutex::handle_type;
+    using htm_spin_shared_mutex_handle          = htm_spin_shared_mutex::handle_type;
+    using rp_spin_shared_mutex_handle           = rp_spin_shared_mutex::handle_type;
+    using pf_spin_shared_mutex_handle           = pf_spin_shared_mutex::handle_type;
+    using htm_rp_spin_shared_mutex_handle       = htm_rp_spin_shared_mutex::handle_type;
+    using htm_pf_spin_shared_mutex_handle       = htm_pf_spin_shared_mutex::handle_type;
+    using htm_adaptive_spin_mutex_handle        = htm_adaptive_spin_mutex::handle_type;
+    using htm_adaptive_spin_shared_mutex_handle = htm_adaptive_spin_shared_mutex::handle_type;
+    using mcs_mutex_handle                      = mcs_mutex::handle_type;
+    using htm_mcs_mutex_handle                  = htm_mcs_mutex::handle_type;
+    using htm_cohort_mutex_handle               = htm_cohort_mutex::handle_type;
+    using dist_shared_mutex_handle              = dist_shared_mutex::handle_type;
+    using htm_dist_shared_mutex_handle          = htm_dist_shared_mutex::handle_type;
+    using htm_cohort_shared_mutex_handle        = htm_cohort_shared_mutex::handle_type;
+#ifdef __linux__
+    using htm_futex_mutex_handle                = htm_futex_mutex::handle_type;
+    using htm_futex_shared_mutex_handle         = htm_futex_shared_mutex::handle_type;
+#endif
+    using htm_seqlock_handle                    = htm_seqlock::handle_type;
+
+    //
+    // Adaptor of a mutex handle that records the wait and hold times of a
+    // sample of its acquisitions into a tle::latency_profile. An acquisition
+    // counts as elided when its critical section runs in a transaction.
+    //
+    template<typename Handle>
+    class latency_handle : public Handle {
+    public:
+        typedef typename Handle::mutex_type     mutex_type;
+        typedef typename Handle::profile_type   profile_type;
+
+        latency_handle(mutex_type& __m, latency_profile* __l,
+                       profile_type* __s = nullptr) noexcept
+        : Handle(__m, __s), _M_latency(__l), _M_sample()
+        { }
+
+        void lock() {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            Handle::lock();
+            detail::libtle_latency_sample_acquired(&_M_sample, _M_elided());
+        }
+
+        void unlock() {
+            detail::libtle_latency_sample_released(&_M_sample);
+            Handle::unlock();
+            detail::libtle_latency_profile_update(_M_latency, &_M_sample);
+        }
+
+        void lock_shared() {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            Handle::lock_shared();
+            detail::libtle_latency_sample_acquired(&_M_sample, _M_elided());
+        }
+
+        // the samples of the failed attempts are dropped
+
+        bool try_lock() {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock());
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_for(const std::chrono::duration<_Rep,_Period>& __d) {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock_for(__d));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock_until(__t));
+        }
+
+        bool try_lock_shared() {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock_shared());
+        }
+
+        template<typename _Rep, typename _Period>
+        bool try_lock_shared_for(const std::chrono::duration<_Rep,_Period>& __d) {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock_shared_for(__d));
+        }
+
+        template<typename _Clock, typename _Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<_Clock,_Duration>& __t) {
+            detail::libtle_latency_sample_begin(_M_latency, &_M_sample);
+            return _M_acquired(Handle::try_lock_shared_until(__t));
+        }
+
+        void unlock_shared() {
+            detail::libtle_latency_sample_released(&_M_sample);
+            Handle::unlock_shared();
+            detail::libtle_latency_profile_update(_M_latency, &_M_sample);
+        }
+
+    private:
+        static int _M_elided() {
+            return detail::libtle_htm_supported() && _xtest();
+        }
+
+        bool _M_acquired(bool __locked) {
+            if (__locked) {
+                detail::libtle_latency_sample_acquired(&_M_sample, _M_elided());
+            } else {
+                _M_sample.sampled = 0;
+            }
+            return __locked;
+        }
+
+        latency_profile*                _M_latency;
+        detail::libtle_latency_sample_t _M_sample;
+    };
 
 } // namespace tle
 
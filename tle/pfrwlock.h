@@ -0,0 +1,210 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_PFRWLOCK_H__
+#define __LIBTLE_PFRWLOCK_H__
+
+#include "lock_backoff.h"
+#include "probes.h"
+
+#ifdef __cplusplus
+#include <atomic>
+
+namespace tle{ namespace detail{
+
+using std::atomic_uint;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+
+#else
+#include <stdatomic.h>
+#endif
+
+
+#define LIBTLE_PFRWLOCK_RINC    (0x100u)    /* reader increment */
+#define LIBTLE_PFRWLOCK_WBITS   (0x3u)      /* writer bits of %rin */
+#define LIBTLE_PFRWLOCK_PRES    (0x2u)      /* a writer is present */
+#define LIBTLE_PFRWLOCK_PHID    (0x1u)      /* phase of the writer */
+
+
+/**
+ * @brief  A phase-fair reader-writer ticket lock.
+ *
+ * Readers and writers alternate: a reader waits for at most one writer
+ * phase, and a writer for the readers that arrived before it plus the
+ * writers ahead of it, so neither side starves under a steady stream of the
+ * other (B. Brandenburg and J. Anderson, "Spin-based reader-writer
+ * synchronization for multiprocessor real-time systems", 2010).
+ *
+ * Bits 8:N of %rin and %rout count the arrivals and departures of the
+ * readers; bits 0:1 of %rin hold the present writer and its phase. %win and
+ * %wout are the tickets of the writers, which are served in FIFO order.
+ */
+typedef struct {
+    atomic_uint rin;
+    atomic_uint rout;
+    atomic_uint win;
+    atomic_uint wout;
+} libtle_pfrwlock_t;
+
+
+#ifndef __cplusplus
+#define LIBTLE_PFRWLOCK_INIT \
+    { ATOMIC_VAR_INIT(0u), ATOMIC_VAR_INIT(0u), \
+      ATOMIC_VAR_INIT(0u), ATOMIC_VAR_INIT(0u) }
+#endif
+
+
+static inline void
+libtle_pfrwlock_init(libtle_pfrwlock_t *lck)
+{
+    atomic_init(&lck->rin, 0u);
+    atomic_init(&lck->rout, 0u);
+    atomic_init(&lck->win, 0u);
+    atomic_init(&lck->wout, 0u);
+}
+
+
+static inline void
+libtle_pfrwlock_acquire_barrier(void)
+{
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+static inline void
+libtle_pfrwlock_write_lock(libtle_pfrwlock_t *lck)
+{
+    unsigned ticket, w, r;
+
+    /* wait for the writers ahead of us */
+    ticket = atomic_fetch_add_explicit(&lck->win, 1u, memory_order_relaxed);
+    while (atomic_load_explicit(&lck->wout, memory_order_acquire) != ticket) {
+        libtle_lock_pause();
+    }
+    /* block the new readers, then wait for the present ones to leave */
+    w = LIBTLE_PFRWLOCK_PRES | (ticket & LIBTLE_PFRWLOCK_PHID);
+    r = atomic_fetch_add_explicit(&lck->rin, w, memory_order_acquire);
+    while (atomic_load_explicit(&lck->rout, memory_order_acquire) != r) {
+        libtle_lock_pause();
+    }
+    libtle_pfrwlock_acquire_barrier();
+}
+
+
+static inline void
+libtle_pfrwlock_read_lock(libtle_pfrwlock_t *lck)
+{
+    unsigned w;
+
+    w = atomic_fetch_add_explicit(&lck->rin, LIBTLE_PFRWLOCK_RINC,
+                                  memory_order_acquire) & LIBTLE_PFRWLOCK_WBITS;
+    if (w) {
+        /* wait for the end of this writer phase only */
+        while ((atomic_load_explicit(&lck->rin, memory_order_acquire) &
+                LIBTLE_PFRWLOCK_WBITS) == w) {
+            libtle_lock_pause();
+        }
+    }
+    libtle_pfrwlock_acquire_barrier();
+}
+
+
+static inline void
+libtle_pfrwlock_write_unlock(libtle_pfrwlock_t *lck)
+{
+    (void) atomic_fetch_and_explicit(&lck->rin, ~LIBTLE_PFRWLOCK_WBITS,
+                                     memory_order_release);
+    (void) atomic_fetch_add_explicit(&lck->wout, 1u, memory_order_release);
+}
+
+
+static inline void
+libtle_pfrwlock_read_unlock(libtle_pfrwlock_t *lck)
+{
+    (void) atomic_fetch_add_explicit(&lck->rout, LIBTLE_PFRWLOCK_RINC,
+                                     memory_order_release);
+}
+
+
+/*
+ * Single attempts to take the lock, without waiting; they return 1 on
+ * success. A writer only takes a ticket that is served right away, and
+ * backs out (as if it unlocked) when readers arrived meanwhile. A reader
+ * only counts itself in %rin while no writer is present, since a reader
+ * that arrived after a writer must not depart (and bump %rout) while the
+ * writer waits for the readers ahead of it.
+ */
+static inline int
+libtle_pfrwlock_try_write_lock(libtle_pfrwlock_t *lck)
+{
+    unsigned ticket = atomic_load_explicit(&lck->wout, memory_order_relaxed);
+    unsigned w, r;
+    if (atomic_load_explicit(&lck->win, memory_order_relaxed) != ticket ||
+        atomic_load_explicit(&lck->rin, memory_order_relaxed) !=
+        atomic_load_explicit(&lck->rout, memory_order_relaxed) ||
+        !atomic_compare_exchange_strong_explicit(&lck->win, &ticket,
+            ticket + 1u, memory_order_relaxed, memory_order_relaxed)) {
+        return 0;
+    }
+    w = LIBTLE_PFRWLOCK_PRES | (ticket & LIBTLE_PFRWLOCK_PHID);
+    r = atomic_fetch_add_explicit(&lck->rin, w, memory_order_acquire);
+    if (atomic_load_explicit(&lck->rout, memory_order_acquire) != r) {
+        libtle_pfrwlock_write_unlock(lck);
+        return 0;
+    }
+    libtle_pfrwlock_acquire_barrier();
+    return 1;
+}
+
+
+static inline int
+libtle_pfrwlock_try_read_lock(libtle_pfrwlock_t *lck)
+{
+    unsigned r = atomic_load_explicit(&lck->rin, memory_order_relaxed);
+    do {
+        if (r & LIBTLE_PFRWLOCK_WBITS) {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&lck->rin, &r,
+                 r + LIBTLE_PFRWLOCK_RINC, memory_order_acquire,
+                 memory_order_relaxed));
+    libtle_pfrwlock_acquire_barrier();
+    return 1;
+}
+
+
+static inline int
+libtle_pfrwlock_is_locked(libtle_pfrwlock_t *lck)
+{
+    /* true if readers or a writer hold (or drain) the lock */
+    return atomic_load_explicit(&lck->rin, memory_order_acquire) !=
+        atomic_load_explicit(&lck->rout, memory_order_acquire);
+}
+
+
+static inline void
+libtle_pfrwlock_unlock_wait(libtle_pfrwlock_t *lck)
+{
+#if LIBTLE_HAVE_PROBES
+    if (libtle_pfrwlock_is_locked(lck)) {
+        LIBTLE_PROBE1(rwlock_wait, lck);
+    }
+#endif
+    while (libtle_pfrwlock_is_locked(lck)) {
+        libtle_lock_pause();
+    }
+}
+
+
+#ifdef __cplusplus
+}} // namespace tle::detail
+#endif
+
+#endif /* __LIBTLE_PFRWLOCK_H__ */
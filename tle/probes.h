@@ -0,0 +1,50 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __LIBTLE_PROBES_H__
+#define __LIBTLE_PROBES_H__
+
+/*
+ * Static probe points (SystemTap SDT, also known as USDT), to trace the
+ * aborts and the fallbacks of the elided mutexes with perf, bpftrace or
+ * SystemTap, without the profiles. A probe is a single nop until a tracer
+ * attaches to it, so the probes can stay in production builds. They are
+ * compiled in when <sys/sdt.h> is available (e.g., from systemtap-sdt-dev),
+ * unless LIBTLE_NO_PROBES is defined; LIBTLE_HAVE_PROBES tells whether they
+ * are.
+ *
+ * The probes of the "libtle" provider are:
+ *
+ *   htm_abort(mutex, xstatus)       the transaction of a writer aborted
+ *   htm_read_abort(mutex, xstatus)  the transaction of a reader aborted
+ *   htm_fallback(mutex)             a writer took the fallback lock
+ *   htm_read_fallback(mutex)        a reader took the fallback lock
+ *   spinlock_wait(lock)             waiting for a busy spinlock to be free
+ *   rwlock_wait(lock)               waiting for a busy rwlock to be free
+ *
+ * The probes are all outside of the transactions, since an attached probe
+ * traps, which would abort them.
+ */
+
+#if !defined(LIBTLE_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LIBTLE_HAVE_PROBES 1
+#endif
+#endif
+
+#ifndef LIBTLE_HAVE_PROBES
+#define LIBTLE_HAVE_PROBES 0
+#endif
+
+#if LIBTLE_HAVE_PROBES
+#define LIBTLE_PROBE1(N,A)      DTRACE_PROBE1(libtle, N, A)
+#define LIBTLE_PROBE2(N,A,B)    DTRACE_PROBE2(libtle, N, A, B)
+#else
+#define LIBTLE_PROBE1(N,A)      do { } while (0)
+#define LIBTLE_PROBE2(N,A,B)    do { } while (0)
+#endif
+
+#endif /* __LIBTLE_PROBES_H__ */
@@ -7,19 +7,54 @@
 #define __LIBTLE_PROFILE_H__
 
 #ifdef __cplusplus
+#include <cstddef>
 #include <cstdint>
 #else
+#include <stddef.h>
 #include <stdint.h>
 #include <stdalign.h>
 #endif
 
 #if defined(__x86_64__)
 #include <immintrin.h>
+/* Abort code of the transactions that found the fallback lock busy */
+#define LIBTLE_LOCK_IS_LOCKED_CODE  (255)
 #elif defined(__aarch64__)
 #include "tme.h"
+#define LIBTLE_LOCK_IS_LOCKED_CODE  (0x7fff)
 #else
 #error "Only x86-64 and Aarch64 HTM support for now"
 #endif
+#include "cycles.h"
+
+
+/* Buckets of the retry histograms; the last one also counts longer runs */
+#ifndef LIBTLE_HTM_PROFILE_RETRY_BUCKETS
+#define LIBTLE_HTM_PROFILE_RETRY_BUCKETS (16)
+#endif
+
+/* Buckets of the explicit abort codes; the last one also counts larger codes */
+#ifndef LIBTLE_HTM_PROFILE_ABORT_CODES
+#define LIBTLE_HTM_PROFILE_ABORT_CODES (256)
+#endif
+
+/* Each power of 2 range of a latency histogram has 2^SUB_BITS buckets */
+#ifndef LIBTLE_LATENCY_SUB_BITS
+#define LIBTLE_LATENCY_SUB_BITS (3)
+#endif
+
+/* Latencies of 2^MAX_BITS cycles or more are counted in the last bucket */
+#ifndef LIBTLE_LATENCY_MAX_BITS
+#define LIBTLE_LATENCY_MAX_BITS (48)
+#endif
+
+#define LIBTLE_LATENCY_BUCKETS \
+    ((LIBTLE_LATENCY_MAX_BITS - LIBTLE_LATENCY_SUB_BITS + 1) << LIBTLE_LATENCY_SUB_BITS)
+
+/* Default sampling interval of the latency profiles, in acquisitions */
+#ifndef LIBTLE_LATENCY_SAMPLE_INTERVAL
+#define LIBTLE_LATENCY_SAMPLE_INTERVAL (64)
+#endif
 
 
 #ifdef __cplusplus
@@ -27,6 +62,19 @@ namespace tle{ namespace detail{
 #endif
 
 
+/*
+ * Increment a counter of a profile. A profile is only written by the thread
+ * that owns it, but the registry (see registry.hpp) reads its counters from
+ * other threads, so the increment is a relaxed atomic store, which is still
+ * a plain load, add and store.
+ */
+static inline void
+libtle_profile_count(uint64_t *c)
+{
+    __atomic_store_n(c, *c + 1, __ATOMIC_RELAXED);
+}
+
+
 /* -------------------------------------------------------------------------- */
 /* Runtime statistics for empty locks                                         */
 /* -------------------------------------------------------------------------- */
@@ -96,7 +144,133 @@ libtle_mutex_profile_accumulate(libtle_mutex_profile_t *p,
 static inline void
 libtle_mutex_profile_update_unlock(libtle_mutex_profile_t *p)
 {
-    p->locks_acquired += 1;
+    libtle_profile_count(&p->locks_acquired);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Detailed abort statistics for HTM eliding spinlocks                        */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Optional extension of the HTM mutex profile.
+ *
+ * %commit_retries and %fallback_retries are histograms of the number of
+ * aborts each acquisition went through before it committed, or before it fell
+ * back to the lock. %pending_retries counts the aborts of the acquisition in
+ * progress.
+ *
+ * %lock_busy_aborts counts the explicit aborts of transactions that found the
+ * fallback lock busy, and %explicit_codes counts all the other explicit
+ * aborts by their _xabort() code. The %interrupt_aborts, %debug_aborts and
+ * %error_aborts count the aborts with the corresponding status bits (Arm TME
+ * only, except for debug), which are otherwise counted as "other" aborts.
+ */
+typedef struct {
+    uint64_t  pending_retries;
+    uint64_t  commit_retries[LIBTLE_HTM_PROFILE_RETRY_BUCKETS];
+    uint64_t  fallback_retries[LIBTLE_HTM_PROFILE_RETRY_BUCKETS];
+    uint64_t  lock_busy_aborts;
+    uint64_t  explicit_codes[LIBTLE_HTM_PROFILE_ABORT_CODES];
+    uint64_t  interrupt_aborts;
+    uint64_t  debug_aborts;
+    uint64_t  error_aborts;
+} libtle_htm_abort_stats_t;
+
+
+static inline void
+libtle_htm_abort_stats_init(libtle_htm_abort_stats_t *s)
+{
+    int i;
+    s->pending_retries = 0;
+    for (i = 0; i < LIBTLE_HTM_PROFILE_RETRY_BUCKETS; ++i) {
+        s->commit_retries[i] = 0;
+        s->fallback_retries[i] = 0;
+    }
+    s->lock_busy_aborts = 0;
+    for (i = 0; i < LIBTLE_HTM_PROFILE_ABORT_CODES; ++i) {
+        s->explicit_codes[i] = 0;
+    }
+    s->interrupt_aborts = 0;
+    s->debug_aborts = 0;
+    s->error_aborts = 0;
+}
+
+
+static inline void
+libtle_htm_abort_stats_accumulate(libtle_htm_abort_stats_t *s,
+                                  const libtle_htm_abort_stats_t *q)
+{
+    int i;
+    for (i = 0; i < LIBTLE_HTM_PROFILE_RETRY_BUCKETS; ++i) {
+        s->commit_retries[i]   += q->commit_retries[i];
+        s->fallback_retries[i] += q->fallback_retries[i];
+    }
+    s->lock_busy_aborts += q->lock_busy_aborts;
+    for (i = 0; i < LIBTLE_HTM_PROFILE_ABORT_CODES; ++i) {
+        s->explicit_codes[i] += q->explicit_codes[i];
+    }
+    s->interrupt_aborts += q->interrupt_aborts;
+    s->debug_aborts     += q->debug_aborts;
+    s->error_aborts     += q->error_aborts;
+}
+
+
+static inline uint64_t
+libtle_htm_abort_stats_take_retries(libtle_htm_abort_stats_t *s)
+{
+    uint64_t n = s->pending_retries;
+    s->pending_retries = 0;
+    return n < LIBTLE_HTM_PROFILE_RETRY_BUCKETS ?
+        n : LIBTLE_HTM_PROFILE_RETRY_BUCKETS - 1;
+}
+
+
+static inline void
+libtle_htm_abort_stats_update_unlock(libtle_htm_abort_stats_t *s)
+{
+    s->fallback_retries[libtle_htm_abort_stats_take_retries(s)] += 1;
+}
+
+
+static inline void
+libtle_htm_abort_stats_update_commit(libtle_htm_abort_stats_t *s)
+{
+    s->commit_retries[libtle_htm_abort_stats_take_retries(s)] += 1;
+}
+
+
+static inline void
+libtle_htm_abort_stats_update_abort(libtle_htm_abort_stats_t *s,
+                                    unsigned xstatus)
+{
+    s->pending_retries += 1;
+    if (xstatus & _XABORT_EXPLICIT) {
+        unsigned code = _XABORT_CODE(xstatus);
+        if (code == LIBTLE_LOCK_IS_LOCKED_CODE) {
+            s->lock_busy_aborts += 1;
+        }
+        else if (code < LIBTLE_HTM_PROFILE_ABORT_CODES) {
+            s->explicit_codes[code] += 1;
+        }
+        else {
+            s->explicit_codes[LIBTLE_HTM_PROFILE_ABORT_CODES - 1] += 1;
+        }
+    }
+#ifdef _XABORT_INTERRUPT
+    if (xstatus & _XABORT_INTERRUPT) {
+        s->interrupt_aborts += 1;
+    }
+#endif
+    if (xstatus & _XABORT_DEBUG) {
+        s->debug_aborts += 1;
+    }
+#ifdef _XABORT_ERROR
+    if (xstatus & _XABORT_ERROR) {
+        s->error_aborts += 1;
+    }
+#endif
 }
 
 
@@ -105,6 +279,11 @@ libtle_mutex_profile_update_unlock(libtle_mutex_profile_t *p)
 /* -------------------------------------------------------------------------- */
 
 
+/*
+ * %ext optionally points to detailed abort statistics (see
+ * libtle_htm_mutex_profile_attach()), which are updated along with the
+ * profile. It is NULL by default.
+ */
 typedef struct {
     alignas(64) uint64_t  locks_acquired;
     uint64_t  locks_elided;
@@ -113,6 +292,7 @@ typedef struct {
     uint64_t  capacity_aborts;
     uint64_t  nested_aborts;
     uint64_t  other_aborts;
+    libtle_htm_abort_stats_t *ext;
 } libtle_htm_mutex_profile_t;
 
 
@@ -126,6 +306,21 @@ libtle_htm_mutex_profile_init(libtle_htm_mutex_profile_t *p)
     p->capacity_aborts = 0;
     p->nested_aborts = 0;
     p->other_aborts = 0;
+    p->ext = NULL;
+}
+
+
+/*
+ * Initialize %s and collect it along with %p from now on. %s must outlive
+ * the acquisitions profiled with %p, and it is not affected by
+ * libtle_mutex_profile_accumulate() (use libtle_htm_abort_stats_accumulate()).
+ */
+static inline void
+libtle_htm_mutex_profile_attach(libtle_htm_mutex_profile_t *p,
+                                libtle_htm_abort_stats_t *s)
+{
+    libtle_htm_abort_stats_init(s);
+    p->ext = s;
 }
 
 
@@ -160,14 +355,20 @@ libtle_htm_mutex_profile_accumulate(libtle_htm_mutex_profile_t *p,
 static inline void
 libtle_htm_mutex_profile_update_unlock(libtle_htm_mutex_profile_t *p)
 {
-    p->locks_acquired += 1;
+    libtle_profile_count(&p->locks_acquired);
+    if (p->ext) {
+        libtle_htm_abort_stats_update_unlock(p->ext);
+    }
 }
 
 
 static inline void
 libtle_htm_mutex_profile_update_commit(libtle_htm_mutex_profile_t *p)
 {
-    p->locks_elided += 1;
+    libtle_profile_count(&p->locks_elided);
+    if (p->ext) {
+        libtle_htm_abort_stats_update_commit(p->ext);
+    }
 }
 
 
@@ -175,21 +376,326 @@ static inline void
 libtle_htm_mutex_profile_update_abort(libtle_htm_mutex_profile_t *p,
                                       unsigned xstatus)
 {
+    if (p->ext) {
+        libtle_htm_abort_stats_update_abort(p->ext, xstatus);
+    }
     if (xstatus & _XABORT_CONFLICT) {
-        p->conflict_aborts += 1;
+        libtle_profile_count(&p->conflict_aborts);
     }
     else if (xstatus & _XABORT_EXPLICIT) {
-        p->explicit_aborts += 1;
+        libtle_profile_count(&p->explicit_aborts);
     }
     else if (xstatus & _XABORT_CAPACITY) {
-        p->capacity_aborts += 1;
+        libtle_profile_count(&p->capacity_aborts);
     }
     else if (xstatus & _XABORT_NESTED) {
-        p->nested_aborts += 1;
+        libtle_profile_count(&p->nested_aborts);
     }
     else {
         // _XABORT_DEBUG, _XABORT_INVALID, _XABORT_ERROR, _XABORT_UNKNOWN
-        p->other_aborts += 1;
+        libtle_profile_count(&p->other_aborts);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Runtime statistics for HTM eliding sequence locks                          */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Profile of a sequence lock: %write profiles the writers, as for the
+ *         other HTM mutexes, %reads counts the validated reads, and
+ *         %read_retries the reads that had to start again because a writer
+ *         updated the data meanwhile.
+ */
+typedef struct {
+    libtle_htm_mutex_profile_t write;
+    uint64_t  reads;
+    uint64_t  read_retries;
+} libtle_htm_seqlock_profile_t;
+
+
+static inline void
+libtle_htm_seqlock_profile_init(libtle_htm_seqlock_profile_t *p)
+{
+    libtle_htm_mutex_profile_init(&p->write);
+    p->reads = 0;
+    p->read_retries = 0;
+}
+
+
+static inline int
+libtle_htm_seqlock_profile_internally_consistent(const libtle_htm_seqlock_profile_t *p,
+                                                 uint64_t sum)
+{
+    return libtle_htm_mutex_profile_internally_consistent(&p->write, sum);
+}
+
+
+static inline void
+libtle_htm_seqlock_profile_accumulate(libtle_htm_seqlock_profile_t *p,
+                                      const libtle_htm_seqlock_profile_t *q)
+{
+    libtle_htm_mutex_profile_accumulate(&p->write, &q->write);
+    p->reads        += q->reads;
+    p->read_retries += q->read_retries;
+}
+
+
+static inline void
+libtle_htm_seqlock_profile_update_read(libtle_htm_seqlock_profile_t *p,
+                                       int retry)
+{
+    if (retry) {
+        p->read_retries += 1;
+    } else {
+        p->reads += 1;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Latency histograms                                                         */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Log-linear histogram of latencies, in cycles (see libtle_cycles()).
+ *
+ * Latencies below 2^LIBTLE_LATENCY_SUB_BITS have a bucket each, and every
+ * larger power of 2 range is split into 2^LIBTLE_LATENCY_SUB_BITS buckets,
+ * so the relative error of a bucket is at most 2^-LIBTLE_LATENCY_SUB_BITS.
+ */
+typedef struct {
+    uint64_t  count;
+    uint64_t  sum;
+    uint64_t  max;
+    uint64_t  buckets[LIBTLE_LATENCY_BUCKETS];
+} libtle_latency_histogram_t;
+
+
+static inline void
+libtle_latency_histogram_init(libtle_latency_histogram_t *h)
+{
+    int i;
+    h->count = 0;
+    h->sum = 0;
+    h->max = 0;
+    for (i = 0; i < LIBTLE_LATENCY_BUCKETS; ++i) {
+        h->buckets[i] = 0;
+    }
+}
+
+
+static inline unsigned
+libtle_latency_histogram_bucket(uint64_t cycles)
+{
+    unsigned shift;
+    if (cycles < (1u << LIBTLE_LATENCY_SUB_BITS)) {
+        return (unsigned) cycles;
+    }
+    if (cycles >> LIBTLE_LATENCY_MAX_BITS) {
+        return LIBTLE_LATENCY_BUCKETS - 1;
+    }
+    shift = 63 - __builtin_clzll(cycles) - LIBTLE_LATENCY_SUB_BITS;
+    return ((shift + 1) << LIBTLE_LATENCY_SUB_BITS) +
+        (unsigned) ((cycles >> shift) & ((1u << LIBTLE_LATENCY_SUB_BITS) - 1));
+}
+
+
+/*
+ * The lowest latency counted in bucket %b.
+ */
+static inline uint64_t
+libtle_latency_histogram_bucket_value(unsigned b)
+{
+    unsigned shift, sub;
+    if (b < (1u << LIBTLE_LATENCY_SUB_BITS)) {
+        return b;
+    }
+    shift = (b >> LIBTLE_LATENCY_SUB_BITS) - 1;
+    sub = b & ((1u << LIBTLE_LATENCY_SUB_BITS) - 1);
+    return ((uint64_t) ((1u << LIBTLE_LATENCY_SUB_BITS) + sub)) << shift;
+}
+
+
+static inline void
+libtle_latency_histogram_record(libtle_latency_histogram_t *h,
+                                uint64_t cycles)
+{
+    h->count += 1;
+    h->sum += cycles;
+    if (cycles > h->max) {
+        h->max = cycles;
+    }
+    h->buckets[libtle_latency_histogram_bucket(cycles)] += 1;
+}
+
+
+static inline void
+libtle_latency_histogram_accumulate(libtle_latency_histogram_t *h,
+                                    const libtle_latency_histogram_t *q)
+{
+    int i;
+    h->count += q->count;
+    h->sum += q->sum;
+    if (q->max > h->max) {
+        h->max = q->max;
+    }
+    for (i = 0; i < LIBTLE_LATENCY_BUCKETS; ++i) {
+        h->buckets[i] += q->buckets[i];
+    }
+}
+
+
+/*
+ * The latency below which lie at least the fraction %q (0-1) of the recorded
+ * latencies, rounded down to the lowest latency of its bucket.
+ */
+static inline uint64_t
+libtle_latency_histogram_quantile(const libtle_latency_histogram_t *h,
+                                  double q)
+{
+    unsigned b;
+    uint64_t seen = 0;
+    uint64_t rank = (uint64_t) (q * (double) h->count);
+    if (rank >= h->count) {
+        return h->max;
+    }
+    for (b = 0; b < LIBTLE_LATENCY_BUCKETS; ++b) {
+        seen += h->buckets[b];
+        if (seen > rank) {
+            break;
+        }
+    }
+    return libtle_latency_histogram_bucket_value(b);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/* Runtime latency statistics                                                 */
+/* -------------------------------------------------------------------------- */
+
+
+/**
+ * @brief  Sampled wait and hold times of the acquisitions of a thread.
+ *
+ * The wait time is measured from the lock call until the lock is acquired
+ * (including all the aborted transactions), and the hold time from then until
+ * the unlock call. Both are split into elided and fallback (locked)
+ * acquisitions. Only one in %sample_interval acquisitions is timestamped and
+ * recorded; %countdown counts down to the next sampled one.
+ */
+typedef struct {
+    alignas(64) uint32_t  sample_interval;
+    uint32_t  countdown;
+    libtle_latency_histogram_t  wait_elided;
+    libtle_latency_histogram_t  wait_locked;
+    libtle_latency_histogram_t  hold_elided;
+    libtle_latency_histogram_t  hold_locked;
+} libtle_latency_profile_t;
+
+
+/*
+ * Timestamps of one acquisition, kept by the caller from the lock until the
+ * unlock.
+ */
+typedef struct {
+    int       sampled;
+    int       elided;
+    uint64_t  start;
+    uint64_t  acquired;
+    uint64_t  released;
+} libtle_latency_sample_t;
+
+
+static inline void
+libtle_latency_profile_init(libtle_latency_profile_t *p,
+                            uint32_t sample_interval)
+{
+    p->sample_interval = sample_interval ? sample_interval : 1;
+    p->countdown = p->sample_interval;
+    libtle_latency_histogram_init(&p->wait_elided);
+    libtle_latency_histogram_init(&p->wait_locked);
+    libtle_latency_histogram_init(&p->hold_elided);
+    libtle_latency_histogram_init(&p->hold_locked);
+}
+
+
+static inline void
+libtle_latency_profile_accumulate(libtle_latency_profile_t *p,
+                                  const libtle_latency_profile_t *q)
+{
+    libtle_latency_histogram_accumulate(&p->wait_elided, &q->wait_elided);
+    libtle_latency_histogram_accumulate(&p->wait_locked, &q->wait_locked);
+    libtle_latency_histogram_accumulate(&p->hold_elided, &q->hold_elided);
+    libtle_latency_histogram_accumulate(&p->hold_locked, &q->hold_locked);
+}
+
+
+/*
+ * Call right before the lock; returns true if this acquisition is sampled.
+ */
+static inline int
+libtle_latency_sample_begin(libtle_latency_profile_t *p,
+                            libtle_latency_sample_t *s)
+{
+    if (__builtin_expect(--p->countdown != 0, 1)) {
+        s->sampled = 0;
+        return 0;
+    }
+    p->countdown = p->sample_interval;
+    s->sampled = 1;
+    s->start = libtle_cycles();
+    return 1;
+}
+
+
+/*
+ * Call right after the lock. %elided tells whether the critical section runs
+ * in a transaction.
+ */
+static inline void
+libtle_latency_sample_acquired(libtle_latency_sample_t *s, int elided)
+{
+    if (__builtin_expect(s->sampled, 0)) {
+        s->acquired = libtle_cycles();
+        s->elided = elided;
+    }
+}
+
+
+/*
+ * Call right before the unlock.
+ */
+static inline void
+libtle_latency_sample_released(libtle_latency_sample_t *s)
+{
+    if (__builtin_expect(s->sampled, 0)) {
+        s->released = libtle_cycles();
+    }
+}
+
+
+/*
+ * Call after the unlock, so the histograms are not written from within a
+ * transaction.
+ */
+static inline void
+libtle_latency_profile_update(libtle_latency_profile_t *p,
+                              const libtle_latency_sample_t *s)
+{
+    if (__builtin_expect(s->sampled, 0)) {
+        uint64_t wait = s->acquired - s->start;
+        uint64_t hold = s->released - s->acquired;
+        if (s->elided) {
+            libtle_latency_histogram_record(&p->wait_elided, wait);
+            libtle_latency_histogram_record(&p->hold_elided, hold);
+        } else {
+            libtle_latency_histogram_record(&p->wait_locked, wait);
+            libtle_latency_histogram_record(&p->hold_locked, hold);
+        }
     }
 }
 
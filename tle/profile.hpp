@@ -62,6 +62,20 @@ namespace tle{ namespace detail{
             libtle_htm_mutex_profile_init(_M_recast());
         }
 
+        // copies do not share the detailed statistics of the original
+        htm_mutex_profile_wrapper(const htm_mutex_profile_wrapper<Tp>& other) noexcept
+        : Tp(other) {
+            this->ext = nullptr;
+        }
+
+        htm_mutex_profile_wrapper<Tp>&
+        operator=(const htm_mutex_profile_wrapper<Tp>& other) noexcept {
+            libtle_htm_abort_stats_t* ext = this->ext;
+            Tp::operator=(other);
+            this->ext = ext;
+            return *this;
+        }
+
         void update_unlock() noexcept {
             libtle_htm_mutex_profile_update_unlock(_M_recast());
         }
@@ -70,8 +84,8 @@ namespace tle{ namespace detail{
             libtle_htm_mutex_profile_update_commit(_M_recast());
         }
 
-        void update_abort() noexcept {
-            libtle_htm_mutex_profile_update_abort(_M_recast());
+        void update_abort(unsigned xstatus) noexcept {
+            libtle_htm_mutex_profile_update_abort(_M_recast(), xstatus);
         }
 
         bool internally_consistent(uint64_t sum) const noexcept {
@@ -90,6 +104,146 @@ namespace tle{ namespace detail{
         }
     };
 
+
+    //
+    // HTM mutex profile that also collects the detailed abort statistics
+    // (retry histograms and explicit abort codes, see libtle_htm_abort_stats_t)
+    //
+    template<typename Tp>
+    struct htm_mutex_xprofile_wrapper : public htm_mutex_profile_wrapper<Tp>
+    {
+        typedef htm_mutex_profile_wrapper<Tp> base_type;
+
+        htm_mutex_xprofile_wrapper() noexcept {
+            libtle_htm_mutex_profile_attach(this->_M_recast(), &_M_stats);
+        }
+
+        htm_mutex_xprofile_wrapper(const htm_mutex_xprofile_wrapper<Tp>& other) noexcept
+        : base_type(other), _M_stats(other._M_stats) {
+            this->ext = &_M_stats;
+        }
+
+        htm_mutex_xprofile_wrapper<Tp>&
+        operator=(const htm_mutex_xprofile_wrapper<Tp>& other) noexcept {
+            base_type::operator=(other);
+            _M_stats = other._M_stats;
+            return *this;
+        }
+
+        const libtle_htm_abort_stats_t& abort_stats() const noexcept {
+            return _M_stats;
+        }
+
+        bool internally_consistent(uint64_t sum) const noexcept {
+            uint64_t commits = 0, fallbacks = 0;
+            for (int i = 0; i < LIBTLE_HTM_PROFILE_RETRY_BUCKETS; ++i) {
+                commits += _M_stats.commit_retries[i];
+                fallbacks += _M_stats.fallback_retries[i];
+            }
+            return base_type::internally_consistent(sum)
+                && commits == this->locks_elided
+                && fallbacks == this->locks_acquired;
+        }
+
+        htm_mutex_xprofile_wrapper<Tp>&
+        operator+=(const htm_mutex_xprofile_wrapper<Tp>& other) noexcept {
+            base_type::operator+=(other);
+            libtle_htm_abort_stats_accumulate(&_M_stats, &other._M_stats);
+            return *this;
+        }
+
+        htm_mutex_xprofile_wrapper<Tp>
+        operator+(const htm_mutex_xprofile_wrapper<Tp>& other) const noexcept {
+            return htm_mutex_xprofile_wrapper<Tp>(*this) += other;
+        }
+
+    private:
+        libtle_htm_abort_stats_t _M_stats;
+    };
+
+
+    //
+    // Profile of a sequence lock: the writer statistics of an HTM mutex,
+    // plus the validated reads and the read retries
+    //
+    template<typename Tp>
+    struct htm_seqlock_profile_wrapper : public Tp
+    {
+        Tp* _M_recast() {
+            return static_cast<Tp*>(this);
+        }
+
+        const Tp* _M_recast() const {
+            return static_cast<const Tp*>(this);
+        }
+
+        htm_seqlock_profile_wrapper() noexcept {
+            libtle_htm_seqlock_profile_init(_M_recast());
+        }
+
+        // copies do not share the detailed statistics of the original
+        htm_seqlock_profile_wrapper(const htm_seqlock_profile_wrapper<Tp>& other) noexcept
+        : Tp(other) {
+            this->write.ext = nullptr;
+        }
+
+        htm_seqlock_profile_wrapper<Tp>&
+        operator=(const htm_seqlock_profile_wrapper<Tp>& other) noexcept {
+            libtle_htm_abort_stats_t* ext = this->write.ext;
+            Tp::operator=(other);
+            this->write.ext = ext;
+            return *this;
+        }
+
+        bool internally_consistent(uint64_t sum) const noexcept {
+            return libtle_htm_seqlock_profile_internally_consistent(_M_recast(), sum);
+        }
+
+        htm_seqlock_profile_wrapper<Tp>&
+        operator+=(const htm_seqlock_profile_wrapper<Tp>& other) noexcept {
+            libtle_htm_seqlock_profile_accumulate(_M_recast(), other._M_recast());
+            return *this;
+        }
+
+        htm_seqlock_profile_wrapper<Tp>
+        operator+(const htm_seqlock_profile_wrapper<Tp>& other) const noexcept {
+            return htm_seqlock_profile_wrapper<Tp>(*this) += other;
+        }
+    };
+
+
+    //
+    // Sampled wait and hold time histograms of the acquisitions of a thread
+    // (see libtle_latency_profile_t); used through tle::latency_handle.
+    //
+    template<typename Tp>
+    struct latency_profile_wrapper : public Tp
+    {
+        Tp* _M_recast() {
+            return static_cast<Tp*>(this);
+        }
+
+        const Tp* _M_recast() const {
+            return static_cast<const Tp*>(this);
+        }
+
+        explicit
+        latency_profile_wrapper(uint32_t __interval = LIBTLE_LATENCY_SAMPLE_INTERVAL) noexcept {
+            libtle_latency_profile_init(_M_recast(), __interval);
+        }
+
+        latency_profile_wrapper<Tp>&
+        operator+=(const latency_profile_wrapper<Tp>& other) noexcept {
+            libtle_latency_profile_accumulate(_M_recast(), other._M_recast());
+            return *this;
+        }
+
+        latency_profile_wrapper<Tp>
+        operator+(const latency_profile_wrapper<Tp>& other) const noexcept {
+            return latency_profile_wrapper<Tp>(*this) += other;
+        }
+    };
+
 }} // namespace tle::detail
 
 
@@ -104,6 +258,17 @@ namespace tle {
     using htm_mutex_profile =
         detail::htm_mutex_profile_wrapper<detail::libtle_htm_mutex_profile_t>;
 
+    using htm_mutex_xprofile =
+        detail::htm_mutex_xprofile_wrapper<detail::libtle_htm_mutex_profile_t>;
+
+    using htm_seqlock_profile =
+        detail::htm_seqlock_profile_wrapper<detail::libtle_htm_seqlock_profile_t>;
+
+    using latency_profile =
+        detail::latency_profile_wrapper<detail::libtle_latency_profile_t>;
+
+    using latency_histogram = detail::libtle_latency_histogram_t;
+
 } // tle
 
 #endif // __TLE_PROFILE_HPP__
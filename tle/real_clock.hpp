@@ -27,7 +27,9 @@ namespace tle {
         typedef duration::period            period;
         typedef std::chrono::time_point<real_clock> time_point;
 
-        static const bool is_steady = true;
+        // CLOCK_REALTIME can be stepped (e.g., by NTP); see cycle_clock
+        // for a steady and cheaper clock
+        static const bool is_steady = false;
 
         static time_point now() noexcept {
             rep answer;
@@ -0,0 +1,334 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_REGISTRY_HPP__
+#define __TLE_REGISTRY_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "profile.hpp"
+
+namespace tle {
+
+    //
+    // Counters of a profile, or the sum of the counters of the profiles
+    // registered under the same name.
+    //
+    struct profile_counters {
+        uint64_t threads;
+        uint64_t locks_acquired;
+        uint64_t locks_elided;
+        uint64_t explicit_aborts;
+        uint64_t conflict_aborts;
+        uint64_t capacity_aborts;
+        uint64_t nested_aborts;
+        uint64_t other_aborts;
+
+        profile_counters() noexcept
+        : threads(0), locks_acquired(0), locks_elided(0), explicit_aborts(0),
+          conflict_aborts(0), capacity_aborts(0), nested_aborts(0),
+          other_aborts(0)
+        { }
+
+        profile_counters& operator+=(const profile_counters& other) noexcept {
+            threads         += other.threads;
+            locks_acquired  += other.locks_acquired;
+            locks_elided    += other.locks_elided;
+            explicit_aborts += other.explicit_aborts;
+            conflict_aborts += other.conflict_aborts;
+            capacity_aborts += other.capacity_aborts;
+            nested_aborts   += other.nested_aborts;
+            other_aborts    += other.other_aborts;
+            return *this;
+        }
+
+        uint64_t aborts() const noexcept {
+            return explicit_aborts + conflict_aborts + capacity_aborts
+                + nested_aborts + other_aborts;
+        }
+    };
+
+
+    //
+    // Counters per name, as returned by profile_registry::snapshot()
+    //
+    typedef std::map<std::string, profile_counters> profile_snapshot;
+
+
+namespace detail {
+
+    //
+    // The counters of a profile are only written by the thread that owns it,
+    // with relaxed atomic stores (see libtle_profile_count()). Another thread
+    // reads each of them atomically, but the counters of a profile may be a
+    // few acquisitions apart.
+    //
+    inline uint64_t load_counter(const uint64_t& __c) noexcept {
+        return __atomic_load_n(&__c, __ATOMIC_RELAXED);
+    }
+
+    inline void read_counters(const libtle_null_mutex_profile_t*,
+                              profile_counters&) noexcept
+    { }
+
+    inline void read_counters(const libtle_mutex_profile_t* __p,
+                              profile_counters& __c) noexcept {
+        __c.locks_acquired = load_counter(__p->locks_acquired);
+    }
+
+    inline void read_counters(const libtle_htm_mutex_profile_t* __p,
+                              profile_counters& __c) noexcept {
+        __c.locks_acquired  = load_counter(__p->locks_acquired);
+        __c.locks_elided    = load_counter(__p->locks_elided);
+        __c.explicit_aborts = load_counter(__p->explicit_aborts);
+        __c.conflict_aborts = load_counter(__p->conflict_aborts);
+        __c.capacity_aborts = load_counter(__p->capacity_aborts);
+        __c.nested_aborts   = load_counter(__p->nested_aborts);
+        __c.other_aborts    = load_counter(__p->other_aborts);
+    }
+
+    template<typename Profile>
+    void read_profile(const void* __p, profile_counters& __c) noexcept {
+        read_counters(static_cast<const Profile*>(__p)->_M_recast(), __c);
+    }
+
+} // namespace detail
+
+
+    //
+    // Process-wide registry of the live profiles, by name (e.g., the name of
+    // the mutex they profile). Registering and unregistering takes a lock,
+    // but the profiles are updated as usual, without any shared writes, and
+    // snapshot() reads them while their threads keep running. The counters of
+    // the unregistered profiles are kept, so the totals never go backwards.
+    //
+    class profile_registry {
+    public:
+        typedef void (*read_function)(const void*, profile_counters&);
+
+        profile_registry(const profile_registry&) = delete;
+        profile_registry& operator=(const profile_registry&) = delete;
+
+        static profile_registry& instance() {
+            static profile_registry registry;
+            return registry;
+        }
+
+        void add(const std::string& __name, const void* __p,
+                 read_function __read) {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            _M_entries.push_back(entry{__name, __p, __read});
+        }
+
+        void remove(const void* __p) {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            for (auto it = _M_entries.begin(); it != _M_entries.end(); ++it) {
+                if (it->profile == __p) {
+                    profile_counters c;
+                    it->read(it->profile, c);
+                    c.threads = 0;
+                    _M_retired[it->name] += c;
+                    *it = _M_entries.back();
+                    _M_entries.pop_back();
+                    return;
+                }
+            }
+        }
+
+        //
+        // Sum of the counters of the live and retired profiles, per name;
+        // threads counts the live profiles.
+        //
+        profile_snapshot snapshot() const {
+            std::lock_guard<std::mutex> guard(_M_lock);
+            profile_snapshot snap(_M_retired);
+            for (const auto& e : _M_entries) {
+                profile_counters c;
+                e.read(e.profile, c);
+                c.threads = 1;
+                snap[e.name] += c;
+            }
+            return snap;
+        }
+
+    private:
+        struct entry {
+            std::string     name;
+            const void*     profile;
+            read_function   read;
+        };
+
+        profile_registry() = default;
+
+        mutable std::mutex          _M_lock;
+        std::vector<entry>          _M_entries;
+        profile_snapshot            _M_retired;
+    };
+
+
+    //
+    // A profile that registers itself under the given name for its
+    // lifetime. It is used like the profile type it extends, typically by a
+    // single thread, e.g.:
+    //
+    //   thread_local tle::registered_profile<tle::htm_mutex_profile>
+    //       stats("table_lock");
+    //   tle::htm_spin_mutex_handle handle(table_lock, &stats);
+    //
+    template<typename Profile>
+    class registered_profile : public Profile {
+    public:
+        registered_profile(const registered_profile&) = delete;
+        registered_profile& operator=(const registered_profile&) = delete;
+
+        explicit registered_profile(const std::string& __name) {
+            profile_registry::instance().add(__name,
+                static_cast<const Profile*>(this), &detail::read_profile<Profile>);
+        }
+
+        ~registered_profile() {
+            profile_registry::instance().remove(static_cast<const Profile*>(this));
+        }
+    };
+
+
+    //
+    // A mutex handle with its own registered profile, e.g.:
+    //
+    //   thread_local tle::registered_handle<tle::htm_spin_mutex>
+    //       handle(table_lock, "table_lock");
+    //
+    template<typename Mutex>
+    class registered_handle
+        : private registered_profile<typename Mutex::profile_type>,
+          public Mutex::handle_type {
+    public:
+        typedef typename Mutex::profile_type            profile_type;
+        typedef registered_profile<profile_type>        registered_type;
+
+        registered_handle(Mutex& __m, const std::string& __name)
+        : registered_type(__name),
+          Mutex::handle_type(__m, static_cast<registered_type*>(this))
+        { }
+
+        const profile_type& profile() const noexcept {
+            return *static_cast<const registered_type*>(this);
+        }
+    };
+
+
+    //
+    // A mutex with a name, whose handles register a profile under that name
+    // for their lifetime, so that the statistics of all the threads that
+    // lock it show up in the registry without any setup, e.g.:
+    //
+    //   tle::named_mutex<tle::htm_spin_mutex> table_lock("table_lock");
+    //   thread_local tle::named_mutex<tle::htm_spin_mutex>::handle_type
+    //       handle(table_lock);
+    //
+    // The acquisitions without a handle (lock() on the mutex itself) are not
+    // profiled.
+    //
+    template<typename Mutex>
+    class named_mutex : public Mutex {
+    public:
+        class handle_type : public registered_handle<Mutex> {
+        public:
+            explicit handle_type(named_mutex& __m)
+            : registered_handle<Mutex>(__m, __m._M_name)
+            { }
+        };
+
+        explicit named_mutex(std::string __name)
+        : _M_name(std::move(__name))
+        { }
+
+        const std::string& name() const noexcept {
+            return _M_name;
+        }
+
+    private:
+        std::string _M_name;
+    };
+
+
+    //
+    // Export of a snapshot as a text table, or as a JSON object with an
+    // object of counters per name.
+    //
+    inline void write_text(std::ostream& __os, const profile_snapshot& __snap) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-24s %8s %14s %14s %14s %8s\n",
+                      "name", "threads", "acquired", "elided", "aborts",
+                      "elided%");
+        __os << line;
+        for (const auto& kv : __snap) {
+            const profile_counters& c = kv.second;
+            uint64_t total = c.locks_acquired + c.locks_elided;
+            double rate = total ? 100.0 * c.locks_elided / total : 0.0;
+            std::snprintf(line, sizeof(line),
+                          "%-24s %8llu %14llu %14llu %14llu %7.2f%%\n",
+                          kv.first.c_str(),
+                          static_cast<unsigned long long>(c.threads),
+                          static_cast<unsigned long long>(c.locks_acquired),
+                          static_cast<unsigned long long>(c.locks_elided),
+                          static_cast<unsigned long long>(c.aborts()),
+                          rate);
+            __os << line;
+        }
+    }
+
+namespace detail {
+
+    inline void write_json_string(std::ostream& __os, const std::string& __s) {
+        __os << '"';
+        for (char ch : __s) {
+            if (ch == '"' || ch == '\\') {
+                __os << '\\' << ch;
+            } else if (static_cast<unsigned char>(ch) < 0x20) {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", ch);
+                __os << esc;
+            } else {
+                __os << ch;
+            }
+        }
+        __os << '"';
+    }
+
+} // namespace detail
+
+    inline void write_json(std::ostream& __os, const profile_snapshot& __snap) {
+        const char* sep = "";
+        __os << '{';
+        for (const auto& kv : __snap) {
+            const profile_counters& c = kv.second;
+            __os << sep;
+            detail::write_json_string(__os, kv.first);
+            __os << ":{"
+                 << "\"threads\":" << c.threads
+                 << ",\"locks_acquired\":" << c.locks_acquired
+                 << ",\"locks_elided\":" << c.locks_elided
+                 << ",\"explicit_aborts\":" << c.explicit_aborts
+                 << ",\"conflict_aborts\":" << c.conflict_aborts
+                 << ",\"capacity_aborts\":" << c.capacity_aborts
+                 << ",\"nested_aborts\":" << c.nested_aborts
+                 << ",\"other_aborts\":" << c.other_aborts
+                 << '}';
+            sep = ",";
+        }
+        __os << '}';
+    }
+
+} // namespace tle
+
+#endif // __TLE_REGISTRY_HPP__
@@ -6,12 +6,16 @@
 #ifndef __LIBTLE_RWLOCK_H__
 #define __LIBTLE_RWLOCK_H__
 
+#include "lock_backoff.h"
+#include "probes.h"
+
 #ifdef __cplusplus
 #include <atomic>
 
 namespace tle{ namespace detail{
 
 using std::atomic_uint;
+using std::memory_order_relaxed;
 using std::memory_order_acquire;
 using std::memory_order_release;
 
@@ -49,7 +53,25 @@ libtle_rwlock_init(libtle_rwlock_t *lck)
 static inline void
 libtle_rwlock_write_lock(libtle_rwlock_t *lck)
 {
-#if defined(__x86_64__)
+#if defined(LIBTLE_LOCK_BACKOFF)
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+    while (1) {
+        unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (!(s & ~2u)) {
+            /* the lock is not acquired by any readers or a writer */
+            if (atomic_compare_exchange_weak_explicit(&lck->lock, &s, 1u,
+                    memory_order_acquire, memory_order_relaxed)) {
+                break;
+            }
+        } else if (!(s & 2u)) {
+            /* no other pending writers, mark as pending to block readers */
+            (void) atomic_fetch_or_explicit(&lck->lock, 2u,
+                                            memory_order_relaxed);
+            continue;
+        }
+        libtle_lock_backoff(&delay);
+    }
+#elif defined(__x86_64__)
     unsigned one, tmp;
     __asm__ volatile(
 "       mov    $0x1, %2\n"
@@ -63,9 +85,28 @@ libtle_rwlock_write_lock(libtle_rwlock_t *lck)
 "       jmp    1b\n"
 "    3: lock ; cmpxchg %2, %0\n"
 "       jne    2b\n"
-        : "+m" (lck->lock), "=&r" (tmp), "=&r" (one)
+        : "+m" (lck->lock), "=&a" (tmp), "=&r" (one)
         :
         : "memory");
+#elif defined(__aarch64__) && defined(LIBTLE_LOCK_LSE)
+    unsigned tmp, old;
+    __asm__ volatile(
+"       sevl\n"
+"       prfm    pstl1strm, %2\n"
+"    1: wfe\n"
+"    2: ldxr    %w0, %2\n"
+"       tst     %w0, #0xfffffffd\n"
+"       b.eq    3f\n"
+"       tbnz    %w0, #1, 1b\n"
+"       stset   %w4, %2\n"
+"       b       2b\n"
+"    3: mov     %w1, %w0\n"
+"       casa    %w1, %w3, %2\n"
+"       cmp     %w1, %w0\n"
+"       b.ne    2b\n"
+        : "=&r" (tmp), "=&r" (old), "+Q" (lck->lock)
+        : "r" (0x1), "r" (0x2)
+        : "memory", "cc");
 #elif defined(__aarch64__)
     unsigned tmp;
     __asm__ volatile(
@@ -105,7 +146,26 @@ libtle_rwlock_write_lock(libtle_rwlock_t *lck)
 static inline void
 libtle_rwlock_read_lock(libtle_rwlock_t *lck)
 {
-#if defined(__x86_64__)
+#if defined(LIBTLE_LOCK_BACKOFF)
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+    while (1) {
+        unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (!(s & 3u)) {
+            /* there is no pending or active writer, so we can
+               acquire a reader lock (increment reader count) */
+            unsigned t = atomic_fetch_add_explicit(&lck->lock, 4u,
+                                                   memory_order_acquire);
+            if (!(t & 1u)) {
+                /* really no active writers, so we're OK */
+                break;
+            }
+            /* writer got there first, undo the increment */
+            (void) atomic_fetch_sub_explicit(&lck->lock, 4u,
+                                             memory_order_relaxed);
+        }
+        libtle_lock_backoff(&delay);
+    }
+#elif defined(__x86_64__)
     unsigned tmp;
     __asm__ volatile(
 "    1: mov    %0, %1\n"
@@ -122,6 +182,23 @@ libtle_rwlock_read_lock(libtle_rwlock_t *lck)
         : "+m" (lck->lock), "=&r" (tmp)
         :
         : "memory");
+#elif defined(__aarch64__) && defined(LIBTLE_LOCK_LSE)
+    unsigned tmp;
+    __asm__ volatile(
+"       sevl\n"
+"       prfm    pstl1strm, %1\n"
+"    1: wfe\n"
+"    2: ldxr    %w0, %1\n"
+"       tst     %w0, #0x3\n"
+"       b.ne    1b\n"
+"       ldadda  %w2, %w0, %1\n"
+"       tbz     %w0, #0, 3f\n"
+"       stadd   %w3, %1\n"
+"       b       2b\n"
+"    3:\n"
+        : "=&r" (tmp), "+Q" (lck->lock)
+        : "r" (0x4), "r" (-0x4)
+        : "memory", "cc");
 #elif defined(__aarch64__)
     unsigned tmp;
     __asm__ volatile(
@@ -156,6 +233,97 @@ libtle_rwlock_read_lock(libtle_rwlock_t *lck)
 }
 
 
+/*
+ * Reader-preferring variants of the acquisitions: a writer never marks
+ * itself as pending, and waits until no readers hold the lock, while new
+ * readers only wait for an active writer. The readers are never held back
+ * by the writers, which may starve under a steady stream of readers. The
+ * lock must only be acquired through these (or the try-lock functions, and
+ * released with the usual unlock functions).
+ */
+static inline void
+libtle_rwlock_write_lock_rpref(libtle_rwlock_t *lck)
+{
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
+    while (1) {
+        unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+        if (!s && atomic_compare_exchange_weak_explicit(&lck->lock, &s, 1u,
+                      memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+        libtle_lock_backoff(&delay);
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+static inline void
+libtle_rwlock_read_lock_rpref(libtle_rwlock_t *lck)
+{
+    while (1) {
+        if (!(atomic_load_explicit(&lck->lock, memory_order_relaxed) & 1u)) {
+            unsigned t = atomic_fetch_add_explicit(&lck->lock, 4u,
+                                                   memory_order_acquire);
+            if (!(t & 1u)) {
+                break;
+            }
+            /* writer got there first, undo the increment */
+            (void) atomic_fetch_sub_explicit(&lck->lock, 4u,
+                                             memory_order_relaxed);
+        }
+        libtle_lock_pause();
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+}
+
+
+/*
+ * Single attempts to take the lock, without waiting and without marking a
+ * pending writer; they return 1 on success.
+ */
+static inline int
+libtle_rwlock_try_write_lock(libtle_rwlock_t *lck)
+{
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if ((s & ~2u) ||
+        !atomic_compare_exchange_strong_explicit(&lck->lock, &s, 1u,
+            memory_order_acquire, memory_order_relaxed)) {
+        return 0;
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+}
+
+
+static inline int
+libtle_rwlock_try_read_lock(libtle_rwlock_t *lck)
+{
+    unsigned s = atomic_load_explicit(&lck->lock, memory_order_relaxed);
+    if (s & 3u) {
+        return 0;
+    }
+    if (atomic_fetch_add_explicit(&lck->lock, 4u, memory_order_acquire) & 1u) {
+        /* writer got there first, undo the increment */
+        (void) atomic_fetch_sub_explicit(&lck->lock, 4u, memory_order_relaxed);
+        return 0;
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME in spinlock.h */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+}
+
+
 static inline void
 libtle_rwlock_write_unlock(libtle_rwlock_t *lck)
 {
@@ -185,6 +353,11 @@ libtle_rwlock_is_locked(libtle_rwlock_t *lck)
 static inline void
 libtle_rwlock_unlock_wait(libtle_rwlock_t *lck)
 {
+#if LIBTLE_HAVE_PROBES
+    if (libtle_rwlock_is_locked(lck)) {
+        LIBTLE_PROBE1(rwlock_wait, lck);
+    }
+#endif
 #if defined(__x86_64__)
     while (libtle_rwlock_is_locked(lck)) {
         __asm__ volatile("pause");
@@ -0,0 +1,118 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_SCOPED_ELISION_HPP__
+#define __TLE_SCOPED_ELISION_HPP__
+
+#include "mutex.hpp"
+
+
+/* Handles that tle::lock_all() and tle::scoped_elision take at most */
+#ifndef LIBTLE_HTM_LOCK_ALL_MAX
+#define LIBTLE_HTM_LOCK_ALL_MAX (8)
+#endif
+
+
+namespace tle{ namespace detail{
+
+    //
+    // Gathers the C mutexes and handles behind a group of
+    // tle::htm_spin_mutex_handle, for libtle_htm_spin_mutex_lock_all()
+    //
+    struct lock_all_access {
+        static void lock(htm_spin_mutex_handle* const* __hs, unsigned __n) {
+            _Group g(__hs, __n);
+            libtle_htm_spin_mutex_lock_all(g.mutexes, g.handles, __n, g.stats);
+        }
+
+        static void unlock(htm_spin_mutex_handle* const* __hs, unsigned __n) {
+            _Group g(__hs, __n);
+            libtle_htm_spin_mutex_unlock_all(g.mutexes, g.handles, __n, g.stats);
+        }
+
+    private:
+        struct _Group {
+            libtle_htm_spin_mutex_t*        mutexes[LIBTLE_HTM_LOCK_ALL_MAX];
+            libtle_htm_spin_mutex_handle_t* handles[LIBTLE_HTM_LOCK_ALL_MAX];
+            libtle_htm_mutex_profile_t*     stats;
+
+            _Group(htm_spin_mutex_handle* const* __hs, unsigned __n) noexcept
+            : stats(__hs[0]->_M_stats->_M_recast())
+            {
+                assert(__n <= LIBTLE_HTM_LOCK_ALL_MAX);
+                for (unsigned i = 0; i < __n; ++i) {
+                    mutexes[i] = __hs[i]->_M_mutex;
+                    handles[i] = static_cast<libtle_htm_spin_mutex_handle_t*>(
+                        __hs[i]->_M_c_handle());
+                }
+            }
+        };
+    };
+
+}} // namespace tle::detail
+
+
+namespace tle {
+
+    //
+    // Lock the handles of distinct htm_spin_mutex objects as a single
+    // critical section: one transaction subscribes to all the locks, so the
+    // elisions do not nest, and when elision fails the locks are taken in
+    // address order (see libtle_htm_spin_mutex_lock_all()). The handles are
+    // released together with tle::unlock_all(), in the same order; the
+    // statistics of the group go to the profile of the first handle.
+    //
+    template<typename... _Handles>
+    void lock_all(htm_spin_mutex_handle& __h, _Handles&... __hs) {
+        static_assert(1 + sizeof...(_Handles) <= LIBTLE_HTM_LOCK_ALL_MAX,
+                      "too many handles for LIBTLE_HTM_LOCK_ALL_MAX");
+        htm_spin_mutex_handle* const hs[] = { &__h, &__hs... };
+        detail::lock_all_access::lock(hs, 1 + sizeof...(_Handles));
+    }
+
+    template<typename... _Handles>
+    void unlock_all(htm_spin_mutex_handle& __h, _Handles&... __hs) {
+        static_assert(1 + sizeof...(_Handles) <= LIBTLE_HTM_LOCK_ALL_MAX,
+                      "too many handles for LIBTLE_HTM_LOCK_ALL_MAX");
+        htm_spin_mutex_handle* const hs[] = { &__h, &__hs... };
+        detail::lock_all_access::unlock(hs, 1 + sizeof...(_Handles));
+    }
+
+
+    //
+    // Scoped guard of tle::lock_all(), e.g., to move an item between two
+    // containers guarded by their own mutexes:
+    //
+    //     tle::scoped_elision guard(from_handle, to_handle);
+    //
+    class scoped_elision {
+    public:
+        scoped_elision(const scoped_elision&) = delete;
+        scoped_elision& operator=(const scoped_elision&) = delete;
+
+        scoped_elision(scoped_elision&&) = delete;
+        scoped_elision& operator=(scoped_elision&&) = delete;
+
+        template<typename... _Handles>
+        explicit scoped_elision(htm_spin_mutex_handle& __h, _Handles&... __hs)
+        : _M_handles{ &__h, &__hs... }, _M_count(1 + sizeof...(_Handles))
+        {
+            static_assert(1 + sizeof...(_Handles) <= LIBTLE_HTM_LOCK_ALL_MAX,
+                          "too many handles for LIBTLE_HTM_LOCK_ALL_MAX");
+            detail::lock_all_access::lock(_M_handles, _M_count);
+        }
+
+        ~scoped_elision() {
+            detail::lock_all_access::unlock(_M_handles, _M_count);
+        }
+
+    private:
+        htm_spin_mutex_handle*  _M_handles[LIBTLE_HTM_LOCK_ALL_MAX];
+        unsigned                _M_count;
+    };
+
+} // namespace tle
+
+#endif // __TLE_SCOPED_ELISION_HPP__
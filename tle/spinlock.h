@@ -6,12 +6,16 @@
 #ifndef __LIBTLE_SPINLOCK_H__
 #define __LIBTLE_SPINLOCK_H__
 
+#include "lock_backoff.h"
+#include "probes.h"
+
 #ifdef __cplusplus
 #include <atomic>
 
 namespace tle{ namespace detail{
 
 using std::atomic_int;
+using std::memory_order_relaxed;
 using std::memory_order_acquire;
 using std::memory_order_release;
 
@@ -57,7 +61,26 @@ libtle_spinlock_init(libtle_spinlock_t *lck)
 static inline void
 libtle_spinlock_lock(libtle_spinlock_t *lck)
 {
+#if defined(LIBTLE_LOCK_BACKOFF)
+    unsigned delay = LIBTLE_LOCK_BACKOFF_MIN;
 #if defined(__x86_64__)
+    while (atomic_fetch_sub_explicit(&lck->lock, 1, memory_order_acquire) != 1) {
+        do {
+            libtle_lock_backoff(&delay);
+        } while (atomic_load_explicit(&lck->lock, memory_order_relaxed) <= 0);
+    }
+#else
+    while (atomic_exchange_explicit(&lck->lock, 1, memory_order_acquire)) {
+        do {
+            libtle_lock_backoff(&delay);
+        } while (atomic_load_explicit(&lck->lock, memory_order_relaxed));
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME below */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+#endif
+#elif defined(__x86_64__)
     __asm__ volatile(
 "    1: lock ; decl %0\n"
 "       jns 2f\n"
@@ -67,6 +90,21 @@ libtle_spinlock_lock(libtle_spinlock_t *lck)
 "       jmp 1b\n"
 "    2: "
         : "=m" (lck->lock) :: "memory", "cc");
+#elif defined(__aarch64__) && defined(LIBTLE_LOCK_LSE)
+    /* wait for the lock to look free, then swap; SWPA is safe with TME */
+    int lockval = 1;
+    int tmp;
+    __asm__ volatile(
+"       sevl\n"
+"       prfm    pstl1strm, %1\n"
+"    1: wfe\n"
+"    2: ldxr    %w0, %1\n"
+"       cbnz    %w0, 1b\n"
+"       swpa    %w2, %w0, %1\n"
+"       cbnz    %w0, 2b\n"
+        : "=&r" (tmp), "+Q" (lck->lock)
+        : "r" (lockval)
+        : "memory");
 #elif defined(__aarch64__)
 /*
  * Important note regarding mutexes and Arm TME
@@ -85,11 +123,11 @@ libtle_spinlock_lock(libtle_spinlock_t *lck)
  *    first memory operation of the critical section.
  *
  * For the time being, we have chosen to use the
- * latter option since TME is now supported in
- * gem5/ruby, however, LSE atomics aren't currently
- * implemented. When this changes, we may reevaluate
- * this decision and implement the lock acquisition
- * sequence in an alternative way.
+ * latter option by default since TME is now supported
+ * in gem5/ruby, however, LSE atomics aren't currently
+ * implemented. The former option is used when the
+ * target has LSE atomics (see LIBTLE_LOCK_LSE in
+ * lock_backoff.h).
  */
     int lockval = 1;
     int tmp;
@@ -112,6 +150,34 @@ libtle_spinlock_lock(libtle_spinlock_t *lck)
 }
 
 
+/*
+ * Single attempt to take the lock, without waiting; returns 1 on success.
+ * The lock word is read first, so a busy lock is not written to.
+ */
+static inline int
+libtle_spinlock_try_lock(libtle_spinlock_t *lck)
+{
+#if defined(__x86_64__)
+    int expected = 1;
+    return atomic_load_explicit(&lck->lock, memory_order_relaxed) == 1 &&
+        atomic_compare_exchange_strong_explicit(&lck->lock, &expected, 0,
+            memory_order_acquire, memory_order_relaxed);
+#else
+    int expected = 0;
+    if (atomic_load_explicit(&lck->lock, memory_order_relaxed) ||
+        !atomic_compare_exchange_strong_explicit(&lck->lock, &expected, 1,
+            memory_order_acquire, memory_order_relaxed)) {
+        return 0;
+    }
+#if defined(__aarch64__) && !defined(LIBTLE_LOCK_LSE)
+    /* see the note regarding mutexes and Arm TME below */
+    __asm__ volatile("dmb sy" ::: "memory");
+#endif
+    return 1;
+#endif
+}
+
+
 static inline void
 libtle_spinlock_lock_uncontended(libtle_spinlock_t *lck)
 {
@@ -148,6 +214,11 @@ libtle_spinlock_is_locked(libtle_spinlock_t *lck)
 static inline void
 libtle_spinlock_unlock_wait(libtle_spinlock_t *lck)
 {
+#if LIBTLE_HAVE_PROBES
+    if (libtle_spinlock_is_locked(lck)) {
+        LIBTLE_PROBE1(spinlock_wait, lck);
+    }
+#endif
 #if defined(__x86_64__)
     while (libtle_spinlock_is_locked(lck))
         __asm__ volatile("pause");
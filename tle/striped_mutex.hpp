@@ -0,0 +1,377 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_STRIPED_MUTEX_HPP__
+#define __TLE_STRIPED_MUTEX_HPP__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+#include "mutex.h"
+#include "profile.hpp"
+
+
+namespace tle{ namespace detail{
+
+    //
+    // A stripe of a striped mutex; padded stripes have a cache line each,
+    // dense ones share cache lines with their neighbours.
+    //
+    template<bool Padded> struct striped_mutex_stripe {
+        alignas(64) libtle_spinlock_t lock;
+    };
+
+    template<> struct striped_mutex_stripe<false> {
+        libtle_spinlock_t lock;
+    };
+
+
+    //
+    // Array of N spinlocks (stripes), indexed by a hash of the key. A single
+    // handle per thread locks one key, or several keys at once, whose stripes
+    // are then acquired in ascending order. When Elide is true, the critical
+    // section is first attempted as a transaction that only subscribes to the
+    // stripes of its keys.
+    //
+    template<std::size_t N, bool Padded, bool Elide>
+    class basic_striped_mutex {
+        static_assert(N > 0, "a striped mutex needs at least one stripe");
+
+        static const std::size_t _S_words = (N + 63) / 64;
+
+        enum _Status { _S_unlocked, _S_elided, _S_locked };
+
+        typedef htm_mutex_profile_wrapper<libtle_htm_mutex_profile_t> _HtmProfile;
+        typedef mutex_profile_wrapper<libtle_mutex_profile_t>          _SpinProfile;
+
+    public:
+        typedef typename std::conditional<Elide, _HtmProfile, _SpinProfile>::type
+            profile_type;
+
+        static const std::size_t stripes = N;
+
+        //
+        // Stripe of a key; keys are hashed with std::hash<Key>.
+        //
+        template<typename Key>
+        static std::size_t stripe_of(const Key& __k) noexcept {
+            uint64_t h = static_cast<uint64_t>(std::hash<Key>()(__k));
+            h *= 0x9e3779b97f4a7c15ull;
+            return static_cast<std::size_t>((h >> 32) % N);
+        }
+
+        //
+        // This is a local handle for a striped mutex object. It holds at most
+        // one critical section at a time, covering one or several keys.
+        //
+        class handle_type {
+        public:
+            typedef basic_striped_mutex<N,Padded,Elide>  mutex_type;
+            typedef typename mutex_type::profile_type   profile_type;
+
+            handle_type(const handle_type&) = delete;
+            handle_type& operator=(const handle_type&) = delete;
+
+            handle_type(handle_type&&) = delete;
+            handle_type& operator=(handle_type&&) = delete;
+
+            handle_type(mutex_type& __m, profile_type* __s = nullptr) noexcept
+            : _M_mutex(std::addressof(__m)), _M_stats(__s),
+              _M_status(_S_unlocked), _M_many(false), _M_stripe(0), _M_held()
+            { }
+
+            template<typename Key>
+            void lock(const Key& __k) {
+                assert(_M_status == _S_unlocked);
+                _M_many = false;
+                _M_stripe = stripe_of(__k);
+                _M_lock();
+            }
+
+            template<typename Key>
+            void unlock(const Key& __k) {
+                assert(_M_many || _M_stripe == stripe_of(__k));
+                (void) __k;
+                unlock();
+            }
+
+            //
+            // Lock all the keys of [__first, __last) at once
+            //
+            template<typename Iterator>
+            void lock(Iterator __first, Iterator __last) {
+                assert(_M_status == _S_unlocked);
+                _M_many = true;
+                for (; __first != __last; ++__first) {
+                    std::size_t i = stripe_of(*__first);
+                    _M_held[i / 64] |= uint64_t(1) << (i % 64);
+                }
+                _M_lock();
+            }
+
+            template<typename Iterator>
+            void unlock(Iterator, Iterator) {
+                unlock();
+            }
+
+            template<typename Key>
+            void lock(std::initializer_list<Key> __keys) {
+                lock(__keys.begin(), __keys.end());
+            }
+
+            template<typename Key>
+            void unlock(std::initializer_list<Key>) {
+                unlock();
+            }
+
+            //
+            // Same as the lock() variants, but return false instead of
+            // waiting for a busy stripe; the stripes taken so far are then
+            // released.
+            //
+            template<typename Key>
+            bool try_lock(const Key& __k) {
+                assert(_M_status == _S_unlocked);
+                _M_many = false;
+                _M_stripe = stripe_of(__k);
+                return _M_try_lock();
+            }
+
+            template<typename Iterator>
+            bool try_lock(Iterator __first, Iterator __last) {
+                assert(_M_status == _S_unlocked);
+                _M_many = true;
+                for (; __first != __last; ++__first) {
+                    std::size_t i = stripe_of(*__first);
+                    _M_held[i / 64] |= uint64_t(1) << (i % 64);
+                }
+                return _M_try_lock();
+            }
+
+            template<typename Key>
+            bool try_lock(std::initializer_list<Key> __keys) {
+                return try_lock(__keys.begin(), __keys.end());
+            }
+
+            //
+            // Release the key(s) locked by the last lock()
+            //
+            void unlock() {
+                switch (_M_status) {
+                case _S_elided:
+                    _xend();
+                    if (_M_stats && !_xtest()) {
+                        _S_update_commit(_M_stats);
+                    }
+                    break;
+                case _S_locked:
+                    _M_for_each_stripe([](libtle_spinlock_t* __l) {
+                        libtle_spinlock_unlock(__l);
+                        return false;
+                    });
+                    if (_M_stats) {
+                        _M_stats->update_unlock();
+                    }
+                    break;
+                default:
+                    assert(0);
+                }
+                _M_clear();
+                _M_status = _S_unlocked;
+            }
+
+        private:
+            void _M_clear() noexcept {
+                if (_M_many) {
+                    for (std::size_t w = 0; w < _S_words; ++w) {
+                        _M_held[w] = 0;
+                    }
+                }
+            }
+
+            libtle_spinlock_t* _M_lock_of(std::size_t __i) const noexcept {
+                return &_M_mutex->_M_stripes[__i].lock;
+            }
+
+            static void _S_update_commit(_HtmProfile* __s) noexcept {
+                __s->update_commit();
+            }
+
+            static void _S_update_commit(_SpinProfile*) noexcept
+            { }
+
+            static void _S_update_abort(_HtmProfile* __s, unsigned __x) noexcept {
+                __s->update_abort(__x);
+            }
+
+            static void _S_update_abort(_SpinProfile*, unsigned) noexcept
+            { }
+
+            //
+            // Call __f on the lock of each stripe of the critical section, in
+            // ascending order, until it returns true; returns true if it did.
+            //
+            template<typename Function>
+            bool _M_for_each_stripe(Function __f) const {
+                if (!_M_many) {
+                    return __f(_M_lock_of(_M_stripe));
+                }
+                for (std::size_t w = 0; w < _S_words; ++w) {
+                    for (uint64_t b = _M_held[w]; b; b &= b - 1) {
+                        if (__f(_M_lock_of(w * 64 + __builtin_ctzll(b)))) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void _M_lock() {
+                if (Elide && libtle_htm_supported()) {
+                    int num_retries = 0;
+                    unsigned xstatus;
+                    do {
+                        _M_for_each_stripe([](libtle_spinlock_t* __l) {
+                            libtle_spinlock_unlock_wait(__l);
+                            return false;
+                        });
+                        xstatus = _xbegin();
+                        if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                            // add the stripes to our read-set
+                            if (_M_for_each_stripe([](libtle_spinlock_t* __l) {
+                                    return libtle_spinlock_is_locked(__l) != 0;
+                                })) {
+                                _xabort(LIBTLE_LOCK_IS_LOCKED);
+                                __builtin_unreachable();
+                            }
+                            _M_status = _S_elided;
+                            return;
+                        }
+                        ++num_retries;
+                        if (_M_stats) {
+                            _S_update_abort(_M_stats, xstatus);
+                        }
+                    }
+                    while (_XBEGIN_RESTART(xstatus) &&
+                           num_retries < LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT);
+                }
+
+                // grab the stripes, in ascending order to avoid deadlocks
+                _M_for_each_stripe([](libtle_spinlock_t* __l) {
+                    libtle_spinlock_lock(__l);
+                    return false;
+                });
+                _M_status = _S_locked;
+            }
+
+            bool _M_try_lock() {
+                if (Elide && libtle_htm_supported()) {
+                    int num_retries = 0;
+                    unsigned xstatus;
+                    // never wait for the stripes: elide only while they look free
+                    while (!_M_for_each_stripe([](libtle_spinlock_t* __l) {
+                               return libtle_spinlock_is_locked(__l) != 0;
+                           })) {
+                        xstatus = _xbegin();
+                        if (__builtin_expect(xstatus == _XBEGIN_STARTED, 1)) {
+                            // add the stripes to our read-set
+                            if (_M_for_each_stripe([](libtle_spinlock_t* __l) {
+                                    return libtle_spinlock_is_locked(__l) != 0;
+                                })) {
+                                _xabort(LIBTLE_LOCK_IS_LOCKED);
+                                __builtin_unreachable();
+                            }
+                            _M_status = _S_elided;
+                            return true;
+                        }
+                        ++num_retries;
+                        if (_M_stats) {
+                            _S_update_abort(_M_stats, xstatus);
+                        }
+                        if (!_XBEGIN_RESTART(xstatus) ||
+                            num_retries >= LIBTLE_HTM_SPIN_MUTEX_RETRY_LIMIT) {
+                            break;
+                        }
+                    }
+                }
+
+                // a single attempt per stripe, in ascending order
+                libtle_spinlock_t* busy = nullptr;
+                _M_for_each_stripe([&busy](libtle_spinlock_t* __l) {
+                    if (!libtle_spinlock_try_lock(__l)) {
+                        busy = __l;
+                        return true;
+                    }
+                    return false;
+                });
+                if (busy) {
+                    _M_for_each_stripe([busy](libtle_spinlock_t* __l) {
+                        if (__l == busy) {
+                            return true;
+                        }
+                        libtle_spinlock_unlock(__l);
+                        return false;
+                    });
+                    _M_clear();
+                    return false;
+                }
+                _M_status = _S_locked;
+                return true;
+            }
+
+            mutex_type*     _M_mutex;
+            profile_type*   _M_stats;
+            _Status         _M_status;
+            bool            _M_many;
+            std::size_t     _M_stripe;
+            uint64_t        _M_held[_S_words];
+        };
+
+    public:
+        basic_striped_mutex(const basic_striped_mutex&) = delete;
+        basic_striped_mutex& operator=(const basic_striped_mutex&) = delete;
+
+        basic_striped_mutex(basic_striped_mutex&&) = delete;
+        basic_striped_mutex& operator=(basic_striped_mutex&&) = delete;
+
+        basic_striped_mutex() noexcept
+        {
+            for (std::size_t i = 0; i < N; ++i) {
+                libtle_spinlock_init(&_M_stripes[i].lock);
+            }
+        }
+
+    private:
+        striped_mutex_stripe<Padded> _M_stripes[N];
+        friend handle_type;
+    };
+
+}} // namespace tle::detail
+
+
+namespace tle {
+
+    //
+    // N spinlocks indexed by key, each in its own cache line unless Padded is
+    // false
+    //
+    template<std::size_t N, bool Padded = true>
+    using striped_mutex = detail::basic_striped_mutex<N, Padded, false>;
+
+    //
+    // N elided spinlocks indexed by key, each in its own cache line unless
+    // Padded is false
+    //
+    template<std::size_t N, bool Padded = true>
+    using htm_striped_mutex = detail::basic_striped_mutex<N, Padded, true>;
+
+} // namespace tle
+
+#endif // __TLE_STRIPED_MUTEX_HPP__
@@ -0,0 +1,268 @@
+/* Copyright (C) 2020 by Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __TLE_TXN_ARENA_HPP__
+#define __TLE_TXN_ARENA_HPP__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+
+#include "mutex.h"
+
+
+/* Bytes mapped (and pre-faulted) at a time by a transaction-safe arena */
+#ifndef LIBTLE_TXN_ARENA_CHUNK_SIZE
+#define LIBTLE_TXN_ARENA_CHUNK_SIZE (1 << 20)
+#endif
+
+/* Largest block of the size classes; larger ones use operator new */
+#ifndef LIBTLE_TXN_ARENA_MAX_BLOCK
+#define LIBTLE_TXN_ARENA_MAX_BLOCK (1024)
+#endif
+
+
+namespace tle {
+
+    //
+    // Per-thread allocator for the critical sections of elided mutexes.
+    //
+    // The memory is mapped in pre-faulted chunks, and carved into blocks of
+    // 16 byte size classes by a bump pointer and per-class free lists, which
+    // are only touched by the owner thread. So an elided allocation neither
+    // conflicts on shared allocator metadata nor takes a page fault. All the
+    // state of the arena is plain memory, written by the transaction, so
+    // the allocations and deallocations of an aborted transaction are
+    // rolled back with it.
+    //
+    // A deallocated block may still be read by concurrent critical sections
+    // until the one that frees it commits, so it is only retired; reclaim()
+    // (called after the unlock, see tle::arena_handle) hands the retired
+    // blocks back to the free lists. Getting a new chunk, or a block larger
+    // than LIBTLE_TXN_ARENA_MAX_BLOCK, is a system call: in a transaction,
+    // it aborts with LIBTLE_LOCK_NO_RETRY to run again under the lock.
+    //
+    // Blocks can be deallocated to another thread's arena, which then
+    // reuses them; an arena must outlive all the blocks it handed out, and
+    // the arenas that they were deallocated to.
+    //
+    class txn_arena {
+        static const std::size_t _S_granule = 16;
+        static const std::size_t _S_classes =
+            LIBTLE_TXN_ARENA_MAX_BLOCK / _S_granule;
+
+        struct _Block {
+            _Block*     next;
+            std::size_t size;
+        };
+
+        struct _Chunk {
+            _Chunk*     next;
+            std::size_t size;
+        };
+
+    public:
+        txn_arena(const txn_arena&) = delete;
+        txn_arena& operator=(const txn_arena&) = delete;
+
+        txn_arena(txn_arena&&) = delete;
+        txn_arena& operator=(txn_arena&&) = delete;
+
+        explicit txn_arena(std::size_t __chunk_size = LIBTLE_TXN_ARENA_CHUNK_SIZE)
+        : _M_bump(nullptr), _M_end(nullptr), _M_retired(nullptr),
+          _M_chunks(nullptr), _M_chunk_size(__chunk_size), _M_free()
+        {
+            _M_map_chunk();
+        }
+
+        ~txn_arena() {
+            reclaim();
+            while (_M_chunks) {
+                _Chunk* c = _M_chunks;
+                _M_chunks = c->next;
+                ::munmap(c, c->size);
+            }
+        }
+
+        //
+        // Allocate __n bytes, aligned to 16 bytes. Throws std::bad_alloc
+        // when no more memory can be mapped.
+        //
+        void* allocate(std::size_t __n) {
+            if (__builtin_expect(__n > LIBTLE_TXN_ARENA_MAX_BLOCK, 0)) {
+                _S_no_elision();
+                return ::operator new(__n);
+            }
+            std::size_t c = _S_class(__n);
+            if (_Block* b = _M_free[c]) {
+                _M_free[c] = b->next;
+                return b;
+            }
+            std::size_t size = (c + 1) * _S_granule;
+            if (__builtin_expect(_M_bump + size > _M_end, 0)) {
+                _S_no_elision();
+                _M_map_chunk();
+            }
+            void* p = _M_bump;
+            _M_bump += size;
+            return p;
+        }
+
+        //
+        // Retire the block __p of __n bytes, for reuse after reclaim()
+        //
+        void deallocate(void* __p, std::size_t __n) noexcept {
+            if (!__p) {
+                return;
+            }
+            _Block* b = static_cast<_Block*>(__p);
+            b->size = __n;
+            b->next = _M_retired;
+            _M_retired = b;
+        }
+
+        //
+        // Hand the retired blocks back; called outside of the critical
+        // sections (e.g., after unlock())
+        //
+        void reclaim() noexcept {
+            while (_Block* b = _M_retired) {
+                _M_retired = b->next;
+                if (b->size > LIBTLE_TXN_ARENA_MAX_BLOCK) {
+                    ::operator delete(b);
+                } else {
+                    std::size_t c = _S_class(b->size);
+                    b->next = _M_free[c];
+                    _M_free[c] = b;
+                }
+            }
+        }
+
+    private:
+        static std::size_t _S_class(std::size_t __n) noexcept {
+            return __n ? (__n - 1) / _S_granule : 0;
+        }
+
+        static void _S_no_elision() noexcept {
+            if (detail::libtle_htm_in_transaction()) {
+                _xabort(LIBTLE_LOCK_NO_RETRY);
+            }
+        }
+
+        // the rest of the current chunk is dropped
+        void _M_map_chunk() {
+            std::size_t size = _M_chunk_size < sizeof(_Chunk) + LIBTLE_TXN_ARENA_MAX_BLOCK
+                ? sizeof(_Chunk) + LIBTLE_TXN_ARENA_MAX_BLOCK : _M_chunk_size;
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            _Chunk* c = static_cast<_Chunk*>(p);
+            c->next = _M_chunks;
+            c->size = size;
+            _M_chunks = c;
+            _M_bump = static_cast<char*>(p) + sizeof(_Chunk);
+            _M_end = static_cast<char*>(p) + size;
+        }
+
+        alignas(64) char*   _M_bump;
+        char*               _M_end;
+        _Block*             _M_retired;
+        _Chunk*             _M_chunks;
+        std::size_t         _M_chunk_size;
+        _Block*             _M_free[_S_classes];
+    };
+
+
+    //
+    // Adaptor of a mutex handle with a tle::txn_arena, for the allocations
+    // of its critical sections; unlock() and unlock_shared() reclaim the
+    // blocks that the critical section deallocated, once it has committed
+    // or released the lock.
+    //
+    template<typename Handle>
+    class arena_handle : public Handle {
+    public:
+        typedef typename Handle::mutex_type     mutex_type;
+        typedef typename Handle::profile_type   profile_type;
+
+        arena_handle(mutex_type& __m, txn_arena& __a,
+                     profile_type* __s = nullptr) noexcept
+        : Handle(__m, __s), _M_arena(&__a)
+        { }
+
+        void* allocate(std::size_t __n) {
+            return _M_arena->allocate(__n);
+        }
+
+        void deallocate(void* __p, std::size_t __n) noexcept {
+            _M_arena->deallocate(__p, __n);
+        }
+
+        txn_arena& arena() const noexcept {
+            return *_M_arena;
+        }
+
+        void unlock() {
+            Handle::unlock();
+            _M_arena->reclaim();
+        }
+
+        void unlock_shared() {
+            Handle::unlock_shared();
+            _M_arena->reclaim();
+        }
+
+    private:
+        txn_arena* _M_arena;
+    };
+
+
+    //
+    // Standard allocator over a tle::txn_arena, e.g., for the nodes of a
+    // container protected by an elided mutex
+    //
+    template<typename T>
+    struct txn_arena_allocator {
+        static_assert(alignof(T) <= 16, "txn_arena blocks are 16 byte aligned");
+
+        typedef T value_type;
+
+        explicit txn_arena_allocator(txn_arena& __a) noexcept
+        : _M_arena(&__a) { }
+
+        template<typename U>
+        txn_arena_allocator(const txn_arena_allocator<U>& __o) noexcept
+        : _M_arena(__o._M_arena) { }
+
+        T* allocate(std::size_t __n) {
+            return static_cast<T*>(_M_arena->allocate(__n * sizeof(T)));
+        }
+
+        void deallocate(T* __p, std::size_t __n) noexcept {
+            _M_arena->deallocate(__p, __n * sizeof(T));
+        }
+
+        txn_arena* _M_arena;
+    };
+
+    template<typename T, typename U>
+    bool operator==(const txn_arena_allocator<T>& __a,
+                    const txn_arena_allocator<U>& __b) noexcept {
+        return __a._M_arena == __b._M_arena;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const txn_arena_allocator<T>& __a,
+                    const txn_arena_allocator<U>& __b) noexcept {
+        return !(__a == __b);
+    }
+
+} // namespace tle
+
+#endif // __TLE_TXN_ARENA_HPP__